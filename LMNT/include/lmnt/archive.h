@@ -13,10 +13,11 @@ extern "C" {
 typedef uint32_t lmnt_archive_flags;
 enum
 {
-    LMNT_ARCHIVE_NONE          = (0U << 0),
-    LMNT_ARCHIVE_VALIDATED     = (1U << 0),
-    LMNT_ARCHIVE_USES_EXTCALLS = (1U << 1),
-    LMNT_ARCHIVE_INPLACE       = (1U << 2),
+    LMNT_ARCHIVE_NONE            = (0U << 0),
+    LMNT_ARCHIVE_VALIDATED       = (1U << 0),
+    LMNT_ARCHIVE_USES_EXTCALLS   = (1U << 1),
+    LMNT_ARCHIVE_INPLACE         = (1U << 2),
+    LMNT_ARCHIVE_LAZY_VALIDATION = (1U << 3), // defs' code is only validated when first used, see LMNT_DEFFLAG_VALIDATED
 };
 
 typedef struct lmnt_archive
@@ -49,6 +50,8 @@ enum
     LMNT_DEFFLAG_EXTERN           = (1U << 1),
     LMNT_DEFFLAG_HAS_BACKBRANCHES = (1U << 2),
     LMNT_DEFFLAG_HAS_DEFAULT_ARGS = (1U << 3),
+    // runtime-only: set once the def's code has been validated in a lazily-validated archive
+    LMNT_DEFFLAG_VALIDATED        = (1U << 15),
 };
 
 typedef struct lmnt_def
@@ -108,6 +111,12 @@ lmnt_result lmnt_archive_get_data_section(const lmnt_archive* archive, lmnt_offs
 lmnt_result lmnt_archive_get_data_block(const lmnt_archive* archive, const lmnt_data_section* section, const lmnt_value** block);
 
 lmnt_result lmnt_archive_update_def_extcalls(lmnt_archive* archive, const lmnt_extcall_info* table, size_t table_count);
+// Rewrites common instruction sequences in-place into superinstructions (see LMNT_IS_FUSED_OP)
+// Only the first opcode of each sequence is changed, so instruction counts and branch targets are unaffected
+lmnt_result lmnt_archive_fuse_instructions(lmnt_archive* archive);
+// As lmnt_archive_fuse_instructions, but only for the code belonging to def
+// If the archive was validated lazily, def must already have passed lmnt_archive_validate_def
+lmnt_result lmnt_archive_fuse_def_instructions(lmnt_archive* archive, const lmnt_def* def);
 
 
 #ifdef __cplusplus
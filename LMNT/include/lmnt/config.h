@@ -65,6 +65,10 @@ extern "C" {
 // However, current versions of Element/LMNT do not make use of it
 // #define LMNT_ALLOW_MODIFYING_STACK_CONSTANTS
 
+// Disables rewriting common instruction sequences into superinstructions when an archive is prepared
+// Superinstructions reduce the number of dispatches the interpreter performs, but modify the loaded code
+// #define LMNT_NO_SUPERINSTRUCTIONS
+
 // Prints every instruction evaluated
 // This is, unsurprisingly, VERY spammy
 // #define LMNT_DEBUG_PRINT_EVALUATED_INSTRUCTIONS
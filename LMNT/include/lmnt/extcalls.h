@@ -5,6 +5,7 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
 #include <stdlib.h>
 #include "lmnt/common.h"
 
@@ -13,21 +14,42 @@ typedef struct lmnt_extcall_info lmnt_extcall_info;
 
 typedef lmnt_result(*lmnt_extcall_fn)(lmnt_ictx* ctx, const lmnt_extcall_info* callinfo, const lmnt_value* args, lmnt_value* rvals);
 
+// A pure function of up to LMNT_EXTCALL_PURE_SCALAR_MAX_ARGS scalars returning a single scalar
+// Arguments beyond the extcall's args_count are unspecified and should be ignored
+typedef lmnt_value(*lmnt_extcall_scalar_fn)(lmnt_value a, lmnt_value b, lmnt_value c, lmnt_value d);
+
+#define LMNT_EXTCALL_PURE_SCALAR_MAX_ARGS 4
+
+enum
+{
+    LMNT_EXTCALL_NONE = 0,
+    // The extcall is scalar_function rather than function: it can't fail and doesn't need the context or stack,
+    // so the JIT calls it directly with its arguments and return value in registers
+    // Requires args_count <= LMNT_EXTCALL_PURE_SCALAR_MAX_ARGS and rvals_count == 1
+    LMNT_EXTCALL_PURE_SCALAR = (1U << 0),
+};
+
 struct lmnt_extcall_info
 {
     const char* name;
     lmnt_offset args_count;
     lmnt_offset rvals_count;
     lmnt_extcall_fn function;
+    uint32_t flags;
+    lmnt_extcall_scalar_fn scalar_function;
 };
 
 lmnt_result lmnt_extcalls_get(const lmnt_ictx* ctx, const lmnt_extcall_info** table, size_t* table_count);
+// Returns: LMNT_OK, or an error if any LMNT_EXTCALL_PURE_SCALAR entries don't meet its requirements
 lmnt_result lmnt_extcalls_set(lmnt_ictx* ctx, const lmnt_extcall_info* table, size_t table_count);
 
 lmnt_result lmnt_extcall_get(const lmnt_ictx* ctx, size_t index, const lmnt_extcall_info** result);
 lmnt_result lmnt_extcall_find(const lmnt_ictx* ctx, const char* name, lmnt_offset args_count, lmnt_offset rvals_count, const lmnt_extcall_info** result);
 lmnt_result lmnt_extcall_find_index(const lmnt_extcall_info* table, size_t table_size, const char* name, lmnt_offset args_count, lmnt_offset rvals_count, size_t* index);
 
+// Calls an extcall of any kind with its args and rvals in memory
+lmnt_result lmnt_extcall_invoke(lmnt_ictx* ctx, const lmnt_extcall_info* extcall, const lmnt_value* args, lmnt_value* rvals);
+
 
 #ifdef __cplusplus
 }
@@ -21,9 +21,23 @@ enum
     LMNT_ISTATUS_CMP_GT = (1U << 2),       // greater than
     LMNT_ISTATUS_CMP_UN = (1U << 7),       // unordered (i.e. NaNs present)
 
+    LMNT_ISTATUS_BUDGETED    = (1U << 29), // function is running with an instruction budget
     LMNT_ISTATUS_INTERRUPTED = (1U << 30), // function is being interrupted
 };
 
+// Pre-decoded form of an instruction used for threaded dispatch, see lmnt_prepare_threaded_code
+typedef struct lmnt_threaded_instruction
+{
+    // address of the code which executes this instruction
+    const void* handler;
+    // stack operands resolved to pointers (NULL if the operand is not a stack location)
+    lmnt_value* ptr1;
+    lmnt_value* ptr2;
+    lmnt_value* ptr3;
+    // the original instruction
+    lmnt_instruction in;
+} lmnt_threaded_instruction;
+
 // Main interpreter context struct
 struct lmnt_ictx
 {
@@ -43,6 +57,12 @@ struct lmnt_ictx
     lmnt_loffset cur_instr;
     size_t cur_stack_count;
     uint32_t status_flags;
+    // instructions remaining when LMNT_ISTATUS_BUDGETED is set
+    uint32_t budget;
+    // comparison flags saved by JIT-compiled code which ran out of budget just before reading them
+    uint32_t saved_cpu_flags;
+    // optional pre-decoded code, see lmnt_prepare_threaded_code
+    const lmnt_threaded_instruction* threaded_code;
 };
 
 
@@ -82,8 +102,36 @@ lmnt_result lmnt_load_inplace_archive(lmnt_ictx* ctx, const char* data, size_t d
 // Returns: LMNT_OK or an error
 lmnt_result lmnt_prepare_archive(lmnt_ictx* ctx, lmnt_validation_result* validation_result);
 
-// Convenience function for lmnt_archive_find_def
-lmnt_result lmnt_find_def(const lmnt_ictx* ctx, const char* name, const lmnt_def** def);
+// As lmnt_prepare_archive, but only validates the archive's header, segments and def headers up front
+// Each def's code is validated the first time it is used, so preparation time depends only on the archive's
+// size rather than how much code it contains; this is done automatically by lmnt_find_def and lmnt_execute
+// A def whose code fails validation makes those return LMNT_ERROR_INVALID_ARCHIVE instead
+// In-place archives cannot record which defs have been validated, so are always validated in full
+// Returns: LMNT_OK or an error
+lmnt_result lmnt_prepare_archive_lazy(lmnt_ictx* ctx, lmnt_validation_result* validation_result);
+
+// Validates the specified def's code if the archive was prepared with lmnt_prepare_archive_lazy and it hasn't been already
+// The validation_result argument is optional and can be NULL, as for lmnt_prepare_archive
+// Returns: LMNT_OK or an error
+lmnt_result lmnt_validate_def(lmnt_ictx* ctx, const lmnt_def* def, lmnt_validation_result* validation_result);
+
+// Gets the size in bytes of the buffer lmnt_prepare_threaded_code requires for the loaded archive
+// The archive must have been prepared already
+// Returns: LMNT_OK or an error
+lmnt_result lmnt_get_threaded_code_size(const lmnt_ictx* ctx, size_t* size);
+
+// Pre-decodes all of the archive's code into the provided buffer, which lmnt_execute will then use
+// This avoids decoding each instruction and resolving its stack operands every time it is executed
+// The buffer must be suitably aligned for lmnt_threaded_instruction and must remain allocated while the archive is loaded
+// Loading or preparing an archive discards any existing threaded code
+// If the archive was prepared lazily, this validates every def which hasn't been validated yet
+// Only available when using computed goto dispatch, otherwise returns LMNT_ERROR_FEATURE_DISABLED
+// Returns: LMNT_OK or an error
+lmnt_result lmnt_prepare_threaded_code(lmnt_ictx* ctx, void* buffer, size_t buffer_size);
+
+// Convenience function for lmnt_archive_find_def, which also validates the def if the archive was prepared lazily
+// Validating a def writes to the loaded archive, which is why this needs a non-const context
+lmnt_result lmnt_find_def(lmnt_ictx* ctx, const char* name, const lmnt_def** def);
 
 // Gets the default arguments associated with a def
 // Either returns LMNT_OK having populated args and count, or LMNT_ERROR_NOT_FOUND if the def has no default args
@@ -102,10 +150,23 @@ static inline lmnt_result lmnt_update_arg(
     return lmnt_update_args(ctx, def, offset, &arg, 1);
 }
 
+// Gets a pointer to the specified def's arguments within the context's stack
+// Arguments can be written through this pointer directly instead of being copied in with lmnt_update_args
+// The pointer remains valid until another archive is loaded, and is shared by all defs in the archive
+// Returns: LMNT_OK or an error
+lmnt_result lmnt_get_args_ptr(lmnt_ictx* ctx, const lmnt_def* def, lmnt_value** args);
+
+// Gets a pointer to the specified def's return values within the context's stack
+// Passing a NULL rvals to lmnt_execute and reading results through this pointer avoids copying them out
+// The pointer remains valid until another archive is loaded, but the values are only meaningful after executing def
+// Returns: LMNT_OK or an error
+lmnt_result lmnt_get_rvals_ptr(lmnt_ictx* ctx, const lmnt_def* def, lmnt_value** rvals);
+
 // Executes the specified LMNT function in the provided interpreter context
 // args_count must exactly match the number of arguments expected by the LMNT function
 // If the function expects no arguments, args may be NULL and args_count should be 0
 // The rvals argument may be NULL if there is no need to capture the return values
+// (e.g. because they will be read in place via lmnt_get_rvals_ptr), in which case nothing is copied
 // If rvals is non-null, rvals_count must be at least as large as the number of return values
 // Returns: the number of return values written, or an error
 LMNT_ATTR_FAST lmnt_result lmnt_execute(
@@ -113,6 +174,7 @@ LMNT_ATTR_FAST lmnt_result lmnt_execute(
     lmnt_value* rvals, const lmnt_offset rvals_count);
 
 // Resumes the specified LMNT function which must previously have been interrupted
+// Any interrupt requested with lmnt_interrupt is cleared first, so it doesn't stop the function again straight away
 // The rvals argument may be NULL if there is no need to capture the return values
 // If rvals is non-null, rvals_count must be at least as large as the number of return values
 // Returns: the number of return values written, or an error
@@ -120,6 +182,31 @@ LMNT_ATTR_FAST lmnt_result lmnt_resume(
     lmnt_ictx* ctx, const lmnt_def* def,
     lmnt_value* rvals, const lmnt_offset rvals_count);
 
+// Executes the specified LMNT function, stopping once approximately budget instructions have been executed
+// The budget is charged whenever a backwards branch is taken, by the number of instructions being repeated
+// As such, execution may overrun the budget by at most the length of the function, and a function with no backbranches always completes
+// If the budget runs out, this returns LMNT_INTERRUPTED and the function can be continued with lmnt_resume or lmnt_resume_budgeted
+// Otherwise behaves identically to lmnt_execute
+// Returns: the number of return values written, LMNT_INTERRUPTED, or an error
+LMNT_ATTR_FAST lmnt_result lmnt_execute_budgeted(
+    lmnt_ictx* ctx, const lmnt_def* def,
+    lmnt_value* rvals, const lmnt_offset rvals_count,
+    uint32_t budget);
+
+// Resumes the specified LMNT function with a new instruction budget, see lmnt_execute_budgeted
+// Any interrupt requested with lmnt_interrupt is cleared first, as for lmnt_resume
+// Returns: the number of return values written, LMNT_INTERRUPTED, or an error
+LMNT_ATTR_FAST lmnt_result lmnt_resume_budgeted(
+    lmnt_ictx* ctx, const lmnt_def* def,
+    lmnt_value* rvals, const lmnt_offset rvals_count,
+    uint32_t budget);
+
+// Gets the number of instructions left in the budget after a call to lmnt_execute_budgeted or lmnt_resume_budgeted
+static inline uint32_t lmnt_get_remaining_budget(const lmnt_ictx* ctx)
+{
+    return ctx->budget;
+}
+
 // Interrupts a currently-executing LMNT function
 // Note that there is currently no thread-safety mechanism in the library
 // This is implemented as a single pointer write, which may be atomic on the target architecture
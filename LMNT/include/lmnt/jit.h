@@ -18,16 +18,33 @@ typedef struct
 {
     const lmnt_def* def;
     lmnt_jit_fn function;
+    // continues the function from wherever it last ran out of budget, or NULL if it can never yield
+    lmnt_jit_fn resume;
     void* buffer;
     size_t codesize;
     void* interrupt;
     void* interruptible_start;
     void* interruptible_end;
+    // whether the function stops when its budget runs out, or can't loop and so never needs to
+    bool supports_budget;
+    // registration with external debugging tools, see LMNT_JIT_GDB_INTERFACE
+    void* debug_entry;
 } lmnt_jit_fn_data;
 
+// The instruction set extensions a function was compiled to use
+typedef enum
+{
+    LMNT_JIT_ISA_GENERIC = 0,
+    LMNT_JIT_ISA_X86_64_SSE2,
+    LMNT_JIT_ISA_X86_64_SSE41,
+    LMNT_JIT_ISA_X86_64_AVX,
+    LMNT_JIT_ISA_X86_64_AVX_FMA3,
+} lmnt_jit_isa;
+
 typedef struct
 {
     size_t codesize;
+    lmnt_jit_isa isa;
     size_t reg_alloc;
     size_t reg_aligned;
     size_t reg_unaligned;
@@ -48,12 +65,39 @@ lmnt_result lmnt_jit_compile(lmnt_ictx* ctx, const lmnt_def* def, lmnt_jit_targe
 lmnt_result lmnt_jit_compile_with_stats(lmnt_ictx* ctx, const lmnt_def* def, lmnt_jit_target target, lmnt_jit_fn_data* fn, lmnt_jit_compile_stats* stats);
 #endif
 
+// Compiles a def with some of its arguments fixed, so that they're treated as constants during compilation
+// This allows calculations and branches which only depend on those arguments to be resolved ahead of time
+// const_mask has one entry per argument saying whether it's fixed, or may be NULL to fix all of them
+// const_values has the values of the arguments, or may be NULL to use the def's default arguments instead
+// The fixed arguments are written by the compiled function itself, so values passed in for them are ignored
+// Returns: LMNT_OK or an error (LMNT_ERROR_NOT_FOUND if the def has no default arguments to use)
+lmnt_result lmnt_jit_compile_specialised(
+    lmnt_ictx* ctx, const lmnt_def* def, lmnt_jit_target target,
+    const bool* const_mask, const lmnt_value* const_values,
+    lmnt_jit_fn_data* fndata);
+
 lmnt_result lmnt_jit_delete_function(lmnt_jit_fn_data* fndata);
 
 LMNT_ATTR_FAST lmnt_result lmnt_jit_execute(
     lmnt_ictx* ctx, const lmnt_jit_fn_data* fndata,
     lmnt_value* rvals, const lmnt_offset rvals_count);
 
+// Executes a JIT-compiled function with an instruction budget, see lmnt_execute_budgeted
+// Only the x86-64 target charges the budget; for other targets this only accepts functions without backbranches
+// In particular, ARMv7-M functions compiled from defs with LMNT_DEFFLAG_HAS_BACKBRANCHES can't be run with a budget
+// Returns: as lmnt_execute_budgeted, or LMNT_ERROR_NO_IMPL if the function can't be run with a budget
+LMNT_ATTR_FAST lmnt_result lmnt_jit_execute_budgeted(
+    lmnt_ictx* ctx, const lmnt_jit_fn_data* fndata,
+    lmnt_value* rvals, const lmnt_offset rvals_count,
+    uint32_t budget);
+
+// Resumes a JIT-compiled function which ran out of budget, see lmnt_resume_budgeted
+// Returns: as lmnt_resume_budgeted, or LMNT_ERROR_NO_IMPL if the function can't be run with a budget
+LMNT_ATTR_FAST lmnt_result lmnt_jit_resume_budgeted(
+    lmnt_ictx* ctx, const lmnt_jit_fn_data* fndata,
+    lmnt_value* rvals, const lmnt_offset rvals_count,
+    uint32_t budget);
+
 bool lmnt_jit_is_interruptible(const lmnt_jit_fn_data* fndata, void* inst_pointer);
 
 #ifdef __cplusplus
@@ -15,6 +15,15 @@ extern "C" {
 // #define LMNT_JIT_DEBUG_PRINT
 // #define LMNT_JIT_DEBUG_NO_REGCACHE
 // #define LMNT_JIT_DEBUG_VALIDATE_REGCACHE
+// Only use legacy SSE encodings on x86-64, even if the CPU supports AVX
+// #define LMNT_JIT_X86_64_NO_AVX
+// Don't fuse multiplies and the adds which consume them into FMA3 instructions on x86-64
+// FMA rounds once rather than twice, so fused results can differ slightly from the interpreter's
+// #define LMNT_JIT_X86_64_NO_FMA
+// Add compiled functions to /tmp/perf-<pid>.map so perf can attribute samples to defs (Linux only)
+// #define LMNT_JIT_PERF_MAP
+// Register compiled functions with GDB's JIT interface so they show up in backtraces (Linux x86-64 only)
+// #define LMNT_JIT_GDB_INTERFACE
 
 #if defined(LMNT_JIT_MEMORY_HEADER)
 #include LMNT_JIT_MEMORY_HEADER
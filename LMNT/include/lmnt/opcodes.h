@@ -5,6 +5,7 @@
 extern "C" {
 #endif
 
+#include <stddef.h>
 #include <stdint.h>
 
 typedef uint16_t lmnt_opcode;
@@ -121,11 +122,26 @@ enum
     LMNT_OP_ASSIGNCUN,
     // extern call: deflo, defhi, stack
     LMNT_OP_EXTCALL,
+    // superinstructions: only produced by lmnt_archive_fuse_instructions
+    // each behaves as its base opcode, then executes the following instruction(s) of the group
+    // multiply-add: as MULSS, followed by ADDSS
+    LMNT_OP_FMASS,
+    // compare-and-branch: as CMP, followed by the matching BRANCHC*
+    LMNT_OP_CMPBRCEQ,
+    LMNT_OP_CMPBRCNE,
+    LMNT_OP_CMPBRCLT,
+    LMNT_OP_CMPBRCLE,
+    LMNT_OP_CMPBRCGT,
+    LMNT_OP_CMPBRCGE,
+    LMNT_OP_CMPBRCUN,
+    // assign chain: as ASSIGNSS, followed by three ASSIGNSS
+    LMNT_OP_ASSIGN4SS,
     // placeholder end operation
     LMNT_OP_END,
 };
 
 #define LMNT_IS_BRANCH_OP(op) (((op) >= LMNT_OP_BRANCH && (op) <= LMNT_OP_BRANCHUN) || ((op) >= LMNT_OP_BRANCHCEQ && ((op) <= LMNT_OP_BRANCHCUN)))
+#define LMNT_IS_FUSED_OP(op) ((op) >= LMNT_OP_FMASS && (op) <= LMNT_OP_ASSIGN4SS)
 
 
 typedef enum
@@ -149,6 +165,10 @@ typedef struct
 } lmnt_op_info;
 
 const lmnt_op_info* lmnt_get_opcode_info(lmnt_opcode op);
+// For superinstructions, the opcode the first instruction of the group originally had; otherwise op
+lmnt_opcode lmnt_get_base_opcode(lmnt_opcode op);
+// The number of instructions covered by op, including itself
+size_t lmnt_get_fused_length(lmnt_opcode op);
 
 #define LMNT_OP16(a) (char)(a & 0xFF), (char)((a >> 8) & 0xFF)
 #define LMNT_OP_BYTES(op, arg1, arg2, arg3) LMNT_OP16(op), LMNT_OP16(arg1), LMNT_OP16(arg2), LMNT_OP16(arg3)
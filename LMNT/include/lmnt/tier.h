@@ -0,0 +1,49 @@
+#ifndef LMNT_TIER_H
+#define LMNT_TIER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lmnt/common.h"
+#include "lmnt/interpreter.h"
+#include "lmnt/jit.h"
+
+// Tiered execution: defs start out interpreted, and are JIT-compiled on a background thread once they've been
+// executed enough times, after which executions switch over to the compiled function
+//
+// A tier is created from a context with a prepared archive and takes a private copy of it to compile from
+// Any number of contexts which have loaded the same archive with the same extcalls can then execute through it,
+// including concurrently from different threads (each context still only being used by one thread at a time)
+typedef struct lmnt_tier lmnt_tier;
+
+// Creates a tier for the archive loaded into ctx, which must already have been prepared and not be executing
+// Defs are queued for compilation for target once they've been executed threshold times (zero to compile on first use)
+// Returns: LMNT_OK or an error
+lmnt_result lmnt_tier_create(const lmnt_ictx* ctx, lmnt_jit_target target, uint32_t threshold, lmnt_tier** tier);
+
+// Stops the background thread and frees the tier and all of its compiled functions
+// No contexts may be executing through the tier when this is called
+void lmnt_tier_delete(lmnt_tier* tier);
+
+// Executes def in ctx, using the compiled function if it's ready and the interpreter otherwise
+// The def must come from ctx's archive, and ctx must have loaded the same archive the tier was created from
+// Returns: as lmnt_execute
+LMNT_ATTR_FAST lmnt_result lmnt_tier_execute(
+    lmnt_tier* tier, lmnt_ictx* ctx, const lmnt_def* def,
+    lmnt_value* rvals, const lmnt_offset rvals_count);
+
+// Blocks until every def queued for compilation so far has been compiled (or has failed to compile)
+void lmnt_tier_flush(lmnt_tier* tier);
+
+// Whether executions of def through the tier currently use a compiled function
+bool lmnt_tier_is_compiled(lmnt_tier* tier, const lmnt_ictx* ctx, const lmnt_def* def);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
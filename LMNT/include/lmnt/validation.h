@@ -6,10 +6,27 @@ extern "C" {
 #endif
 
 #include <stdlib.h>
+#include <stdbool.h>
 #include "lmnt/common.h"
 #include "lmnt/archive.h"
 
 lmnt_validation_result lmnt_archive_validate(lmnt_archive* archive, size_t memory_size, size_t* stack_count);
+// As lmnt_archive_validate, but only checks defs' headers and not their code
+// Each def's code must then be validated with lmnt_archive_validate_def before it is used
+lmnt_validation_result lmnt_archive_validate_lazy(lmnt_archive* archive, size_t memory_size, size_t* stack_count);
+// Validates the code of a def from a lazily-validated archive
+// stack_count is the total stack count previously returned by lmnt_archive_validate_lazy
+// The def isn't marked as LMNT_DEFFLAG_VALIDATED until lmnt_archive_set_def_validated is called, so anything else
+// which has to happen before it's used (e.g. fusing its instructions) can be done first
+lmnt_validation_result lmnt_archive_validate_def(lmnt_archive* archive, const lmnt_def* def, size_t stack_count);
+// Marks a def which has passed lmnt_archive_validate_def as safe to use
+void lmnt_archive_set_def_validated(lmnt_archive* archive, const lmnt_def* def);
+
+// Whether def's code is safe to use: always true unless the archive was validated lazily and def hasn't been checked yet
+static inline bool lmnt_archive_def_is_validated(const lmnt_archive* archive, const lmnt_def* def)
+{
+    return !(archive->flags & LMNT_ARCHIVE_LAZY_VALIDATION) || (def->flags & LMNT_DEFFLAG_VALIDATED);
+}
 
 #define LMNT_ENSURE_VALIDATED(a) {\
     if (!((a)->flags & LMNT_ARCHIVE_VALIDATED))\
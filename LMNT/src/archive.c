@@ -71,6 +71,8 @@ lmnt_result lmnt_archive_get_def_code(const lmnt_archive* archive, lmnt_loffset
     LMNT_ENSURE_VALIDATED(archive);
     const char* const base = get_defs_segment(archive) + offset;
     const lmnt_def* hdr = (const lmnt_def*)base;
+    if (!lmnt_archive_def_is_validated(archive, hdr))
+        return LMNT_ERROR_UNPREPARED_ARCHIVE;
     *code = validated_get_code(archive, hdr->code);
     *instrs = validated_get_code_instructions(archive, hdr->code);
     return LMNT_OK;
@@ -160,6 +162,72 @@ lmnt_result lmnt_archive_update_def_extcalls(lmnt_archive* archive, const lmnt_e
     return LMNT_OK;
 }
 
+static lmnt_opcode get_fused_opcode(const lmnt_instruction* instrs, size_t index, size_t count)
+{
+    const lmnt_instruction* in = instrs + index;
+    const size_t remaining = count - index;
+    switch (in[0].opcode)
+    {
+    case LMNT_OP_MULSS:
+        // only fuse where the add actually consumes the product
+        if (remaining >= 2 && in[1].opcode == LMNT_OP_ADDSS && (in[1].arg1 == in[0].arg3 || in[1].arg2 == in[0].arg3))
+            return LMNT_OP_FMASS;
+        break;
+    case LMNT_OP_CMP:
+        if (remaining >= 2 && in[1].opcode >= LMNT_OP_BRANCHCEQ && in[1].opcode <= LMNT_OP_BRANCHCUN)
+            return (lmnt_opcode)(LMNT_OP_CMPBRCEQ + (in[1].opcode - LMNT_OP_BRANCHCEQ));
+        break;
+    case LMNT_OP_ASSIGNSS:
+        if (remaining >= 4 && in[1].opcode == LMNT_OP_ASSIGNSS && in[2].opcode == LMNT_OP_ASSIGNSS && in[3].opcode == LMNT_OP_ASSIGNSS)
+            return LMNT_OP_ASSIGN4SS;
+        break;
+    default:
+        break;
+    }
+    return in[0].opcode;
+}
+
+static void fuse_def_instructions(lmnt_archive* archive, const lmnt_def* def)
+{
+    const size_t count = validated_get_code(archive, def->code)->instructions_count;
+    lmnt_instruction* instrs = (lmnt_instruction*)validated_get_code_instructions(archive, def->code);
+    // step over whole groups so that code shared between defs is never fused twice
+    for (size_t i = 0; i < count; i += lmnt_get_fused_length(instrs[i].opcode))
+        instrs[i].opcode = get_fused_opcode(instrs, i, count);
+}
+
+lmnt_result lmnt_archive_fuse_instructions(lmnt_archive* archive)
+{
+    LMNT_ENSURE_VALIDATED(archive);
+    // we shouldn't be overwriting an in-place archive, fail
+    if (archive->flags & LMNT_ARCHIVE_INPLACE)
+        return LMNT_ERROR_ACCESS_VIOLATION;
+
+    const lmnt_archive_header* hdr = (const lmnt_archive_header*)archive->data;
+    size_t defindex = 0;
+    while (defindex < hdr->defs_length)
+    {
+        const lmnt_def* def = (const lmnt_def*)(get_defs_segment(archive) + defindex);
+        defindex += sizeof(lmnt_def);
+        // code which hasn't been validated yet is fused when it is, see lmnt_archive_fuse_def_instructions
+        if ((def->flags & LMNT_DEFFLAG_EXTERN) || !lmnt_archive_def_is_validated(archive, def))
+            continue;
+        fuse_def_instructions(archive, def);
+    }
+    return LMNT_OK;
+}
+
+lmnt_result lmnt_archive_fuse_def_instructions(lmnt_archive* archive, const lmnt_def* def)
+{
+    LMNT_ENSURE_VALIDATED(archive);
+    if (archive->flags & LMNT_ARCHIVE_INPLACE)
+        return LMNT_ERROR_ACCESS_VIOLATION;
+
+    if (!(def->flags & LMNT_DEFFLAG_EXTERN))
+        fuse_def_instructions(archive, def);
+    return LMNT_OK;
+}
+
 
 lmnt_result lmnt_archive_print(const lmnt_archive* archive)
 {
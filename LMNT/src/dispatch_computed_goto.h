@@ -103,6 +103,15 @@ LMNT_ATTR_FAST static lmnt_result execute_function(lmnt_ictx* ctx, const lmnt_co
         &&op_assigncge,
         &&op_assigncun,
         &&op_extcall,
+        &&op_fmass,
+        &&op_cmpbrceq,
+        &&op_cmpbrcne,
+        &&op_cmpbrclt,
+        &&op_cmpbrcle,
+        &&op_cmpbrcgt,
+        &&op_cmpbrcge,
+        &&op_cmpbrcun,
+        &&op_assign4ss,
     };
 
     lmnt_result opresult = LMNT_OK;
@@ -117,6 +126,9 @@ dispatch:
             // the context's instruction pointer has been updated, refresh
             instr = ctx->cur_instr - 1; // will be incremented momentarily
         } else {
+            // if we've been interrupted, the last instruction has run, so resuming starts at the next one
+            if (opresult == LMNT_OK)
+                ++instr;
             goto endcheck;
         }
     }
@@ -222,6 +234,316 @@ GENERATE_OP_NOFAIL(assigncge);
 GENERATE_OP_NOFAIL(assigncun);
 GENERATE_OP(extcall, dispatch);
 
+// superinstructions execute the rest of their group directly and then skip past it
+#define GENERATE_OP_CMPBR(cond) \
+op_cmpbr##cond: \
+    lmnt_op_cmp(ctx, op.arg1, op.arg2, op.arg3); \
+    op = instructions[++instr]; \
+    opresult = lmnt_op_branch##cond(ctx, op.arg1, op.arg2, op.arg3); \
+    goto branchcheck;
+
+op_fmass:
+    lmnt_op_mulss(ctx, op.arg1, op.arg2, op.arg3);
+    op = instructions[++instr];
+    lmnt_op_addss(ctx, op.arg1, op.arg2, op.arg3);
+    GENERATE_DISPATCHOK();
+GENERATE_OP_CMPBR(ceq);
+GENERATE_OP_CMPBR(cne);
+GENERATE_OP_CMPBR(clt);
+GENERATE_OP_CMPBR(cle);
+GENERATE_OP_CMPBR(cgt);
+GENERATE_OP_CMPBR(cge);
+GENERATE_OP_CMPBR(cun);
+op_assign4ss:
+    lmnt_op_assignss(ctx, op.arg1, op.arg2, op.arg3);
+    op = instructions[++instr];
+    lmnt_op_assignss(ctx, op.arg1, op.arg2, op.arg3);
+    op = instructions[++instr];
+    lmnt_op_assignss(ctx, op.arg1, op.arg2, op.arg3);
+    op = instructions[++instr];
+    lmnt_op_assignss(ctx, op.arg1, op.arg2, op.arg3);
+    GENERATE_DISPATCHOK();
+
+#undef GENERATE_OP_CMPBR
+#undef GENERATE_DISPATCHOK
+#undef GENERATE_OP_NOFAIL
+#undef GENERATE_OP
+
+endcheck:
+    if (opresult == LMNT_OK && (ctx->status_flags & LMNT_ISTATUS_INTERRUPTED))
+        opresult = LMNT_INTERRUPTED;
+end:
+    ctx->cur_instr = instr;
+    return opresult;
+
+branchcheck:
+    if (opresult == LMNT_BRANCHING) {
+        if (LMNT_UNLIKELY(lmnt_charge_branch(ctx, instr, ctx->cur_instr))) {
+            // out of budget, stop such that resuming starts at the branch target
+            instr = ctx->cur_instr;
+            opresult = LMNT_INTERRUPTED;
+            goto end;
+        }
+        // the context's instruction pointer has been updated, refresh
+        instr = ctx->cur_instr - 1; // will be incremented momentarily
+        opresult = LMNT_OK;
+    }
+    goto dispatch;
+}
+
+// Threaded variant of execute_function, running code pre-decoded by lmnt_prepare_threaded_code
+// Each instruction carries the address of its handler, so there's no opcode lookup on dispatch
+// The hottest scalar ops also use the pre-scaled stack pointers rather than recomputing them from the stack base
+// If handlers is non-NULL, no code is executed and the handler table is written to it instead
+LMNT_ATTR_FAST static lmnt_result execute_function_threaded(lmnt_ictx* ctx, const lmnt_code* defcode, const lmnt_threaded_instruction* code, const void* const** handlers)
+{
+    static const void* const jump_targets[LMNT_OP_END] = {
+        &&top_noop,
+        &&top_return,
+        &&top_assignss,
+        &&top_assignvv,
+        &&top_assignsv,
+        &&top_assignibs,
+        &&top_assignibv,
+        &&top_dloadiis,
+        &&top_dloadiiv,
+        &&top_dloadirs,
+        &&top_dloadirv,
+        &&top_dseclen,
+        &&top_addss,
+        &&top_addvv,
+        &&top_subss,
+        &&top_subvv,
+        &&top_mulss,
+        &&top_mulvv,
+        &&top_divss,
+        &&top_divvv,
+        &&top_remss,
+        &&top_remvv,
+        &&top_sin,
+        &&top_cos,
+        &&top_tan,
+        &&top_asin,
+        &&top_acos,
+        &&top_atan,
+        &&top_atan2,
+        &&top_sincos,
+        &&top_powss,
+        &&top_powvv,
+        &&top_powvs,
+        &&top_sqrts,
+        &&top_sqrtv,
+        &&top_ln,
+        &&top_log2,
+        &&top_log10,
+        &&top_abss,
+        &&top_absv,
+        &&top_sumv,
+        &&top_minss,
+        &&top_minvv,
+        &&top_maxss,
+        &&top_maxvv,
+        &&top_minvs,
+        &&top_maxvs,
+        &&top_floors,
+        &&top_floorv,
+        &&top_rounds,
+        &&top_roundv,
+        &&top_ceils,
+        &&top_ceilv,
+        &&top_truncs,
+        &&top_truncv,
+        &&top_indexris,
+        &&top_indexrir,
+        &&top_branch,
+        &&top_branchz,
+        &&top_branchnz,
+        &&top_branchpos,
+        &&top_branchneg,
+        &&top_branchun,
+        &&top_cmp,
+        &&top_cmpz,
+        &&top_branchceq,
+        &&top_branchcne,
+        &&top_branchclt,
+        &&top_branchcle,
+        &&top_branchcgt,
+        &&top_branchcge,
+        &&top_branchcun,
+        &&top_assignceq,
+        &&top_assigncne,
+        &&top_assignclt,
+        &&top_assigncle,
+        &&top_assigncgt,
+        &&top_assigncge,
+        &&top_assigncun,
+        &&top_extcall,
+        &&top_fmass,
+        &&top_cmpbrceq,
+        &&top_cmpbrcne,
+        &&top_cmpbrclt,
+        &&top_cmpbrcle,
+        &&top_cmpbrcgt,
+        &&top_cmpbrcge,
+        &&top_cmpbrcun,
+        &&top_assign4ss,
+    };
+
+    if (handlers) {
+        *handlers = jump_targets;
+        return LMNT_OK;
+    }
+
+    lmnt_result opresult = LMNT_OK;
+    lmnt_loffset instr = ctx->cur_instr - 1; // incremented at start of dispatch
+    const lmnt_loffset icount = defcode->instructions_count;
+    const lmnt_threaded_instruction* t;
+
+dispatch:
+    if (LMNT_UNLIKELY(opresult | (ctx->status_flags & LMNT_ISTATUS_INTERRUPTED))) {
+        if (opresult == LMNT_BRANCHING) {
+            // the context's instruction pointer has been updated, refresh
+            instr = ctx->cur_instr - 1; // will be incremented momentarily
+        } else {
+            // if we've been interrupted, the last instruction has run, so resuming starts at the next one
+            if (opresult == LMNT_OK)
+                ++instr;
+            goto endcheck;
+        }
+    }
+
+#define GENERATE_DISPATCHOK() \
+    if (++instr >= icount || (ctx->status_flags & LMNT_ISTATUS_INTERRUPTED))\
+        goto endcheck;\
+    t = &code[instr];\
+    goto *t->handler;
+
+    GENERATE_DISPATCHOK();
+
+#define GENERATE_OP(name, nextstop) \
+top_##name: \
+    opresult = lmnt_op_##name(ctx, t->in.arg1, t->in.arg2, t->in.arg3); \
+    goto nextstop;
+#define GENERATE_OP_NOFAIL(name) \
+top_##name: \
+    lmnt_op_##name(ctx, t->in.arg1, t->in.arg2, t->in.arg3); \
+    GENERATE_DISPATCHOK();
+#define GENERATE_OP_DIRECT(name, expr) \
+top_##name: \
+    expr; \
+    GENERATE_DISPATCHOK();
+#define GENERATE_OP_CMPBR(cond) \
+top_cmpbr##cond: \
+    lmnt_op_cmp(ctx, t->in.arg1, t->in.arg2, t->in.arg3); \
+    t = &code[++instr]; \
+    opresult = lmnt_op_branch##cond(ctx, t->in.arg1, t->in.arg2, t->in.arg3); \
+    goto branchcheck;
+
+top_noop:
+    GENERATE_DISPATCHOK();
+top_return:
+    opresult = LMNT_RETURNING;
+    goto end;
+GENERATE_OP_DIRECT(assignss, *t->ptr3 = *t->ptr1);
+GENERATE_OP_NOFAIL(assignvv);
+GENERATE_OP_NOFAIL(assignsv);
+GENERATE_OP_NOFAIL(assignibs);
+GENERATE_OP_NOFAIL(assignibv);
+GENERATE_OP(dloadiis, dispatch);
+GENERATE_OP(dloadiiv, dispatch);
+GENERATE_OP(dloadirs, dispatch);
+GENERATE_OP(dloadirv, dispatch);
+GENERATE_OP_NOFAIL(dseclen);
+GENERATE_OP_DIRECT(addss, *t->ptr3 = *t->ptr1 + *t->ptr2);
+GENERATE_OP_NOFAIL(addvv);
+GENERATE_OP_DIRECT(subss, *t->ptr3 = *t->ptr1 - *t->ptr2);
+GENERATE_OP_NOFAIL(subvv);
+GENERATE_OP_DIRECT(mulss, *t->ptr3 = *t->ptr1 * *t->ptr2);
+GENERATE_OP_NOFAIL(mulvv);
+GENERATE_OP_DIRECT(divss, *t->ptr3 = *t->ptr1 / *t->ptr2);
+GENERATE_OP_NOFAIL(divvv);
+GENERATE_OP_NOFAIL(remss);
+GENERATE_OP_NOFAIL(remvv);
+GENERATE_OP_NOFAIL(sin);
+GENERATE_OP_NOFAIL(cos);
+GENERATE_OP_NOFAIL(tan);
+GENERATE_OP_NOFAIL(asin);
+GENERATE_OP_NOFAIL(acos);
+GENERATE_OP_NOFAIL(atan);
+GENERATE_OP_NOFAIL(atan2);
+GENERATE_OP_NOFAIL(sincos);
+GENERATE_OP_NOFAIL(powss);
+GENERATE_OP_NOFAIL(powvv);
+GENERATE_OP_NOFAIL(powvs);
+GENERATE_OP_NOFAIL(sqrts);
+GENERATE_OP_NOFAIL(sqrtv);
+GENERATE_OP_NOFAIL(ln);
+GENERATE_OP_NOFAIL(log2);
+GENERATE_OP_NOFAIL(log10);
+GENERATE_OP_NOFAIL(abss);
+GENERATE_OP_NOFAIL(absv);
+GENERATE_OP_NOFAIL(sumv);
+GENERATE_OP_NOFAIL(minss);
+GENERATE_OP_NOFAIL(minvv);
+GENERATE_OP_NOFAIL(maxss);
+GENERATE_OP_NOFAIL(maxvv);
+GENERATE_OP_NOFAIL(minvs);
+GENERATE_OP_NOFAIL(maxvs);
+GENERATE_OP_NOFAIL(floors);
+GENERATE_OP_NOFAIL(floorv);
+GENERATE_OP_NOFAIL(rounds);
+GENERATE_OP_NOFAIL(roundv);
+GENERATE_OP_NOFAIL(ceils);
+GENERATE_OP_NOFAIL(ceilv);
+GENERATE_OP_NOFAIL(truncs);
+GENERATE_OP_NOFAIL(truncv);
+GENERATE_OP(indexris, dispatch);
+GENERATE_OP(indexrir, dispatch);
+GENERATE_OP(branch, branchcheck);
+GENERATE_OP(branchz, branchcheck);
+GENERATE_OP(branchnz, branchcheck);
+GENERATE_OP(branchpos, branchcheck);
+GENERATE_OP(branchneg, branchcheck);
+GENERATE_OP(branchun, branchcheck);
+GENERATE_OP_NOFAIL(cmp);
+GENERATE_OP_NOFAIL(cmpz);
+GENERATE_OP(branchceq, branchcheck);
+GENERATE_OP(branchcne, branchcheck);
+GENERATE_OP(branchclt, branchcheck);
+GENERATE_OP(branchcle, branchcheck);
+GENERATE_OP(branchcgt, branchcheck);
+GENERATE_OP(branchcge, branchcheck);
+GENERATE_OP(branchcun, branchcheck);
+GENERATE_OP_NOFAIL(assignceq);
+GENERATE_OP_NOFAIL(assigncne);
+GENERATE_OP_NOFAIL(assignclt);
+GENERATE_OP_NOFAIL(assigncle);
+GENERATE_OP_NOFAIL(assigncgt);
+GENERATE_OP_NOFAIL(assigncge);
+GENERATE_OP_NOFAIL(assigncun);
+GENERATE_OP(extcall, dispatch);
+top_fmass:
+    *t->ptr3 = *t->ptr1 * *t->ptr2;
+    t = &code[++instr];
+    *t->ptr3 = *t->ptr1 + *t->ptr2;
+    GENERATE_DISPATCHOK();
+GENERATE_OP_CMPBR(ceq);
+GENERATE_OP_CMPBR(cne);
+GENERATE_OP_CMPBR(clt);
+GENERATE_OP_CMPBR(cle);
+GENERATE_OP_CMPBR(cgt);
+GENERATE_OP_CMPBR(cge);
+GENERATE_OP_CMPBR(cun);
+top_assign4ss:
+    *t[0].ptr3 = *t[0].ptr1;
+    *t[1].ptr3 = *t[1].ptr1;
+    *t[2].ptr3 = *t[2].ptr1;
+    *t[3].ptr3 = *t[3].ptr1;
+    instr += 3;
+    GENERATE_DISPATCHOK();
+
+#undef GENERATE_OP_CMPBR
+#undef GENERATE_OP_DIRECT
 #undef GENERATE_DISPATCHOK
 #undef GENERATE_OP_NOFAIL
 #undef GENERATE_OP
@@ -235,6 +557,12 @@ end:
 
 branchcheck:
     if (opresult == LMNT_BRANCHING) {
+        if (LMNT_UNLIKELY(lmnt_charge_branch(ctx, instr, ctx->cur_instr))) {
+            // out of budget, stop such that resuming starts at the branch target
+            instr = ctx->cur_instr;
+            opresult = LMNT_INTERRUPTED;
+            goto end;
+        }
         // the context's instruction pointer has been updated, refresh
         instr = ctx->cur_instr - 1; // will be incremented momentarily
         opresult = LMNT_OK;
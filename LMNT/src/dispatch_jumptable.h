@@ -100,6 +100,16 @@ LMNT_ATTR_FAST static const lmnt_op_fn lmnt_op_functions[LMNT_OP_END] = {
     lmnt_op_assigncge,
     lmnt_op_assigncun,
     lmnt_op_extcall,
+    // superinstructions run as their base op here, the rest of the group follows as normal
+    lmnt_op_mulss,
+    lmnt_op_cmp,
+    lmnt_op_cmp,
+    lmnt_op_cmp,
+    lmnt_op_cmp,
+    lmnt_op_cmp,
+    lmnt_op_cmp,
+    lmnt_op_cmp,
+    lmnt_op_assignss,
 };
 
 LMNT_ATTR_FAST static inline LMNT_FORCEINLINE lmnt_result execute_instruction(lmnt_ictx* ctx, const lmnt_instruction op)
@@ -122,10 +132,21 @@ LMNT_ATTR_FAST static inline LMNT_FORCEINLINE lmnt_result execute_function(lmnt_
 #endif
         if (LMNT_UNLIKELY(opresult | (ctx->status_flags & LMNT_ISTATUS_INTERRUPTED))) {
             if (opresult == LMNT_BRANCHING) {
+                if (LMNT_UNLIKELY(lmnt_charge_branch(ctx, instr, ctx->cur_instr))) {
+                    // out of budget, stop such that resuming starts at the branch target
+                    instr = ctx->cur_instr;
+                    opresult = LMNT_INTERRUPTED;
+                    break;
+                }
                 // the context's instruction pointer has been updated, refresh
                 instr = ctx->cur_instr - 1; // will be incremented by loop
                 continue;
             } else {
+                if (opresult == LMNT_OK && (ctx->status_flags & LMNT_ISTATUS_INTERRUPTED)) {
+                    // this instruction has run, so resuming starts at the next one
+                    ++instr;
+                    opresult = LMNT_INTERRUPTED;
+                }
                 break;
             }
         }
@@ -134,6 +155,12 @@ LMNT_ATTR_FAST static inline LMNT_FORCEINLINE lmnt_result execute_function(lmnt_
     return opresult;
 }
 
+LMNT_ATTR_FAST static inline lmnt_result execute_function_threaded(lmnt_ictx* ctx, const lmnt_code* defcode, const lmnt_threaded_instruction* code, const void* const** handlers)
+{
+    // threaded code relies on computed gotos
+    return LMNT_ERROR_FEATURE_DISABLED;
+}
+
 LMNT_ATTR_FAST static inline LMNT_FORCEINLINE lmnt_result interrupt_function(lmnt_ictx* ctx)
 {
     ctx->status_flags |= LMNT_ISTATUS_INTERRUPTED;
@@ -114,6 +114,34 @@ LMNT_ATTR_FAST static inline LMNT_FORCEINLINE lmnt_result execute_function(lmnt_
         case LMNT_OP_ASSIGNCGE: opresult = lmnt_op_assigncge(ctx, op.arg1, op.arg2, op.arg3); break;
         case LMNT_OP_ASSIGNCUN: opresult = lmnt_op_assigncun(ctx, op.arg1, op.arg2, op.arg3); break;
         case LMNT_OP_EXTCALL:   opresult = lmnt_op_extcall(ctx, op.arg1, op.arg2, op.arg3); break;
+        case LMNT_OP_FMASS:
+            lmnt_op_mulss(ctx, op.arg1, op.arg2, op.arg3);
+            ++instr;
+            opresult = lmnt_op_addss(ctx, instructions[instr].arg1, instructions[instr].arg2, instructions[instr].arg3);
+            break;
+        case LMNT_OP_CMPBRCEQ: case LMNT_OP_CMPBRCNE: case LMNT_OP_CMPBRCLT: case LMNT_OP_CMPBRCLE:
+        case LMNT_OP_CMPBRCGT: case LMNT_OP_CMPBRCGE: case LMNT_OP_CMPBRCUN:
+            lmnt_op_cmp(ctx, op.arg1, op.arg2, op.arg3);
+            ++instr;
+            switch (instructions[instr].opcode)
+            {
+            case LMNT_OP_BRANCHCEQ: opresult = lmnt_op_branchceq(ctx, instructions[instr].arg1, instructions[instr].arg2, instructions[instr].arg3); break;
+            case LMNT_OP_BRANCHCNE: opresult = lmnt_op_branchcne(ctx, instructions[instr].arg1, instructions[instr].arg2, instructions[instr].arg3); break;
+            case LMNT_OP_BRANCHCLT: opresult = lmnt_op_branchclt(ctx, instructions[instr].arg1, instructions[instr].arg2, instructions[instr].arg3); break;
+            case LMNT_OP_BRANCHCLE: opresult = lmnt_op_branchcle(ctx, instructions[instr].arg1, instructions[instr].arg2, instructions[instr].arg3); break;
+            case LMNT_OP_BRANCHCGT: opresult = lmnt_op_branchcgt(ctx, instructions[instr].arg1, instructions[instr].arg2, instructions[instr].arg3); break;
+            case LMNT_OP_BRANCHCGE: opresult = lmnt_op_branchcge(ctx, instructions[instr].arg1, instructions[instr].arg2, instructions[instr].arg3); break;
+            case LMNT_OP_BRANCHCUN: opresult = lmnt_op_branchcun(ctx, instructions[instr].arg1, instructions[instr].arg2, instructions[instr].arg3); break;
+            default:                LMNT_UNREACHABLE(); opresult = LMNT_ERROR_INTERNAL; break;
+            }
+            break;
+        case LMNT_OP_ASSIGN4SS:
+            lmnt_op_assignss(ctx, op.arg1, op.arg2, op.arg3);
+            lmnt_op_assignss(ctx, instructions[instr + 1].arg1, instructions[instr + 1].arg2, instructions[instr + 1].arg3);
+            lmnt_op_assignss(ctx, instructions[instr + 2].arg1, instructions[instr + 2].arg2, instructions[instr + 2].arg3);
+            instr += 3;
+            opresult = lmnt_op_assignss(ctx, instructions[instr].arg1, instructions[instr].arg2, instructions[instr].arg3);
+            break;
         default:                LMNT_UNREACHABLE(); opresult = LMNT_ERROR_INTERNAL; break;
         }
 
@@ -122,12 +150,21 @@ LMNT_ATTR_FAST static inline LMNT_FORCEINLINE lmnt_result execute_function(lmnt_
 #endif
         if (LMNT_UNLIKELY(opresult | (ctx->status_flags & LMNT_ISTATUS_INTERRUPTED))) {
             if (opresult == LMNT_BRANCHING) {
+                if (LMNT_UNLIKELY(lmnt_charge_branch(ctx, instr, ctx->cur_instr))) {
+                    // out of budget, stop such that resuming starts at the branch target
+                    instr = ctx->cur_instr;
+                    opresult = LMNT_INTERRUPTED;
+                    break;
+                }
                 // the context's instruction pointer has been updated, refresh
                 instr = ctx->cur_instr - 1; // will be incremented in the next iteration
                 continue;
             } else {
-                if (opresult == LMNT_OK && (ctx->status_flags & LMNT_ISTATUS_INTERRUPTED))
+                if (opresult == LMNT_OK && (ctx->status_flags & LMNT_ISTATUS_INTERRUPTED)) {
+                    // this instruction has run, so resuming starts at the next one
+                    ++instr;
                     opresult = LMNT_INTERRUPTED;
+                }
                 break;
             }
         }
@@ -137,6 +174,12 @@ LMNT_ATTR_FAST static inline LMNT_FORCEINLINE lmnt_result execute_function(lmnt_
     return opresult;
 }
 
+LMNT_ATTR_FAST static inline lmnt_result execute_function_threaded(lmnt_ictx* ctx, const lmnt_code* defcode, const lmnt_threaded_instruction* code, const void* const** handlers)
+{
+    // threaded code relies on computed gotos
+    return LMNT_ERROR_FEATURE_DISABLED;
+}
+
 LMNT_ATTR_FAST static inline LMNT_FORCEINLINE lmnt_result interrupt_function(lmnt_ictx* ctx)
 {
     ctx->status_flags |= LMNT_ISTATUS_INTERRUPTED;
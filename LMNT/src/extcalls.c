@@ -11,6 +11,18 @@ lmnt_result lmnt_extcalls_get(const lmnt_ictx* ctx, const lmnt_extcall_info** ta
 
 lmnt_result lmnt_extcalls_set(lmnt_ictx* ctx, const lmnt_extcall_info* table, size_t table_count)
 {
+    for (size_t i = 0; i < table_count; ++i)
+    {
+        if (table[i].flags & LMNT_EXTCALL_PURE_SCALAR)
+        {
+            if (!table[i].scalar_function)
+                return LMNT_ERROR_INVALID_PTR;
+            if (table[i].args_count > LMNT_EXTCALL_PURE_SCALAR_MAX_ARGS)
+                return LMNT_ERROR_ARGS_MISMATCH;
+            if (table[i].rvals_count != 1)
+                return LMNT_ERROR_RVALS_MISMATCH;
+        }
+    }
     ctx->extcalls = table;
     ctx->extcalls_count = table_count;
     ctx->archive.flags &= ~LMNT_ARCHIVE_VALIDATED;
@@ -45,3 +57,16 @@ lmnt_result lmnt_extcall_find_index(const lmnt_extcall_info* table, size_t table
     }
     return LMNT_ERROR_NOT_FOUND;
 }
+
+lmnt_result lmnt_extcall_invoke(lmnt_ictx* ctx, const lmnt_extcall_info* extcall, const lmnt_value* args, lmnt_value* rvals)
+{
+    if (extcall->flags & LMNT_EXTCALL_PURE_SCALAR)
+    {
+        lmnt_value a[LMNT_EXTCALL_PURE_SCALAR_MAX_ARGS] = { 0 };
+        for (lmnt_offset i = 0; i < extcall->args_count; ++i)
+            a[i] = args[i];
+        rvals[0] = extcall->scalar_function(a[0], a[1], a[2], a[3]);
+        return LMNT_OK;
+    }
+    return extcall->function(ctx, extcall, args, rvals);
+}
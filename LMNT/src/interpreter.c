@@ -6,6 +6,7 @@
 #include <assert.h>
 #include <math.h>
 #include <string.h>
+#include <stdbool.h>
 
 // Used by dispatch headers
 void print_execution_context(lmnt_ictx* ctx, lmnt_loffset inst_idx, const lmnt_instruction op);
@@ -14,6 +15,7 @@ void print_execution_context(lmnt_ictx* ctx, lmnt_loffset inst_idx, const lmnt_i
 // Computed GOTOs are faster but only available where GNU C is
 // Each header defines these functions with the same signatures:
 LMNT_ATTR_FAST static inline lmnt_result execute_function(lmnt_ictx* ctx, const lmnt_code* defcode, const lmnt_instruction* instructions);
+LMNT_ATTR_FAST static inline lmnt_result execute_function_threaded(lmnt_ictx* ctx, const lmnt_code* defcode, const lmnt_threaded_instruction* code, const void* const** handlers);
 LMNT_ATTR_FAST static inline lmnt_result interrupt_function(lmnt_ictx* ctx);
 static const char* const dispatch_method(void);
 // Include the header
@@ -53,6 +55,7 @@ lmnt_result lmnt_load_archive(lmnt_ictx* ctx, const char* data, size_t data_size
 
 lmnt_result lmnt_load_archive_begin(lmnt_ictx* ctx)
 {
+    ctx->threaded_code = NULL;
     return lmnt_archive_init(&ctx->archive, ctx->memory_area, 0);
 }
 
@@ -73,16 +76,24 @@ lmnt_result lmnt_load_archive_end(lmnt_ictx* ctx)
 lmnt_result lmnt_load_inplace_archive(lmnt_ictx* ctx, const char* data, size_t data_size)
 {
     // Don't copy the archive in, just use it where it is
+    ctx->threaded_code = NULL;
     LMNT_OK_OR_RETURN(lmnt_archive_init(&ctx->archive, data, data_size));
     ctx->archive.flags |= LMNT_ARCHIVE_INPLACE;
     return LMNT_OK;
 }
 
-lmnt_result lmnt_prepare_archive(lmnt_ictx* ctx, lmnt_validation_result* vresult)
+static lmnt_result prepare_archive(lmnt_ictx* ctx, lmnt_validation_result* vresult, bool lazy)
 {
-    lmnt_validation_result vr = lmnt_archive_validate(&ctx->archive, ctx->memory_area_size, &ctx->stack_count);
+    // in-place archives are read-only, so there's nowhere to record which defs have been validated
+    if (ctx->archive.flags & LMNT_ARCHIVE_INPLACE)
+        lazy = false;
+    lmnt_validation_result vr = lazy
+        ? lmnt_archive_validate_lazy(&ctx->archive, ctx->memory_area_size, &ctx->stack_count)
+        : lmnt_archive_validate(&ctx->archive, ctx->memory_area_size, &ctx->stack_count);
     if (vresult)
         *vresult = vr;
+    // any existing threaded code no longer matches the archive
+    ctx->threaded_code = NULL;
     if (vr != LMNT_VALIDATION_OK)
         return LMNT_ERROR_INVALID_ARCHIVE;
 
@@ -105,6 +116,115 @@ lmnt_result lmnt_prepare_archive(lmnt_ictx* ctx, lmnt_validation_result* vresult
     // fill in extern defs' code value to point to the right extcall
     LMNT_OK_OR_RETURN(lmnt_archive_update_def_extcalls(&ctx->archive, ctx->extcalls, ctx->extcalls_count));
 
+#if !defined(LMNT_NO_SUPERINSTRUCTIONS)
+    // in-place archives are read-only, so they run unfused
+    // lazily-validated defs are fused as they're validated instead
+    if (!(ctx->archive.flags & LMNT_ARCHIVE_INPLACE) && !lazy)
+        LMNT_OK_OR_RETURN(lmnt_archive_fuse_instructions(&ctx->archive));
+#endif
+
+    return LMNT_OK;
+}
+
+lmnt_result lmnt_prepare_archive(lmnt_ictx* ctx, lmnt_validation_result* vresult)
+{
+    return prepare_archive(ctx, vresult, false);
+}
+
+lmnt_result lmnt_prepare_archive_lazy(lmnt_ictx* ctx, lmnt_validation_result* vresult)
+{
+    return prepare_archive(ctx, vresult, true);
+}
+
+lmnt_result lmnt_validate_def(lmnt_ictx* ctx, const lmnt_def* def, lmnt_validation_result* vresult)
+{
+    assert(ctx && def);
+    LMNT_ENSURE_VALIDATED(&ctx->archive);
+    if (vresult)
+        *vresult = LMNT_VALIDATION_OK;
+    if (lmnt_archive_def_is_validated(&ctx->archive, def))
+        return LMNT_OK;
+
+    lmnt_validation_result vr = lmnt_archive_validate_def(&ctx->archive, def, ctx->stack_count);
+    if (vresult)
+        *vresult = vr;
+    if (vr != LMNT_VALIDATION_OK)
+        return LMNT_ERROR_INVALID_ARCHIVE;
+
+#if !defined(LMNT_NO_SUPERINSTRUCTIONS)
+    LMNT_OK_OR_RETURN(lmnt_archive_fuse_def_instructions(&ctx->archive, def));
+#endif
+    // only now is the def ready to run, so nothing can use it before it's been fused
+    lmnt_archive_set_def_validated(&ctx->archive, def);
+    return LMNT_OK;
+}
+
+// Threaded code is laid out in parallel with the code segment: the instruction at byte offset N is found at index N / sizeof(lmnt_instruction)
+// Code headers are smaller than an instruction, so this never maps two instructions to the same index
+static inline size_t get_threaded_code_count(const lmnt_archive* archive)
+{
+    return get_header(archive)->code_length / sizeof(lmnt_instruction) + 1;
+}
+
+static inline size_t get_threaded_code_index(lmnt_loffset code)
+{
+    return (code + sizeof(lmnt_code)) / sizeof(lmnt_instruction);
+}
+
+static inline lmnt_value* get_threaded_operand(lmnt_ictx* ctx, lmnt_operand_type type, lmnt_offset arg)
+{
+    return (type == LMNT_OPERAND_STACK1 || type == LMNT_OPERAND_STACK4) ? ctx->stack + arg : NULL;
+}
+
+lmnt_result lmnt_get_threaded_code_size(const lmnt_ictx* ctx, size_t* size)
+{
+    assert(ctx && size);
+    LMNT_ENSURE_VALIDATED(&ctx->archive);
+    *size = get_threaded_code_count(&ctx->archive) * sizeof(lmnt_threaded_instruction);
+    return LMNT_OK;
+}
+
+lmnt_result lmnt_prepare_threaded_code(lmnt_ictx* ctx, void* buffer, size_t buffer_size)
+{
+    assert(ctx);
+    LMNT_ENSURE_VALIDATED(&ctx->archive);
+    if (!ctx->stack)
+        return LMNT_ERROR_UNPREPARED_ARCHIVE;
+    if (!buffer || ((uintptr_t)buffer % sizeof(void*)) != 0)
+        return LMNT_ERROR_INVALID_PTR;
+    if (buffer_size < get_threaded_code_count(&ctx->archive) * sizeof(lmnt_threaded_instruction))
+        return LMNT_ERROR_MEMORY_SIZE;
+
+    const void* const* handlers = NULL;
+    LMNT_OK_OR_RETURN(execute_function_threaded(ctx, NULL, NULL, &handlers));
+
+    // all of the code is decoded up front, so it must all be validated first
+    const lmnt_archive_header* hdr = get_header(&ctx->archive);
+    for (size_t defindex = 0; defindex < hdr->defs_length; defindex += sizeof(lmnt_def))
+        LMNT_OK_OR_RETURN(lmnt_validate_def(ctx, validated_get_def(&ctx->archive, (lmnt_loffset)defindex), NULL));
+
+    lmnt_threaded_instruction* tcode = (lmnt_threaded_instruction*)buffer;
+    for (size_t defindex = 0; defindex < hdr->defs_length; defindex += sizeof(lmnt_def))
+    {
+        const lmnt_def* def = validated_get_def(&ctx->archive, (lmnt_loffset)defindex);
+        if (def->flags & LMNT_DEFFLAG_EXTERN)
+            continue;
+
+        const lmnt_code* defcode = validated_get_code(&ctx->archive, def->code);
+        const lmnt_instruction* instructions = validated_get_code_instructions(&ctx->archive, def->code);
+        lmnt_threaded_instruction* out = tcode + get_threaded_code_index(def->code);
+        for (lmnt_loffset i = 0; i < defcode->instructions_count; ++i)
+        {
+            const lmnt_op_info* info = lmnt_get_opcode_info(instructions[i].opcode);
+            out[i].handler = handlers[instructions[i].opcode];
+            out[i].ptr1 = get_threaded_operand(ctx, info->operand1, instructions[i].arg1);
+            out[i].ptr2 = get_threaded_operand(ctx, info->operand2, instructions[i].arg2);
+            out[i].ptr3 = get_threaded_operand(ctx, info->operand3, instructions[i].arg3);
+            out[i].in = instructions[i];
+        }
+    }
+
+    ctx->threaded_code = tcode;
     return LMNT_OK;
 }
 
@@ -162,7 +282,10 @@ LMNT_ATTR_FAST static lmnt_result execute(lmnt_ictx* ctx, lmnt_value* rvals, con
         const lmnt_instruction* instructions = validated_get_code_instructions(&ctx->archive, def->code);
 
         // Execute using function defined in dispatch_*.h
-        opresult = execute_function(ctx, defcode, instructions);
+        if (ctx->threaded_code)
+            opresult = execute_function_threaded(ctx, defcode, ctx->threaded_code + get_threaded_code_index(def->code), NULL);
+        else
+            opresult = execute_function(ctx, defcode, instructions);
     }
     else
     {
@@ -171,7 +294,7 @@ LMNT_ATTR_FAST static lmnt_result execute(lmnt_ictx* ctx, lmnt_value* rvals, con
 
         lmnt_value* const eargs = &ctx->writable_stack[0];
         lmnt_value* const ervals = &ctx->writable_stack[extcall->args_count];
-        opresult = extcall->function(ctx, extcall, eargs, ervals);
+        opresult = lmnt_extcall_invoke(ctx, extcall, eargs, ervals);
     }
 
     // If we finished or hit an error, clear the context's current def
@@ -194,12 +317,23 @@ LMNT_ATTR_FAST static lmnt_result execute(lmnt_ictx* ctx, lmnt_value* rvals, con
     return opresult;
 }
 
-LMNT_ATTR_FAST lmnt_result lmnt_execute(
+LMNT_ATTR_FAST static inline void set_budget(lmnt_ictx* ctx, bool budgeted, uint32_t budget)
+{
+    if (budgeted)
+        ctx->status_flags |= LMNT_ISTATUS_BUDGETED;
+    else
+        ctx->status_flags &= ~LMNT_ISTATUS_BUDGETED;
+    ctx->budget = budget;
+}
+
+LMNT_ATTR_FAST static inline lmnt_result start(
     lmnt_ictx* ctx, const lmnt_def* def,
     lmnt_value* rvals, const lmnt_offset rvals_count)
 {
     assert(ctx && ctx->stack && ctx->stack_count);
     assert(def);
+    if (LMNT_UNLIKELY(!lmnt_archive_def_is_validated(&ctx->archive, def)))
+        LMNT_OK_OR_RETURN(lmnt_validate_def(ctx, def, NULL));
     // Set our current instruction to be the start of the requested def
     ctx->cur_def = def;
     ctx->cur_instr = 0;
@@ -208,7 +342,7 @@ LMNT_ATTR_FAST lmnt_result lmnt_execute(
     return execute(ctx, rvals, rvals_count);
 }
 
-LMNT_ATTR_FAST lmnt_result lmnt_resume(
+LMNT_ATTR_FAST static inline lmnt_result resume(
     lmnt_ictx* ctx, const lmnt_def* def,
     lmnt_value* rvals, const lmnt_offset rvals_count)
 {
@@ -217,10 +351,46 @@ LMNT_ATTR_FAST lmnt_result lmnt_resume(
     // Make sure the def we're resuming is the one the user thinks we are
     if (LMNT_UNLIKELY(ctx->cur_def != def))
         return LMNT_ERROR_DEF_MISMATCH;
+    // Any previous interrupt has now been dealt with
+    ctx->status_flags &= ~LMNT_ISTATUS_INTERRUPTED;
     // Run main execute loop
     return execute(ctx, rvals, rvals_count);
 }
 
+LMNT_ATTR_FAST lmnt_result lmnt_execute(
+    lmnt_ictx* ctx, const lmnt_def* def,
+    lmnt_value* rvals, const lmnt_offset rvals_count)
+{
+    set_budget(ctx, false, 0);
+    return start(ctx, def, rvals, rvals_count);
+}
+
+LMNT_ATTR_FAST lmnt_result lmnt_resume(
+    lmnt_ictx* ctx, const lmnt_def* def,
+    lmnt_value* rvals, const lmnt_offset rvals_count)
+{
+    set_budget(ctx, false, 0);
+    return resume(ctx, def, rvals, rvals_count);
+}
+
+LMNT_ATTR_FAST lmnt_result lmnt_execute_budgeted(
+    lmnt_ictx* ctx, const lmnt_def* def,
+    lmnt_value* rvals, const lmnt_offset rvals_count,
+    uint32_t budget)
+{
+    set_budget(ctx, true, budget);
+    return start(ctx, def, rvals, rvals_count);
+}
+
+LMNT_ATTR_FAST lmnt_result lmnt_resume_budgeted(
+    lmnt_ictx* ctx, const lmnt_def* def,
+    lmnt_value* rvals, const lmnt_offset rvals_count,
+    uint32_t budget)
+{
+    set_budget(ctx, true, budget);
+    return resume(ctx, def, rvals, rvals_count);
+}
+
 lmnt_result lmnt_interrupt(lmnt_ictx* ctx)
 {
     assert(ctx);
@@ -244,9 +414,29 @@ lmnt_result lmnt_update_args(
     return LMNT_OK;
 }
 
-lmnt_result lmnt_find_def(const lmnt_ictx* ctx, const char* name, const lmnt_def** def)
+lmnt_result lmnt_get_args_ptr(lmnt_ictx* ctx, const lmnt_def* def, lmnt_value** args)
 {
-    return lmnt_archive_find_def(&ctx->archive, name, def);
+    assert(ctx && def && args);
+    LMNT_ENSURE_VALIDATED(&ctx->archive);
+    *args = ctx->writable_stack;
+    return LMNT_OK;
+}
+
+lmnt_result lmnt_get_rvals_ptr(lmnt_ictx* ctx, const lmnt_def* def, lmnt_value** rvals)
+{
+    assert(ctx && def && rvals);
+    LMNT_ENSURE_VALIDATED(&ctx->archive);
+    *rvals = ctx->writable_stack + def->args_count;
+    return LMNT_OK;
+}
+
+lmnt_result lmnt_find_def(lmnt_ictx* ctx, const char* name, const lmnt_def** def)
+{
+    const lmnt_def* found;
+    LMNT_OK_OR_RETURN(lmnt_archive_find_def(&ctx->archive, name, &found));
+    LMNT_OK_OR_RETURN(lmnt_validate_def(ctx, found, NULL));
+    *def = found;
+    return LMNT_OK;
 }
 
 const char* lmnt_get_dispatch_method(void)
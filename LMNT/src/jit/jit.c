@@ -3,30 +3,55 @@
 #include "lmnt/jit.h"
 #include "lmnt/platform.h"
 #include "jit/hosthelpers.h"
+#include "jit/jitdebug.h"
+#include "jit/specialise.h"
 #include "helpers.h"
 
 #include LMNT_MEMORY_HEADER
 
 #if defined(LMNT_JIT_HAS_X86_64)
-lmnt_result lmnt_jit_x86_64_compile(lmnt_ictx* ctx, const lmnt_def* def, lmnt_jit_fn_data* fndata, lmnt_jit_compile_stats* stats);
+lmnt_result lmnt_jit_x86_64_compile(
+    lmnt_ictx* ctx, const lmnt_def* def,
+    const lmnt_instruction* instructions, lmnt_loffset instructions_count,
+    lmnt_jit_fn_data* fndata, lmnt_jit_compile_stats* stats);
 #endif
 #if defined(LMNT_JIT_HAS_ARMV7M)
-lmnt_result lmnt_jit_armv7m_compile(lmnt_ictx* ctx, const lmnt_def* def, lmnt_jit_fn_data* fndata, lmnt_jit_compile_stats* stats);
+lmnt_result lmnt_jit_armv7m_compile(
+    lmnt_ictx* ctx, const lmnt_def* def,
+    const lmnt_instruction* instructions, lmnt_loffset instructions_count,
+    lmnt_jit_fn_data* fndata, lmnt_jit_compile_stats* stats);
 #endif
 
 
-LMNT_ATTR_FAST lmnt_result lmnt_jit_execute(
+LMNT_ATTR_FAST static inline void set_budget(lmnt_ictx* ctx, bool budgeted, uint32_t budget)
+{
+    if (budgeted)
+        ctx->status_flags |= LMNT_ISTATUS_BUDGETED;
+    else
+        ctx->status_flags &= ~LMNT_ISTATUS_BUDGETED;
+    ctx->budget = budget;
+}
+
+LMNT_ATTR_FAST static lmnt_result jit_execute(
     lmnt_ictx* ctx, const lmnt_jit_fn_data* fndata,
-    lmnt_value* rvals, const lmnt_offset rvals_count)
+    lmnt_value* rvals, const lmnt_offset rvals_count,
+    bool resuming)
 {
     assert(ctx && ctx->archive.data);
     assert(ctx->stack && ctx->stack_count);
 
     const lmnt_def* const def = fndata->def;
-    ctx->cur_def = def;
-    ctx->cur_instr = (lmnt_loffset)-1;
-    lmnt_offset consts_count = validated_get_constants_count(&ctx->archive);
-    ctx->cur_stack_count = (size_t)consts_count + def->stack_count;
+    if (resuming) {
+        // Make sure the def we're resuming is the one the user thinks we are
+        if (LMNT_UNLIKELY(ctx->cur_def != def))
+            return LMNT_ERROR_DEF_MISMATCH;
+        ctx->status_flags &= ~LMNT_ISTATUS_INTERRUPTED;
+    } else {
+        ctx->cur_def = def;
+        ctx->cur_instr = (lmnt_loffset)-1;
+        lmnt_offset consts_count = validated_get_constants_count(&ctx->archive);
+        ctx->cur_stack_count = (size_t)consts_count + def->stack_count;
+    }
 
     if (LMNT_UNLIKELY(rvals && rvals_count < def->rvals_count))
         return LMNT_ERROR_RVALS_MISMATCH;
@@ -34,7 +59,7 @@ LMNT_ATTR_FAST lmnt_result lmnt_jit_execute(
     lmnt_result opresult = LMNT_OK;
     if ((def->flags & LMNT_DEFFLAG_EXTERN) == 0)
     {
-        opresult = fndata->function(ctx);
+        opresult = resuming ? fndata->resume(ctx) : fndata->function(ctx);
     }
     else
     {
@@ -43,7 +68,7 @@ LMNT_ATTR_FAST lmnt_result lmnt_jit_execute(
 
         lmnt_value* const eargs = &ctx->writable_stack[0];
         lmnt_value* const ervals = &ctx->writable_stack[extcall->args_count];
-        opresult = extcall->function(ctx, extcall, eargs, ervals);
+        opresult = lmnt_extcall_invoke(ctx, extcall, eargs, ervals);
     }
 
     // If we finished or hit an error, clear the context's current def
@@ -63,43 +88,107 @@ LMNT_ATTR_FAST lmnt_result lmnt_jit_execute(
     return opresult;
 }
 
+LMNT_ATTR_FAST lmnt_result lmnt_jit_execute(
+    lmnt_ictx* ctx, const lmnt_jit_fn_data* fndata,
+    lmnt_value* rvals, const lmnt_offset rvals_count)
+{
+    set_budget(ctx, false, 0);
+    return jit_execute(ctx, fndata, rvals, rvals_count, false);
+}
 
-lmnt_result lmnt_jit_compile(lmnt_ictx* ctx, const lmnt_def* def, lmnt_jit_target target, lmnt_jit_fn_data* fndata)
+LMNT_ATTR_FAST lmnt_result lmnt_jit_execute_budgeted(
+    lmnt_ictx* ctx, const lmnt_jit_fn_data* fndata,
+    lmnt_value* rvals, const lmnt_offset rvals_count,
+    uint32_t budget)
+{
+    if (LMNT_UNLIKELY(!fndata->supports_budget))
+        return LMNT_ERROR_NO_IMPL;
+    set_budget(ctx, true, budget);
+    return jit_execute(ctx, fndata, rvals, rvals_count, false);
+}
+
+LMNT_ATTR_FAST lmnt_result lmnt_jit_resume_budgeted(
+    lmnt_ictx* ctx, const lmnt_jit_fn_data* fndata,
+    lmnt_value* rvals, const lmnt_offset rvals_count,
+    uint32_t budget)
+{
+    if (LMNT_UNLIKELY(!fndata->supports_budget || !fndata->resume))
+        return LMNT_ERROR_NO_IMPL;
+    set_budget(ctx, true, budget);
+    return jit_execute(ctx, fndata, rvals, rvals_count, true);
+}
+
+
+static lmnt_result jit_compile_instructions(
+    lmnt_ictx* ctx, const lmnt_def* def, lmnt_jit_target target,
+    const lmnt_instruction* instructions, lmnt_loffset instructions_count,
+    lmnt_jit_fn_data* fndata, lmnt_jit_compile_stats* stats)
 {
     if (target == LMNT_JIT_TARGET_CURRENT)
         target = LMNT_JIT_TARGET_NATIVE;
+    lmnt_result result;
     switch (target)
     {
 #if defined(LMNT_JIT_HAS_X86_64)
-    case LMNT_JIT_TARGET_X86_64: return lmnt_jit_x86_64_compile(ctx, def, fndata, NULL);
+    case LMNT_JIT_TARGET_X86_64: result = lmnt_jit_x86_64_compile(ctx, def, instructions, instructions_count, fndata, stats); break;
 #endif
 #if defined(LMNT_JIT_HAS_ARMV7M)
-    case LMNT_JIT_TARGET_ARMV7M: return lmnt_jit_armv7m_compile(ctx, def, fndata, NULL);
+    case LMNT_JIT_TARGET_ARMV7M: result = lmnt_jit_armv7m_compile(ctx, def, instructions, instructions_count, fndata, stats); break;
 #endif
     default: return LMNT_ERROR_NO_IMPL;
     }
+
+    if (result == LMNT_OK)
+        lmnt_jit_debug_register(ctx, def, fndata);
+    return result;
+}
+
+static lmnt_result jit_compile(lmnt_ictx* ctx, const lmnt_def* def, lmnt_jit_target target, lmnt_jit_fn_data* fndata, lmnt_jit_compile_stats* stats)
+{
+    const lmnt_code* defcode;
+    const lmnt_instruction* instructions;
+    LMNT_OK_OR_RETURN(lmnt_validate_def(ctx, def, NULL));
+    LMNT_OK_OR_RETURN(lmnt_archive_get_code(&ctx->archive, def->code, &defcode));
+    LMNT_OK_OR_RETURN(lmnt_archive_get_code_instructions(&ctx->archive, def->code, &instructions));
+    return jit_compile_instructions(ctx, def, target, instructions, defcode->instructions_count, fndata, stats);
+}
+
+lmnt_result lmnt_jit_compile(lmnt_ictx* ctx, const lmnt_def* def, lmnt_jit_target target, lmnt_jit_fn_data* fndata)
+{
+    return jit_compile(ctx, def, target, fndata, NULL);
 }
 
 #if defined(LMNT_JIT_COLLECT_STATS)
 lmnt_result lmnt_jit_compile_with_stats(lmnt_ictx* ctx, const lmnt_def* def, lmnt_jit_target target, lmnt_jit_fn_data* fndata, lmnt_jit_compile_stats* stats)
 {
-    if (target == LMNT_JIT_TARGET_CURRENT)
-        target = LMNT_JIT_TARGET_NATIVE;
-    switch (target)
-    {
-#if defined(LMNT_JIT_HAS_X86_64)
-    case LMNT_JIT_TARGET_X86_64: return lmnt_jit_x86_64_compile(ctx, def, fndata, stats);
-#endif
-#if defined(LMNT_JIT_HAS_ARMV7M)
-    case LMNT_JIT_TARGET_ARMV7M: return lmnt_jit_armv7m_compile(ctx, def, fndata, stats);
-#endif
-    default: return LMNT_ERROR_NO_IMPL;
-    }
+    return jit_compile(ctx, def, target, fndata, stats);
 }
 #endif
 
+lmnt_result lmnt_jit_compile_specialised(
+    lmnt_ictx* ctx, const lmnt_def* def, lmnt_jit_target target,
+    const bool* const_mask, const lmnt_value* const_values,
+    lmnt_jit_fn_data* fndata)
+{
+    // specialising reads the def's code, so it has to have been validated like any other compile
+    LMNT_OK_OR_RETURN(lmnt_validate_def(ctx, def, NULL));
+
+    const lmnt_value* values = const_values;
+    lmnt_loffset values_count = def->args_count;
+    if (!values)
+        LMNT_OK_OR_RETURN(lmnt_get_default_args(ctx, def, &values, &values_count));
+
+    lmnt_jit_specialised_code code;
+    LMNT_OK_OR_RETURN(lmnt_jit_specialise(ctx, def, const_mask, values, (lmnt_offset)values_count, &code));
+    const lmnt_result result = jit_compile_instructions(ctx, def, target, code.instructions, code.instructions_count, fndata, NULL);
+    // the backends don't keep hold of the instructions once they've generated code
+    lmnt_jit_specialised_code_free(&code);
+    return result;
+}
+
 lmnt_result lmnt_jit_delete_function(lmnt_jit_fn_data* fndata)
 {
+    lmnt_jit_debug_unregister(fndata);
     LMNT_JIT_FREE_CFN_MEMORY(fndata->buffer, fndata->codesize);
     return LMNT_OK;
 }
@@ -0,0 +1,252 @@
+#include "jit/jitdebug.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "helpers.h"
+
+#if defined(LMNT_JIT_PERF_MAP) && !defined(__linux__)
+#undef LMNT_JIT_PERF_MAP
+#endif
+#if defined(LMNT_JIT_GDB_INTERFACE) && !(defined(__linux__) && defined(LMNT_ARCH_X86_64))
+#undef LMNT_JIT_GDB_INTERFACE
+#endif
+
+#if defined(LMNT_JIT_PERF_MAP) || defined(LMNT_JIT_GDB_INTERFACE)
+#include "jit/threadhelpers.h"
+
+// functions may be compiled on several threads at once (e.g. by a tier), so the map file and GDB's list need a lock
+static host_mutex debug_lock = HOST_MUTEX_INITIALIZER;
+#endif
+
+
+#if defined(LMNT_JIT_PERF_MAP)
+#include <unistd.h>
+
+static void perf_map_write(const void* start, size_t size, const char* name)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/perf-%ld.map", (long)getpid());
+
+    hostMutexLock(&debug_lock);
+    FILE* f = fopen(path, "a");
+    if (f) {
+        fprintf(f, "%lx %zx lmnt:%s\n", (unsigned long)(uintptr_t)start, size, name);
+        fclose(f);
+    }
+    hostMutexUnlock(&debug_lock);
+}
+#endif
+
+
+#if defined(LMNT_JIT_GDB_INTERFACE)
+#include <elf.h>
+
+//
+// GDB JIT interface, see "JIT Compilation Interface" in the GDB manual
+// GDB sets a breakpoint on __jit_debug_register_code and reads the descriptor whenever it's hit
+// The symbols are weak so that we can share them with any other JIT in the same process
+//
+typedef enum
+{
+    JIT_NOACTION = 0,
+    JIT_REGISTER_FN,
+    JIT_UNREGISTER_FN
+} jit_actions_t;
+
+struct jit_code_entry
+{
+    struct jit_code_entry* next_entry;
+    struct jit_code_entry* prev_entry;
+    const char* symfile_addr;
+    uint64_t symfile_size;
+};
+
+struct jit_descriptor
+{
+    uint32_t version;
+    uint32_t action_flag;
+    struct jit_code_entry* relevant_entry;
+    struct jit_code_entry* first_entry;
+};
+
+__attribute__((weak, noinline)) void __jit_debug_register_code(void) { __asm__ __volatile__(""); }
+__attribute__((weak)) struct jit_descriptor __jit_debug_descriptor = { 1, JIT_NOACTION, NULL, NULL };
+
+// The symbol file GDB reads for each function: an ELF relocatable object with one function symbol
+// covering the generated code, with .text marked as already loaded at the code's address
+enum
+{
+    GDB_SECT_NULL = 0,
+    GDB_SECT_TEXT,
+    GDB_SECT_SYMTAB,
+    GDB_SECT_STRTAB,
+    GDB_SECT_SHSTRTAB,
+    GDB_SECT_COUNT
+};
+
+static const char gdb_shstrtab[] = "\0.text\0.symtab\0.strtab\0.shstrtab";
+enum
+{
+    GDB_SHSTR_TEXT = 1,
+    GDB_SHSTR_SYMTAB = 7,
+    GDB_SHSTR_STRTAB = 15,
+    GDB_SHSTR_SHSTRTAB = 23,
+};
+
+typedef struct
+{
+    Elf64_Ehdr hdr;
+    Elf64_Shdr sect[GDB_SECT_COUNT];
+    Elf64_Sym sym[2];
+    char shstrtab[sizeof(gdb_shstrtab)];
+    // followed by the symbol's name
+    char strtab[];
+} gdb_symfile;
+
+typedef struct
+{
+    struct jit_code_entry entry;
+    gdb_symfile symfile;
+} gdb_entry;
+
+static gdb_entry* gdb_create_entry(const void* start, size_t size, const char* name)
+{
+    // "lmnt:" + name + terminator, after the empty string at the start of the table
+    const size_t strtab_size = 1 + 5 + strlen(name) + 1;
+    gdb_entry* e = (gdb_entry*)calloc(1, sizeof(gdb_entry) + strtab_size);
+    if (!e)
+        return NULL;
+
+    gdb_symfile* obj = &e->symfile;
+    obj->strtab[0] = '\0';
+    snprintf(obj->strtab + 1, strtab_size - 1, "lmnt:%s", name);
+    memcpy(obj->shstrtab, gdb_shstrtab, sizeof(gdb_shstrtab));
+
+    Elf64_Ehdr* hdr = &obj->hdr;
+    memcpy(hdr->e_ident, ELFMAG, SELFMAG);
+    hdr->e_ident[EI_CLASS] = ELFCLASS64;
+    hdr->e_ident[EI_DATA] = ELFDATA2LSB;
+    hdr->e_ident[EI_VERSION] = EV_CURRENT;
+    hdr->e_ident[EI_OSABI] = ELFOSABI_SYSV;
+    hdr->e_type = ET_REL;
+    hdr->e_machine = EM_X86_64;
+    hdr->e_version = EV_CURRENT;
+    hdr->e_shoff = offsetof(gdb_symfile, sect);
+    hdr->e_ehsize = sizeof(Elf64_Ehdr);
+    hdr->e_shentsize = sizeof(Elf64_Shdr);
+    hdr->e_shnum = GDB_SECT_COUNT;
+    hdr->e_shstrndx = GDB_SECT_SHSTRTAB;
+
+    // the code itself isn't in the file, just its location
+    Elf64_Shdr* text = &obj->sect[GDB_SECT_TEXT];
+    text->sh_name = GDB_SHSTR_TEXT;
+    text->sh_type = SHT_NOBITS;
+    text->sh_flags = SHF_ALLOC | SHF_EXECINSTR;
+    text->sh_addr = (Elf64_Addr)(uintptr_t)start;
+    text->sh_size = size;
+    text->sh_addralign = 1;
+
+    Elf64_Shdr* symtab = &obj->sect[GDB_SECT_SYMTAB];
+    symtab->sh_name = GDB_SHSTR_SYMTAB;
+    symtab->sh_type = SHT_SYMTAB;
+    symtab->sh_offset = offsetof(gdb_symfile, sym);
+    symtab->sh_size = sizeof(obj->sym);
+    symtab->sh_link = GDB_SECT_STRTAB;
+    // index of the first non-local symbol
+    symtab->sh_info = 1;
+    symtab->sh_addralign = sizeof(Elf64_Addr);
+    symtab->sh_entsize = sizeof(Elf64_Sym);
+
+    Elf64_Shdr* strtab = &obj->sect[GDB_SECT_STRTAB];
+    strtab->sh_name = GDB_SHSTR_STRTAB;
+    strtab->sh_type = SHT_STRTAB;
+    strtab->sh_offset = offsetof(gdb_symfile, strtab);
+    strtab->sh_size = strtab_size;
+    strtab->sh_addralign = 1;
+
+    Elf64_Shdr* shstrtab = &obj->sect[GDB_SECT_SHSTRTAB];
+    shstrtab->sh_name = GDB_SHSTR_SHSTRTAB;
+    shstrtab->sh_type = SHT_STRTAB;
+    shstrtab->sh_offset = offsetof(gdb_symfile, shstrtab);
+    shstrtab->sh_size = sizeof(gdb_shstrtab);
+    shstrtab->sh_addralign = 1;
+
+    // sym[0] is the mandatory null symbol, sym[1] is the function at the start of .text
+    Elf64_Sym* sym = &obj->sym[1];
+    sym->st_name = 1;
+    sym->st_info = ELF64_ST_INFO(STB_GLOBAL, STT_FUNC);
+    sym->st_shndx = GDB_SECT_TEXT;
+    sym->st_value = 0;
+    sym->st_size = size;
+
+    e->entry.symfile_addr = (const char*)obj;
+    e->entry.symfile_size = sizeof(gdb_symfile) + strtab_size;
+    return e;
+}
+
+static void gdb_register(gdb_entry* e)
+{
+    hostMutexLock(&debug_lock);
+    e->entry.prev_entry = NULL;
+    e->entry.next_entry = __jit_debug_descriptor.first_entry;
+    if (e->entry.next_entry)
+        e->entry.next_entry->prev_entry = &e->entry;
+    __jit_debug_descriptor.first_entry = &e->entry;
+    __jit_debug_descriptor.relevant_entry = &e->entry;
+    __jit_debug_descriptor.action_flag = JIT_REGISTER_FN;
+    __jit_debug_register_code();
+    hostMutexUnlock(&debug_lock);
+}
+
+static void gdb_unregister(gdb_entry* e)
+{
+    hostMutexLock(&debug_lock);
+    if (e->entry.prev_entry)
+        e->entry.prev_entry->next_entry = e->entry.next_entry;
+    else
+        __jit_debug_descriptor.first_entry = e->entry.next_entry;
+    if (e->entry.next_entry)
+        e->entry.next_entry->prev_entry = e->entry.prev_entry;
+    __jit_debug_descriptor.relevant_entry = &e->entry;
+    __jit_debug_descriptor.action_flag = JIT_UNREGISTER_FN;
+    __jit_debug_register_code();
+    hostMutexUnlock(&debug_lock);
+}
+#endif
+
+
+void lmnt_jit_debug_register(const lmnt_ictx* ctx, const lmnt_def* def, lmnt_jit_fn_data* fndata)
+{
+    fndata->debug_entry = NULL;
+#if defined(LMNT_JIT_PERF_MAP) || defined(LMNT_JIT_GDB_INTERFACE)
+    const char* name = validated_get_string(&ctx->archive, def->name);
+#if defined(LMNT_JIT_PERF_MAP)
+    perf_map_write(fndata->buffer, fndata->codesize, name);
+#endif
+#if defined(LMNT_JIT_GDB_INTERFACE)
+    gdb_entry* e = gdb_create_entry(fndata->buffer, fndata->codesize, name);
+    // not being able to debug the function isn't worth failing the compile over
+    if (e) {
+        gdb_register(e);
+        fndata->debug_entry = e;
+    }
+#endif
+#else
+    (void)ctx;
+    (void)def;
+#endif
+}
+
+void lmnt_jit_debug_unregister(lmnt_jit_fn_data* fndata)
+{
+#if defined(LMNT_JIT_GDB_INTERFACE)
+    gdb_entry* e = (gdb_entry*)fndata->debug_entry;
+    if (e) {
+        gdb_unregister(e);
+        free(e);
+    }
+#endif
+    fndata->debug_entry = NULL;
+}
@@ -0,0 +1,18 @@
+#ifndef LMNT_JIT_JITDEBUG_H
+#define LMNT_JIT_JITDEBUG_H
+
+#include "lmnt/common.h"
+#include "lmnt/interpreter.h"
+#include "lmnt/jit.h"
+
+// Makes a newly-compiled function visible to external tools, using the def's name as its symbol
+// With LMNT_JIT_PERF_MAP, a line is added to /tmp/perf-<pid>.map for perf to symbolise samples with
+// With LMNT_JIT_GDB_INTERFACE, the function is registered with GDB's JIT interface for backtraces and breakpoints
+// Without either setting this does nothing
+void lmnt_jit_debug_register(const lmnt_ictx* ctx, const lmnt_def* def, lmnt_jit_fn_data* fndata);
+
+// Removes anything lmnt_jit_debug_register added for fndata, before its code is freed
+// perf map entries can't be removed, so perf will keep attributing samples in that range to the def
+void lmnt_jit_debug_unregister(lmnt_jit_fn_data* fndata);
+
+#endif
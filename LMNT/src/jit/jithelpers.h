@@ -154,6 +154,86 @@ static lmnt_loffset getNextBranchTarget(lmnt_loffset* targets, size_t tcount, lm
     return mint;
 }
 
+// Whether any branch jumps backwards, and so may repeat code
+static inline bool hasBackwardBranches(const lmnt_instruction* instructions, size_t in_count)
+{
+    for (size_t i = 0; i < in_count; ++i) {
+        if (LMNT_IS_BRANCH_OP(instructions[i].opcode) && LMNT_COMBINE_OFFSET(instructions[i].arg2, instructions[i].arg3) <= i)
+            return true;
+    }
+    return false;
+}
+
+// Whether the code at target may rely on comparison flags set before it was jumped to
+static inline bool targetReadsComparisonFlags(const lmnt_instruction* instructions, size_t in_count, lmnt_loffset target)
+{
+    for (size_t i = target; i < in_count; ++i) {
+        const lmnt_opcode op = lmnt_get_base_opcode(instructions[i].opcode);
+        if (op == LMNT_OP_CMP || op == LMNT_OP_CMPZ)
+            return false;
+        if ((op >= LMNT_OP_BRANCHCEQ && op <= LMNT_OP_ASSIGNCUN) || LMNT_IS_BRANCH_OP(op) || op == LMNT_OP_RETURN)
+            return true;
+    }
+    return false;
+}
+
+static inline bool stackRangesOverlap(lmnt_offset spos1, size_t scount1, lmnt_offset spos2, size_t scount2)
+{
+    return scount1 > 0 && scount2 > 0 && spos1 < spos2 + scount2 && spos2 < spos1 + scount1;
+}
+
+// Whether the stack entries [spos, spos + scount) are always overwritten before they're next read, from index onwards
+// Only straight-line code is followed: branches, extcalls and indirect stack accesses are assumed to read everything
+// Entries from live_end onwards are discarded when the function returns, so returning doesn't count as reading them
+static bool isStackRangeDead(const lmnt_instruction* instructions, size_t in_count, size_t index, lmnt_offset spos, size_t scount, lmnt_offset live_end)
+{
+    for (size_t i = index; i < in_count; ++i) {
+        const lmnt_instruction* in = &instructions[i];
+        const lmnt_opcode op = lmnt_get_base_opcode(in->opcode);
+        if (op == LMNT_OP_RETURN)
+            break;
+        if (LMNT_IS_BRANCH_OP(op) || op == LMNT_OP_EXTCALL || op == LMNT_OP_INDEXRIS || op == LMNT_OP_INDEXRIR)
+            return false;
+        if (stackRangesOverlap(in->arg1, getAccessSize(op, 1), spos, scount)
+            || stackRangesOverlap(in->arg2, getAccessSize(op, 2), spos, scount))
+            return false;
+        const size_t wsize = getAccessSize(op, 3);
+        if (wsize > 0 && in->arg3 <= spos && spos + scount <= in->arg3 + wsize)
+            return true;
+    }
+    return spos >= live_end;
+}
+
+// Whether the multiply at the current instruction can be combined with the add after it into a fused multiply-add
+// The add must consume the product, nothing else may read the product, and nothing may branch to the add
+// On success, addend is the add's other operand
+static inline bool canFuseMultiplyAdd(
+    jit_compile_state* state, lmnt_opcode addop, size_t scount,
+    lmnt_loffset next_target, lmnt_offset live_end, lmnt_offset* addend)
+{
+    const lmnt_loffset i = state->cur_in;
+    if (i + 1 >= state->in_count || i + 1 == next_target)
+        return false;
+    const lmnt_instruction* mul = &state->instructions[i];
+    const lmnt_instruction* add = &state->instructions[i + 1];
+    if (lmnt_get_base_opcode(add->opcode) != addop)
+        return false;
+    if (add->arg1 == mul->arg3)
+        *addend = add->arg2;
+    else if (add->arg2 == mul->arg3)
+        *addend = add->arg1;
+    else
+        return false;
+    if (stackRangesOverlap(*addend, scount, mul->arg3, scount))
+        return false;
+    // if the add overwrites the product, nobody else can see it
+    if (add->arg3 == mul->arg3)
+        return true;
+    if (stackRangesOverlap(add->arg3, scount, mul->arg3, scount))
+        return false;
+    return isStackRangeDead(state->instructions, state->in_count, i + 2, mul->arg3, scount, live_end);
+}
+
 
 // Target-specific implementations
 static bool allowIndividualLaneAccess(jit_compile_state* state);
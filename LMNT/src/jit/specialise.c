@@ -0,0 +1,330 @@
+#include "jit/specialise.h"
+
+#include <stdlib.h>
+
+#include "lmnt/opcodes.h"
+#include "helpers.h"
+#include "dispatch_jumptable.h"
+
+#include LMNT_MEMORY_HEADER
+
+typedef struct
+{
+    // a copy of the context whose stack is values, used to evaluate instructions with known inputs
+    lmnt_ictx scratch;
+    lmnt_value* values;
+    // whether each stack entry's value is known at the current instruction
+    bool* known;
+    // the entries known everywhere in the def: constants and fixed args which it never writes to
+    bool* invariant;
+    size_t count;
+    // whether the comparison flags in scratch are known at the current instruction
+    bool flags_known;
+} specialise_state;
+
+static size_t operand_size(lmnt_operand_type type)
+{
+    switch (type)
+    {
+    case LMNT_OPERAND_STACK1: return 1;
+    case LMNT_OPERAND_STACK4: return 4;
+    default: return 0;
+    }
+}
+
+static bool all_known(const specialise_state* state, size_t start, size_t count)
+{
+    for (size_t i = start; i < start + count; ++i) {
+        if (i >= state->count || !state->known[i])
+            return false;
+    }
+    return true;
+}
+
+static void set_known(specialise_state* state, size_t start, size_t count, bool known)
+{
+    for (size_t i = start; i < start + count && i < state->count; ++i)
+        state->known[i] = known;
+}
+
+static void reset_known(specialise_state* state)
+{
+    LMNT_MEMCPY(state->known, state->invariant, state->count * sizeof(bool));
+    state->flags_known = false;
+}
+
+// Gets the range of stack entries an instruction writes to, other than the second output of SINCOS
+// Returns false if the instruction could write anywhere
+static bool get_written(const lmnt_ictx* ctx, lmnt_instruction in, size_t* start, size_t* count)
+{
+    *start = in.arg3;
+    *count = 0;
+    switch (in.opcode)
+    {
+    case LMNT_OP_INDEXRIR:
+        return false;
+    case LMNT_OP_EXTCALL:
+    {
+        const lmnt_def* extdef = validated_get_def(&ctx->archive, LMNT_COMBINE_OFFSET(in.arg1, in.arg2));
+        *count = (size_t)extdef->args_count + extdef->rvals_count;
+        return true;
+    }
+    default:
+        *count = operand_size(lmnt_get_opcode_info(in.opcode)->operand3);
+        return true;
+    }
+}
+
+static lmnt_instruction make_instruction(lmnt_opcode opcode, lmnt_offset arg1, lmnt_offset arg2, lmnt_offset arg3)
+{
+    lmnt_instruction in = { opcode, arg1, arg2, arg3 };
+    return in;
+}
+
+// Replaces in with an immediate assignment of the known value(s) it wrote, if there is one which can do it
+static void make_immediate(const specialise_state* state, size_t start, size_t count, lmnt_instruction* in)
+{
+    lmnt_loffset bits[4];
+    LMNT_MEMCPY(bits, &state->values[start], count * sizeof(lmnt_value));
+    const lmnt_offset lo = (lmnt_offset)(bits[0] & 0xFFFF);
+    const lmnt_offset hi = (lmnt_offset)(bits[0] >> 16);
+    if (count == 1)
+        *in = make_instruction(LMNT_OP_ASSIGNIBS, lo, hi, (lmnt_offset)start);
+    else if (count == 4 && bits[0] == bits[1] && bits[0] == bits[2] && bits[0] == bits[3])
+        *in = make_instruction(LMNT_OP_ASSIGNIBV, lo, hi, (lmnt_offset)start);
+}
+
+// Simplifies a single instruction given what's known beforehand, and updates what's known afterwards
+static void specialise_instruction(specialise_state* state, lmnt_instruction* in)
+{
+    const lmnt_op_info* info = lmnt_get_opcode_info(in->opcode);
+    switch (in->opcode)
+    {
+    case LMNT_OP_NOOP:
+    case LMNT_OP_RETURN:
+    case LMNT_OP_BRANCH:
+        return;
+    case LMNT_OP_CMP:
+    case LMNT_OP_CMPZ:
+        state->flags_known = all_known(state, in->arg1, 1)
+            && (in->opcode == LMNT_OP_CMPZ || all_known(state, in->arg2, 1));
+        if (state->flags_known)
+            lmnt_op_functions[in->opcode](&state->scratch, in->arg1, in->arg2, in->arg3);
+        return;
+    case LMNT_OP_BRANCHZ:
+    case LMNT_OP_BRANCHNZ:
+    case LMNT_OP_BRANCHPOS:
+    case LMNT_OP_BRANCHNEG:
+    case LMNT_OP_BRANCHUN:
+        if (all_known(state, in->arg1, 1)) {
+            const bool taken = lmnt_op_functions[in->opcode](&state->scratch, in->arg1, in->arg2, in->arg3) == LMNT_BRANCHING;
+            *in = taken ? make_instruction(LMNT_OP_BRANCH, 0, in->arg2, in->arg3) : make_instruction(LMNT_OP_NOOP, 0, 0, 0);
+        }
+        return;
+    case LMNT_OP_BRANCHCEQ:
+    case LMNT_OP_BRANCHCNE:
+    case LMNT_OP_BRANCHCLT:
+    case LMNT_OP_BRANCHCLE:
+    case LMNT_OP_BRANCHCGT:
+    case LMNT_OP_BRANCHCGE:
+    case LMNT_OP_BRANCHCUN:
+        if (state->flags_known) {
+            const bool taken = lmnt_op_functions[in->opcode](&state->scratch, in->arg1, in->arg2, in->arg3) == LMNT_BRANCHING;
+            *in = taken ? make_instruction(LMNT_OP_BRANCH, 0, in->arg2, in->arg3) : make_instruction(LMNT_OP_NOOP, 0, 0, 0);
+        }
+        return;
+    case LMNT_OP_ASSIGNCEQ:
+    case LMNT_OP_ASSIGNCNE:
+    case LMNT_OP_ASSIGNCLT:
+    case LMNT_OP_ASSIGNCLE:
+    case LMNT_OP_ASSIGNCGT:
+    case LMNT_OP_ASSIGNCGE:
+    case LMNT_OP_ASSIGNCUN:
+        if (state->flags_known) {
+            // the conditional assignments test the same conditions as the conditional branches, in the same order
+            const lmnt_opcode branch_op = (lmnt_opcode)(LMNT_OP_BRANCHCEQ + (in->opcode - LMNT_OP_ASSIGNCEQ));
+            const bool first = lmnt_op_functions[branch_op](&state->scratch, 0, 0, 0) == LMNT_BRANCHING;
+            *in = make_instruction(LMNT_OP_ASSIGNSS, first ? in->arg1 : in->arg2, 0, in->arg3);
+            specialise_instruction(state, in);
+        } else {
+            set_known(state, in->arg3, 1, false);
+        }
+        return;
+    case LMNT_OP_INDEXRIS:
+        set_known(state, in->arg3, 1, false);
+        return;
+    case LMNT_OP_INDEXRIR:
+        // this could write anywhere, so all we know afterwards is what never changes
+        LMNT_MEMCPY(state->known, state->invariant, state->count * sizeof(bool));
+        return;
+    case LMNT_OP_EXTCALL:
+    {
+        size_t start, count;
+        get_written(&state->scratch, *in, &start, &count);
+        set_known(state, start, count, false);
+        state->flags_known = false;
+        return;
+    }
+    default:
+        break;
+    }
+
+    // everything else is a pure function of its stack inputs (or of the archive's data) with one output
+    const size_t in1 = operand_size(info->operand1);
+    const size_t in2 = (in->opcode == LMNT_OP_SINCOS) ? 0 : operand_size(info->operand2);
+    const size_t out = operand_size(info->operand3);
+    const bool known = all_known(state, in->arg1, in1) && all_known(state, in->arg2, in2)
+        && lmnt_op_functions[in->opcode](&state->scratch, in->arg1, in->arg2, in->arg3) == LMNT_OK;
+
+    if (in->opcode == LMNT_OP_SINCOS) {
+        // SINCOS has two outputs, so it can't become a single assignment, but later instructions can still use them
+        set_known(state, in->arg2, 1, known);
+        set_known(state, in->arg3, 1, known);
+        return;
+    }
+
+    set_known(state, in->arg3, out, known);
+    if (known && in->opcode != LMNT_OP_ASSIGNIBS && in->opcode != LMNT_OP_ASSIGNIBV)
+        make_immediate(state, in->arg3, out, in);
+}
+
+lmnt_result lmnt_jit_specialise(
+    lmnt_ictx* ctx, const lmnt_def* def,
+    const bool* const_mask, const lmnt_value* const_values, lmnt_offset values_count,
+    lmnt_jit_specialised_code* code)
+{
+    assert(ctx && def && code);
+    if (def->flags & LMNT_DEFFLAG_EXTERN)
+        return LMNT_ERROR_INVALID_ARCHIVE;
+
+    const lmnt_code* defcode;
+    const lmnt_instruction* instructions;
+    LMNT_OK_OR_RETURN(lmnt_validate_def(ctx, def, NULL));
+    LMNT_OK_OR_RETURN(lmnt_archive_get_code(&ctx->archive, def->code, &defcode));
+    LMNT_OK_OR_RETURN(lmnt_archive_get_code_instructions(&ctx->archive, def->code, &instructions));
+    const lmnt_loffset icount = defcode->instructions_count;
+
+    // work out which args are being fixed, and make sure we have values for all of them
+    const lmnt_offset consts_count = validated_get_constants_count(&ctx->archive);
+    lmnt_loffset prefix_count = 0;
+    for (lmnt_offset i = 0; i < def->args_count; ++i) {
+        if (const_mask && !const_mask[i])
+            continue;
+        if (i >= values_count) {
+            if (const_mask)
+                return LMNT_ERROR_ARGS_MISMATCH;
+            break;
+        }
+        ++prefix_count;
+    }
+
+    specialise_state state;
+    memset(&state, 0, sizeof(specialise_state));
+    state.count = (size_t)consts_count + def->stack_count;
+    state.values = (lmnt_value*)calloc(state.count, sizeof(lmnt_value));
+    state.known = (bool*)calloc(state.count, sizeof(bool));
+    state.invariant = (bool*)calloc(state.count, sizeof(bool));
+    code->instructions = (lmnt_instruction*)malloc(((size_t)prefix_count + icount) * sizeof(lmnt_instruction));
+    code->instructions_count = prefix_count + icount;
+    lmnt_result result = LMNT_OK;
+    if (!state.values || !state.known || !state.invariant || !code->instructions) {
+        result = LMNT_ERROR_MEMORY_SIZE;
+        goto cleanup;
+    }
+
+    state.scratch = *ctx;
+    state.scratch.stack = state.values;
+    state.scratch.writable_stack = state.values + consts_count;
+    state.scratch.stack_count = state.count;
+    state.scratch.cur_def = def;
+    state.scratch.cur_stack_count = state.count;
+    state.scratch.status_flags = 0;
+
+    // constants are known up front (unless they can be changed by other defs), as are the fixed args
+    // since the code starts by writing them
+    LMNT_MEMCPY(state.values, ctx->stack, consts_count * sizeof(lmnt_value));
+#if !defined(LMNT_ALLOW_MODIFYING_STACK_CONSTANTS)
+    for (size_t i = 0; i < consts_count; ++i)
+        state.invariant[i] = true;
+#endif
+
+    lmnt_loffset cur = 0;
+    for (lmnt_offset i = 0; i < def->args_count && cur < prefix_count; ++i) {
+        if (const_mask && !const_mask[i])
+            continue;
+        const size_t slot = (size_t)consts_count + i;
+        lmnt_loffset bits;
+        LMNT_MEMCPY(&bits, &const_values[i], sizeof(lmnt_value));
+        code->instructions[cur++] = make_instruction(LMNT_OP_ASSIGNIBS, (lmnt_offset)(bits & 0xFFFF), (lmnt_offset)(bits >> 16), (lmnt_offset)slot);
+        state.values[slot] = const_values[i];
+        state.invariant[slot] = true;
+    }
+
+    // anything the def writes to can only be relied upon between branch targets
+    for (lmnt_loffset i = 0; i < icount; ++i) {
+        lmnt_instruction in = instructions[i];
+        in.opcode = lmnt_get_base_opcode(in.opcode);
+        size_t start, count;
+        if (!get_written(ctx, in, &start, &count)) {
+            // the def can write anywhere on its stack, so nothing is safe to rely on
+            memset(state.invariant, 0, state.count * sizeof(bool));
+            break;
+        }
+        for (size_t j = start; j < start + count && j < state.count; ++j)
+            state.invariant[j] = false;
+        if (in.opcode == LMNT_OP_SINCOS && in.arg2 < state.count)
+            state.invariant[in.arg2] = false;
+    }
+
+    // mark branch targets so that knowledge from before them isn't used afterwards
+    bool* is_target = (bool*)calloc((size_t)icount + 1, sizeof(bool));
+    if (!is_target) {
+        result = LMNT_ERROR_MEMORY_SIZE;
+        goto cleanup;
+    }
+    for (lmnt_loffset i = 0; i < icount; ++i) {
+        const lmnt_instruction in = instructions[i];
+        if (LMNT_IS_BRANCH_OP(in.opcode)) {
+            const lmnt_loffset target = LMNT_COMBINE_OFFSET(in.arg2, in.arg3);
+            if (target <= icount)
+                is_target[target] = true;
+        }
+    }
+
+    // the prefix writes the fixed args, so they're known at the start even if the def later changes them
+    reset_known(&state);
+    for (lmnt_loffset i = 0; i < prefix_count; ++i)
+        state.known[code->instructions[i].arg3] = true;
+
+    for (lmnt_loffset i = 0; i < icount; ++i) {
+        if (is_target[i])
+            reset_known(&state);
+
+        lmnt_instruction in = instructions[i];
+        in.opcode = lmnt_get_base_opcode(in.opcode);
+        specialise_instruction(&state, &in);
+
+        if (LMNT_IS_BRANCH_OP(in.opcode)) {
+            const lmnt_loffset target = LMNT_COMBINE_OFFSET(in.arg2, in.arg3) + prefix_count;
+            in.arg2 = (lmnt_offset)(target & 0xFFFF);
+            in.arg3 = (lmnt_offset)(target >> 16);
+        }
+        code->instructions[prefix_count + i] = in;
+    }
+    free(is_target);
+
+cleanup:
+    free(state.values);
+    free(state.known);
+    free(state.invariant);
+    if (result != LMNT_OK)
+        lmnt_jit_specialised_code_free(code);
+    return result;
+}
+
+void lmnt_jit_specialised_code_free(lmnt_jit_specialised_code* code)
+{
+    free(code->instructions);
+    code->instructions = NULL;
+    code->instructions_count = 0;
+}
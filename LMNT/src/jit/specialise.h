@@ -0,0 +1,30 @@
+#ifndef LMNT_JIT_SPECIALISE_H
+#define LMNT_JIT_SPECIALISE_H
+
+#include <stdbool.h>
+#include "lmnt/common.h"
+#include "lmnt/interpreter.h"
+
+// A copy of a def's code rewritten for a fixed set of argument values
+typedef struct
+{
+    lmnt_instruction* instructions;
+    lmnt_loffset instructions_count;
+} lmnt_jit_specialised_code;
+
+// Rewrites def's code as if the arguments selected by const_mask always had the values in const_values
+// const_values holds values_count values for the first arguments, and a NULL const_mask selects all of them
+// The result starts by assigning the fixed arguments, then follows the original code with branch targets adjusted
+// Any instruction whose inputs are all known is replaced by an immediate assignment of its result,
+// conditional branches with a known outcome become unconditional branches or no-ops,
+// and superinstructions are split back into their individual instructions
+// The stack contents after each instruction are the same as the original code would have produced,
+// so the result can be compiled by any JIT target without further changes
+lmnt_result lmnt_jit_specialise(
+    lmnt_ictx* ctx, const lmnt_def* def,
+    const bool* const_mask, const lmnt_value* const_values, lmnt_offset values_count,
+    lmnt_jit_specialised_code* code);
+
+void lmnt_jit_specialised_code_free(lmnt_jit_specialised_code* code);
+
+#endif
@@ -135,6 +135,18 @@ static cpu_flags get_x86_cpu_flags()
     return flags;
 }
 
+// The most capable instruction set the JIT can use given the CPU's flags
+static inline lmnt_jit_isa get_x86_jit_isa(cpu_flags flags)
+{
+    if ((flags & SIMD_X86_AVX1) && (flags & SIMD_X86_AVX2FMA3))
+        return LMNT_JIT_ISA_X86_64_AVX_FMA3;
+    if (flags & SIMD_X86_AVX1)
+        return LMNT_JIT_ISA_X86_64_AVX;
+    if (flags & SIMD_X86_SSE41)
+        return LMNT_JIT_ISA_X86_64_SSE41;
+    return LMNT_JIT_ISA_X86_64_SSE2;
+}
+
 static inline void print_x86_cpu_flags(cpu_flags flags)
 {
     JIT_DEBUG_PRINTF("x86 CPU extensions: ");
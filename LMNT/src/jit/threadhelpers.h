@@ -0,0 +1,130 @@
+#ifndef LMNT_JIT_THREADHELPERS_H
+#define LMNT_JIT_THREADHELPERS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+//
+// Minimal threading primitives used to compile functions in the background
+//
+#if _WIN32
+#include <Windows.h>
+
+typedef SRWLOCK host_mutex;
+typedef CONDITION_VARIABLE host_cond;
+typedef HANDLE host_thread;
+typedef volatile LONG host_atomic32;
+
+#define HOST_MUTEX_INITIALIZER SRWLOCK_INIT
+
+static inline void hostMutexInit(host_mutex* m) { InitializeSRWLock(m); }
+static inline void hostMutexDestroy(host_mutex* m) { (void)m; }
+static inline void hostMutexLock(host_mutex* m) { AcquireSRWLockExclusive(m); }
+static inline void hostMutexUnlock(host_mutex* m) { ReleaseSRWLockExclusive(m); }
+
+static inline void hostCondInit(host_cond* c) { InitializeConditionVariable(c); }
+static inline void hostCondDestroy(host_cond* c) { (void)c; }
+static inline void hostCondWait(host_cond* c, host_mutex* m) { SleepConditionVariableSRW(c, m, INFINITE, 0); }
+static inline void hostCondBroadcast(host_cond* c) { WakeAllConditionVariable(c); }
+
+typedef struct
+{
+    void (*fn)(void*);
+    void* arg;
+} host_thread_start;
+
+static DWORD WINAPI hostThreadEntry(LPVOID param)
+{
+    host_thread_start start = *(host_thread_start*)param;
+    free(param);
+    start.fn(start.arg);
+    return 0;
+}
+
+static inline bool hostThreadCreate(host_thread* t, void (*fn)(void*), void* arg)
+{
+    host_thread_start* start = (host_thread_start*)malloc(sizeof(host_thread_start));
+    if (!start)
+        return false;
+    start->fn = fn;
+    start->arg = arg;
+    *t = CreateThread(NULL, 0, hostThreadEntry, start, 0, NULL);
+    if (!*t)
+        free(start);
+    return *t != NULL;
+}
+
+static inline void hostThreadJoin(host_thread t)
+{
+    WaitForSingleObject(t, INFINITE);
+    CloseHandle(t);
+}
+
+static inline uint32_t hostAtomicLoad32(host_atomic32* a) { return (uint32_t)InterlockedCompareExchange(a, 0, 0); }
+static inline void hostAtomicStore32(host_atomic32* a, uint32_t v) { InterlockedExchange(a, (LONG)v); }
+static inline uint32_t hostAtomicIncrement32(host_atomic32* a) { return (uint32_t)InterlockedIncrement(a); }
+static inline bool hostAtomicCompareExchange32(host_atomic32* a, uint32_t expected, uint32_t desired)
+{
+    return InterlockedCompareExchange(a, (LONG)desired, (LONG)expected) == (LONG)expected;
+}
+#else
+#include <pthread.h>
+
+typedef pthread_mutex_t host_mutex;
+typedef pthread_cond_t host_cond;
+typedef pthread_t host_thread;
+typedef uint32_t host_atomic32;
+
+#define HOST_MUTEX_INITIALIZER PTHREAD_MUTEX_INITIALIZER
+
+static inline void hostMutexInit(host_mutex* m) { pthread_mutex_init(m, NULL); }
+static inline void hostMutexDestroy(host_mutex* m) { pthread_mutex_destroy(m); }
+static inline void hostMutexLock(host_mutex* m) { pthread_mutex_lock(m); }
+static inline void hostMutexUnlock(host_mutex* m) { pthread_mutex_unlock(m); }
+
+static inline void hostCondInit(host_cond* c) { pthread_cond_init(c, NULL); }
+static inline void hostCondDestroy(host_cond* c) { pthread_cond_destroy(c); }
+static inline void hostCondWait(host_cond* c, host_mutex* m) { pthread_cond_wait(c, m); }
+static inline void hostCondBroadcast(host_cond* c) { pthread_cond_broadcast(c); }
+
+typedef struct
+{
+    void (*fn)(void*);
+    void* arg;
+} host_thread_start;
+
+static void* hostThreadEntry(void* param)
+{
+    host_thread_start start = *(host_thread_start*)param;
+    free(param);
+    start.fn(start.arg);
+    return NULL;
+}
+
+static inline bool hostThreadCreate(host_thread* t, void (*fn)(void*), void* arg)
+{
+    host_thread_start* start = (host_thread_start*)malloc(sizeof(host_thread_start));
+    if (!start)
+        return false;
+    start->fn = fn;
+    start->arg = arg;
+    if (pthread_create(t, NULL, hostThreadEntry, start) != 0) {
+        free(start);
+        return false;
+    }
+    return true;
+}
+
+static inline void hostThreadJoin(host_thread t) { pthread_join(t, NULL); }
+
+static inline uint32_t hostAtomicLoad32(host_atomic32* a) { return __atomic_load_n(a, __ATOMIC_ACQUIRE); }
+static inline void hostAtomicStore32(host_atomic32* a, uint32_t v) { __atomic_store_n(a, v, __ATOMIC_RELEASE); }
+static inline uint32_t hostAtomicIncrement32(host_atomic32* a) { return __atomic_add_fetch(a, 1, __ATOMIC_RELAXED); }
+static inline bool hostAtomicCompareExchange32(host_atomic32* a, uint32_t expected, uint32_t desired)
+{
+    return __atomic_compare_exchange_n(a, &expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+#endif
+
+#endif
@@ -0,0 +1,222 @@
+#include "lmnt/tier.h"
+#include "lmnt/common.h"
+#include "lmnt/interpreter.h"
+#include "lmnt/jit.h"
+#include "lmnt/validation.h"
+#include "jit/threadhelpers.h"
+#include "helpers.h"
+
+#include <stdlib.h>
+#include LMNT_MEMORY_HEADER
+
+enum
+{
+    TIER_DEF_INTERPRETED = 0,
+    TIER_DEF_QUEUED,
+    TIER_DEF_COMPILED,
+    TIER_DEF_FAILED,
+};
+
+typedef struct
+{
+    host_atomic32 state;
+    host_atomic32 executions;
+    // only written by the compile thread, before it sets state to TIER_DEF_COMPILED
+    lmnt_jit_fn_data fndata;
+} tier_def;
+
+struct lmnt_tier
+{
+    // private copy of the context the tier was created from, only used by the compile thread
+    lmnt_ictx ctx;
+    lmnt_jit_target target;
+    uint32_t threshold;
+    tier_def* defs;
+    size_t defs_count;
+
+    // everything below is protected by lock
+    host_mutex lock;
+    host_cond cond;
+    host_thread thread;
+    // ring buffer of def indices waiting to be compiled
+    // each def is only ever queued once, so there's always room for all of them
+    size_t* queue;
+    size_t queue_start;
+    size_t queue_count;
+    bool compiling;
+    bool stopping;
+};
+
+
+static bool get_def_index(const lmnt_tier* tier, const lmnt_ictx* ctx, const lmnt_def* def, size_t* index)
+{
+    const char* defs = get_defs_segment(&ctx->archive);
+    if ((const char*)def < defs)
+        return false;
+    const size_t offset = (size_t)((const char*)def - defs);
+    *index = offset / sizeof(lmnt_def);
+    return (offset % sizeof(lmnt_def)) == 0 && *index < tier->defs_count;
+}
+
+static void tier_enqueue(lmnt_tier* tier, size_t index)
+{
+    // if someone else got here first, it's already queued
+    if (!hostAtomicCompareExchange32(&tier->defs[index].state, TIER_DEF_INTERPRETED, TIER_DEF_QUEUED))
+        return;
+
+    hostMutexLock(&tier->lock);
+    tier->queue[(tier->queue_start + tier->queue_count) % tier->defs_count] = index;
+    ++tier->queue_count;
+    hostCondBroadcast(&tier->cond);
+    hostMutexUnlock(&tier->lock);
+}
+
+static void tier_compile_thread(void* arg)
+{
+    lmnt_tier* tier = (lmnt_tier*)arg;
+
+    hostMutexLock(&tier->lock);
+    for (;;) {
+        while (!tier->stopping && tier->queue_count == 0)
+            hostCondWait(&tier->cond, &tier->lock);
+        if (tier->stopping)
+            break;
+
+        const size_t index = tier->queue[tier->queue_start];
+        tier->queue_start = (tier->queue_start + 1) % tier->defs_count;
+        --tier->queue_count;
+        tier->compiling = true;
+        hostMutexUnlock(&tier->lock);
+
+        tier_def* tdef = &tier->defs[index];
+        const lmnt_def* def = validated_get_def(&tier->ctx.archive, (lmnt_loffset)(index * sizeof(lmnt_def)));
+        const lmnt_result result = lmnt_jit_compile(&tier->ctx, def, tier->target, &tdef->fndata);
+        // this publishes the compiled function to any executing threads
+        hostAtomicStore32(&tdef->state, (result == LMNT_OK) ? TIER_DEF_COMPILED : TIER_DEF_FAILED);
+
+        hostMutexLock(&tier->lock);
+        tier->compiling = false;
+        hostCondBroadcast(&tier->cond);
+    }
+    hostMutexUnlock(&tier->lock);
+}
+
+lmnt_result lmnt_tier_create(const lmnt_ictx* ctx, lmnt_jit_target target, uint32_t threshold, lmnt_tier** tier)
+{
+    if (!ctx || !tier)
+        return LMNT_ERROR_INVALID_PTR;
+    LMNT_ENSURE_VALIDATED(&ctx->archive);
+
+    lmnt_tier* t = (lmnt_tier*)calloc(1, sizeof(lmnt_tier));
+    if (!t)
+        return LMNT_ERROR_MEMORY_SIZE;
+    t->target = target;
+    t->threshold = threshold;
+
+    // copy the whole memory area so the archive and stack pointers can be moved across as-is
+    // an in-place archive lives outside the memory area and is never written to, so it can be shared
+    char* mem = (char*)malloc(ctx->memory_area_size);
+    t->defs_count = get_header(&ctx->archive)->defs_length / sizeof(lmnt_def);
+    t->defs = (tier_def*)calloc(t->defs_count ? t->defs_count : 1, sizeof(tier_def));
+    t->queue = (size_t*)calloc(t->defs_count ? t->defs_count : 1, sizeof(size_t));
+    if (!mem || !t->defs || !t->queue) {
+        free(mem);
+        free(t->defs);
+        free(t->queue);
+        free(t);
+        return LMNT_ERROR_MEMORY_SIZE;
+    }
+    LMNT_MEMCPY(mem, ctx->memory_area, ctx->memory_area_size);
+    t->ctx = *ctx;
+    t->ctx.memory_area = mem;
+    if (!(ctx->archive.flags & LMNT_ARCHIVE_INPLACE))
+        t->ctx.archive.data = mem + (ctx->archive.data - ctx->memory_area);
+    t->ctx.stack = (lmnt_value*)(mem + ((char*)ctx->stack - ctx->memory_area));
+    t->ctx.writable_stack = (lmnt_value*)(mem + ((char*)ctx->writable_stack - ctx->memory_area));
+    t->ctx.cur_def = NULL;
+    t->ctx.threaded_code = NULL;
+
+    // interfaces have nothing to compile and externs are just as fast either way
+    for (size_t i = 0; i < t->defs_count; ++i) {
+        const lmnt_def* def = validated_get_def(&t->ctx.archive, (lmnt_loffset)(i * sizeof(lmnt_def)));
+        if (def->flags & (LMNT_DEFFLAG_INTERFACE | LMNT_DEFFLAG_EXTERN))
+            t->defs[i].state = TIER_DEF_FAILED;
+    }
+
+    hostMutexInit(&t->lock);
+    hostCondInit(&t->cond);
+    if (!hostThreadCreate(&t->thread, tier_compile_thread, t)) {
+        hostCondDestroy(&t->cond);
+        hostMutexDestroy(&t->lock);
+        free(mem);
+        free(t->defs);
+        free(t->queue);
+        free(t);
+        return LMNT_ERROR_INTERNAL;
+    }
+
+    *tier = t;
+    return LMNT_OK;
+}
+
+void lmnt_tier_delete(lmnt_tier* tier)
+{
+    if (!tier)
+        return;
+
+    hostMutexLock(&tier->lock);
+    tier->stopping = true;
+    hostCondBroadcast(&tier->cond);
+    hostMutexUnlock(&tier->lock);
+    hostThreadJoin(tier->thread);
+
+    for (size_t i = 0; i < tier->defs_count; ++i) {
+        if (hostAtomicLoad32(&tier->defs[i].state) == TIER_DEF_COMPILED)
+            lmnt_jit_delete_function(&tier->defs[i].fndata);
+    }
+
+    hostCondDestroy(&tier->cond);
+    hostMutexDestroy(&tier->lock);
+    free(tier->ctx.memory_area);
+    free(tier->defs);
+    free(tier->queue);
+    free(tier);
+}
+
+LMNT_ATTR_FAST lmnt_result lmnt_tier_execute(
+    lmnt_tier* tier, lmnt_ictx* ctx, const lmnt_def* def,
+    lmnt_value* rvals, const lmnt_offset rvals_count)
+{
+    size_t index;
+    if (LMNT_UNLIKELY(!get_def_index(tier, ctx, def, &index)))
+        return LMNT_ERROR_DEF_MISMATCH;
+
+    tier_def* tdef = &tier->defs[index];
+    const uint32_t state = hostAtomicLoad32(&tdef->state);
+    if (LMNT_LIKELY(state == TIER_DEF_COMPILED)) {
+        // the function was compiled from the tier's copy of the archive, so give it the caller's def instead
+        lmnt_jit_fn_data fndata = tdef->fndata;
+        fndata.def = def;
+        return lmnt_jit_execute(ctx, &fndata, rvals, rvals_count);
+    }
+
+    if (state == TIER_DEF_INTERPRETED && hostAtomicIncrement32(&tdef->executions) >= tier->threshold)
+        tier_enqueue(tier, index);
+    return lmnt_execute(ctx, def, rvals, rvals_count);
+}
+
+void lmnt_tier_flush(lmnt_tier* tier)
+{
+    hostMutexLock(&tier->lock);
+    while (tier->queue_count > 0 || tier->compiling)
+        hostCondWait(&tier->cond, &tier->lock);
+    hostMutexUnlock(&tier->lock);
+}
+
+bool lmnt_tier_is_compiled(lmnt_tier* tier, const lmnt_ictx* ctx, const lmnt_def* def)
+{
+    size_t index;
+    if (!get_def_index(tier, ctx, def, &index))
+        return false;
+    return hostAtomicLoad32(&tier->defs[index].state) == TIER_DEF_COMPILED;
+}
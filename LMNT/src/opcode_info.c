@@ -83,9 +83,59 @@ const lmnt_op_info lmnt_opcode_info[LMNT_OP_END] = {
     { "ASSIGNCGE", LMNT_OPERAND_STACK1,   LMNT_OPERAND_STACK1,   LMNT_OPERAND_STACK1   },
     { "ASSIGNCUN", LMNT_OPERAND_STACK1,   LMNT_OPERAND_STACK1,   LMNT_OPERAND_STACK1   },
     { "EXTCALL",   LMNT_OPERAND_DEFPTR,   LMNT_OPERAND_DEFPTR,   LMNT_OPERAND_STACKN   },
+    { "FMASS",     LMNT_OPERAND_STACK1,   LMNT_OPERAND_STACK1,   LMNT_OPERAND_STACK1   },
+    { "CMPBRCEQ",  LMNT_OPERAND_STACK1,   LMNT_OPERAND_STACK1,   LMNT_OPERAND_UNUSED   },
+    { "CMPBRCNE",  LMNT_OPERAND_STACK1,   LMNT_OPERAND_STACK1,   LMNT_OPERAND_UNUSED   },
+    { "CMPBRCLT",  LMNT_OPERAND_STACK1,   LMNT_OPERAND_STACK1,   LMNT_OPERAND_UNUSED   },
+    { "CMPBRCLE",  LMNT_OPERAND_STACK1,   LMNT_OPERAND_STACK1,   LMNT_OPERAND_UNUSED   },
+    { "CMPBRCGT",  LMNT_OPERAND_STACK1,   LMNT_OPERAND_STACK1,   LMNT_OPERAND_UNUSED   },
+    { "CMPBRCGE",  LMNT_OPERAND_STACK1,   LMNT_OPERAND_STACK1,   LMNT_OPERAND_UNUSED   },
+    { "CMPBRCUN",  LMNT_OPERAND_STACK1,   LMNT_OPERAND_STACK1,   LMNT_OPERAND_UNUSED   },
+    { "ASSIGN4SS", LMNT_OPERAND_STACK1,   LMNT_OPERAND_UNUSED,   LMNT_OPERAND_STACK1   },
 };
 
 const lmnt_op_info* lmnt_get_opcode_info(lmnt_opcode op)
 {
     return LMNT_LIKELY(op < LMNT_OP_END) ? &(lmnt_opcode_info[op]) : NULL;
-}
\ No newline at end of file
+}
+lmnt_opcode lmnt_get_base_opcode(lmnt_opcode op)
+{
+    switch (op)
+    {
+    case LMNT_OP_FMASS:
+        return LMNT_OP_MULSS;
+    case LMNT_OP_CMPBRCEQ:
+    case LMNT_OP_CMPBRCNE:
+    case LMNT_OP_CMPBRCLT:
+    case LMNT_OP_CMPBRCLE:
+    case LMNT_OP_CMPBRCGT:
+    case LMNT_OP_CMPBRCGE:
+    case LMNT_OP_CMPBRCUN:
+        return LMNT_OP_CMP;
+    case LMNT_OP_ASSIGN4SS:
+        return LMNT_OP_ASSIGNSS;
+    default:
+        return op;
+    }
+}
+
+size_t lmnt_get_fused_length(lmnt_opcode op)
+{
+    switch (op)
+    {
+    case LMNT_OP_FMASS:
+        return 2;
+    case LMNT_OP_CMPBRCEQ:
+    case LMNT_OP_CMPBRCNE:
+    case LMNT_OP_CMPBRCLT:
+    case LMNT_OP_CMPBRCLE:
+    case LMNT_OP_CMPBRCGT:
+    case LMNT_OP_CMPBRCGE:
+    case LMNT_OP_CMPBRCUN:
+        return 2;
+    case LMNT_OP_ASSIGN4SS:
+        return 4;
+    default:
+        return 1;
+    }
+}
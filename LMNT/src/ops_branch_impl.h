@@ -5,6 +5,7 @@
 #include <assert.h>
 #include <limits.h>
 #include <math.h>
+#include <stdbool.h>
 #include "lmnt/common.h"
 #include "lmnt/interpreter.h"
 
@@ -13,6 +14,22 @@
 #endif
 
 
+// Charges the instruction budget for a taken branch from one instruction to another
+// Only backwards branches are charged, by the number of instructions they repeat
+// Returns true if the budget is exhausted and execution should stop before the branch target
+LMNT_ATTR_FAST static inline LMNT_INLINE_OP bool lmnt_charge_branch(lmnt_ictx* ctx, lmnt_loffset from, lmnt_loffset to)
+{
+    if (LMNT_LIKELY(!(ctx->status_flags & LMNT_ISTATUS_BUDGETED)) || to > from)
+        return false;
+    const lmnt_loffset cost = from - to + 1;
+    if (ctx->budget <= cost) {
+        ctx->budget = 0;
+        return true;
+    }
+    ctx->budget -= cost;
+    return false;
+}
+
 LMNT_ATTR_FAST static inline LMNT_INLINE_OP lmnt_result lmnt_op_return(lmnt_ictx* ctx, lmnt_offset arg1, lmnt_offset arg2, lmnt_offset arg3)
 {
     return LMNT_RETURNING;
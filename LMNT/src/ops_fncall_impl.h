@@ -25,7 +25,7 @@ LMNT_ATTR_FAST static inline LMNT_INLINE_OP lmnt_result lmnt_op_extcall(lmnt_ict
 
     lmnt_value* const eargs = &ctx->stack[stack_pos];
     lmnt_value* const ervals = &ctx->stack[stack_pos + extcall->args_count];
-    return extcall->function(ctx, extcall, eargs, ervals);
+    return lmnt_extcall_invoke(ctx, extcall, eargs, ervals);
 }
 
 #endif
\ No newline at end of file
@@ -31,7 +31,7 @@ static int32_t validate_string(const lmnt_archive* archive, lmnt_offset str_inde
 
 static int32_t validate_code(const lmnt_archive* archive, const lmnt_def* def, lmnt_offset code_index, size_t constants_count, size_t rw_stack_count);
 
-static int32_t validate_def_with_flags(const lmnt_archive* archive, lmnt_offset def_index, size_t constants_count, size_t rw_stack_count, lmnt_def_flags required_flags)
+static int32_t validate_def_header(const lmnt_archive* archive, lmnt_offset def_index, size_t rw_stack_count, lmnt_def_flags required_flags)
 {
     const lmnt_archive_header* hdr = (const lmnt_archive_header*)archive->data;
     // Do we have space?
@@ -68,6 +68,16 @@ static int32_t validate_def_with_flags(const lmnt_archive* archive, lmnt_offset
             return LMNT_VERROR_DEF_DEFAULT_ARGS;
     }
 
+    return sizeof(lmnt_def);
+}
+
+static int32_t validate_def_with_flags(const lmnt_archive* archive, lmnt_offset def_index, size_t constants_count, size_t rw_stack_count, lmnt_def_flags required_flags)
+{
+    int32_t hvresult = validate_def_header(archive, def_index, rw_stack_count, required_flags);
+    if (hvresult < 0)
+        return hvresult;
+
+    const lmnt_def* dhdr = (const lmnt_def*)(get_defs_segment(archive) + def_index);
     if (!(dhdr->flags & LMNT_DEFFLAG_EXTERN))
     {
         // Is our code ref valid?
@@ -76,7 +86,7 @@ static int32_t validate_def_with_flags(const lmnt_archive* archive, lmnt_offset
             return cvresult;
     }
 
-    return sizeof(lmnt_def);
+    return hvresult;
 }
 
 static int32_t validate_def(const lmnt_archive* archive, lmnt_offset def_index, size_t constants_count, size_t rw_stack_count)
@@ -321,11 +331,44 @@ static lmnt_validation_result validate_instruction(const lmnt_archive* archive,
     // extern call: deflo, defhi, imm
     case LMNT_OP_EXTCALL:
         return validate_operand_defptr(archive, def, arg1, arg2, arg3, constants_count, rw_stack_count);
+    // superinstructions: operands are those of the base opcode, the rest of the group is checked separately
+    case LMNT_OP_FMASS:
+    case LMNT_OP_CMPBRCEQ:
+    case LMNT_OP_CMPBRCNE:
+    case LMNT_OP_CMPBRCLT:
+    case LMNT_OP_CMPBRCLE:
+    case LMNT_OP_CMPBRCGT:
+    case LMNT_OP_CMPBRCGE:
+    case LMNT_OP_CMPBRCUN:
+    case LMNT_OP_ASSIGN4SS:
+        return validate_instruction(archive, def, lmnt_get_base_opcode(code), arg1, arg2, arg3, constants_count, rw_stack_count);
     default:
         return LMNT_VERROR_BAD_INSTRUCTION;
     }
 }
 
+static lmnt_validation_result validate_fused_group(const lmnt_instruction* instrs, size_t index, size_t count)
+{
+    const lmnt_opcode code = instrs[index].opcode;
+    const size_t length = lmnt_get_fused_length(code);
+    // the whole group must be present, and each trailing instruction must be what the superinstruction expects
+    if (index + length > count)
+        return LMNT_VERROR_BAD_INSTRUCTION;
+    for (size_t i = index + 1; i < index + length; ++i)
+    {
+        lmnt_opcode expected;
+        switch (code)
+        {
+        case LMNT_OP_FMASS:     expected = LMNT_OP_ADDSS; break;
+        case LMNT_OP_ASSIGN4SS: expected = LMNT_OP_ASSIGNSS; break;
+        default:                expected = (lmnt_opcode)(LMNT_OP_BRANCHCEQ + (code - LMNT_OP_CMPBRCEQ)); break;
+        }
+        if (instrs[i].opcode != expected)
+            return LMNT_VERROR_BAD_INSTRUCTION;
+    }
+    return LMNT_VALIDATION_OK;
+}
+
 static int32_t validate_code(const lmnt_archive* archive, const lmnt_def* def, lmnt_offset code_index, size_t constants_count, size_t rw_stack_count)
 {
     const lmnt_archive_header* hdr = (const lmnt_archive_header*)archive->data;
@@ -339,7 +382,11 @@ static int32_t validate_code(const lmnt_archive* archive, const lmnt_def* def, l
     // validate instructions
     const lmnt_instruction* instrs = (const lmnt_instruction*)(get_code_segment(archive) + code_index);
     for (size_t i = 0; i < chdr->instructions_count; ++i)
+    {
         LMNT_V_OK_OR_RETURN(validate_instruction(archive, def, instrs[i].opcode, instrs[i].arg1, instrs[i].arg2, instrs[i].arg3, constants_count, rw_stack_count));
+        if (LMNT_IS_FUSED_OP(instrs[i].opcode))
+            LMNT_V_OK_OR_RETURN(validate_fused_group(instrs, i, chdr->instructions_count));
+    }
 
     // check for backbranches
     bool has_backbranches = false;
@@ -362,7 +409,7 @@ static int32_t validate_code(const lmnt_archive* archive, const lmnt_def* def, l
 }
 
 
-lmnt_validation_result lmnt_archive_validate(lmnt_archive* archive, size_t memory_size, size_t* stack_count)
+static lmnt_validation_result validate_archive(lmnt_archive* archive, size_t memory_size, size_t* stack_count, bool lazy)
 {
     if (archive->size < sizeof(lmnt_archive_header))
         return LMNT_VERROR_HEADER_MAGIC;
@@ -415,7 +462,25 @@ lmnt_validation_result lmnt_archive_validate(lmnt_archive* archive, size_t memor
     lmnt_offset def_index = 0;
     while (def_index < hdr->defs_length)
     {
-        lmnt_validation_result dvresult = validate_def(archive, def_index, constants_count, rw_stack_count);
+        lmnt_validation_result dvresult;
+        if (lazy)
+        {
+            dvresult = validate_def_header(archive, def_index, rw_stack_count, LMNT_DEFFLAG_NONE);
+            if (dvresult >= 0)
+            {
+                // Externs have no code to check, anything else waits until it's first used
+                lmnt_def* def = (lmnt_def*)(get_defs_segment(archive) + def_index);
+                if (def->flags & LMNT_DEFFLAG_EXTERN)
+                    def->flags |= LMNT_DEFFLAG_VALIDATED;
+                else
+                    def->flags &= ~LMNT_DEFFLAG_VALIDATED;
+            }
+        }
+        else
+        {
+            dvresult = validate_def(archive, def_index, constants_count, rw_stack_count);
+        }
+
         if (dvresult >= 0)
             def_index += dvresult;
         else
@@ -425,6 +490,44 @@ lmnt_validation_result lmnt_archive_validate(lmnt_archive* archive, size_t memor
     if (stack_count)
         *stack_count = total_stack_count;
 
+    if (lazy)
+        archive->flags |= LMNT_ARCHIVE_LAZY_VALIDATION;
+    else
+        archive->flags &= ~LMNT_ARCHIVE_LAZY_VALIDATION;
     archive->flags |= LMNT_ARCHIVE_VALIDATED;
     return LMNT_VALIDATION_OK;
 }
+
+lmnt_validation_result lmnt_archive_validate(lmnt_archive* archive, size_t memory_size, size_t* stack_count)
+{
+    return validate_archive(archive, memory_size, stack_count, false);
+}
+
+lmnt_validation_result lmnt_archive_validate_lazy(lmnt_archive* archive, size_t memory_size, size_t* stack_count)
+{
+    return validate_archive(archive, memory_size, stack_count, true);
+}
+
+lmnt_validation_result lmnt_archive_validate_def(lmnt_archive* archive, const lmnt_def* def, size_t stack_count)
+{
+    const lmnt_archive_header* hdr = (const lmnt_archive_header*)archive->data;
+    // Make sure this def actually lives in this archive before trusting anything about it
+    const char* defs = get_defs_segment(archive);
+    if ((const char*)def < defs || (size_t)((const char*)def - defs) >= hdr->defs_length || ((const char*)def - defs) % sizeof(lmnt_def) != 0)
+        return LMNT_VERROR_DEF_SIZE;
+
+    const size_t constants_count = (hdr->constants_length / sizeof(lmnt_value));
+    if (stack_count < constants_count)
+        return LMNT_VERROR_STACK_SIZE;
+    int32_t dvresult = validate_def(archive, (lmnt_offset)((const char*)def - defs), constants_count, stack_count - constants_count);
+    if (dvresult < 0)
+        return dvresult;
+
+    return LMNT_VALIDATION_OK;
+}
+
+void lmnt_archive_set_def_validated(lmnt_archive* archive, const lmnt_def* def)
+{
+    (void)archive;
+    ((lmnt_def*)def)->flags |= LMNT_DEFFLAG_VALIDATED;
+}
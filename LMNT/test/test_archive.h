@@ -1,5 +1,6 @@
 #include "CUnit/CUnitCI.h"
 #include "lmnt/interpreter.h"
+#include "lmnt/validation.h"
 #include "testhelpers.h"
 #include <stdio.h>
 #include <stdbool.h>
@@ -149,8 +150,105 @@ static void test_archive_default_args(void)
     TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
 }
 
+static void test_archive_bound_args(void)
+{
+    test_function_data fndata = { NULL, NULL };
+    lmnt_value* args = NULL;
+    lmnt_value* rvals = NULL;
+
+    archive a = create_archive_array("test", 2, 2, 4, 2, 0, 0,
+        LMNT_OP_BYTES(LMNT_OP_ADDSS, 0x00, 0x01, 0x02),
+        LMNT_OP_BYTES(LMNT_OP_MULSS, 0x00, 0x01, 0x03)
+    );
+
+    // nothing to bind to until an archive has been prepared
+    const lmnt_def unprepared_def = { 0 };
+    CU_ASSERT_EQUAL(lmnt_get_args_ptr(ctx, &unprepared_def, &args), LMNT_ERROR_UNPREPARED_ARCHIVE);
+    CU_ASSERT_EQUAL(lmnt_get_rvals_ptr(ctx, &unprepared_def, &rvals), LMNT_ERROR_UNPREPARED_ARCHIVE);
+
+    TEST_LOAD_ARCHIVE(ctx, "test", a, fndata);
+    delete_archive_array(a);
+
+    CU_ASSERT_EQUAL(lmnt_get_args_ptr(ctx, fndata.def, &args), LMNT_OK);
+    CU_ASSERT_EQUAL(lmnt_get_rvals_ptr(ctx, fndata.def, &rvals), LMNT_OK);
+    CU_ASSERT_PTR_NOT_NULL(args);
+    CU_ASSERT_PTR_NOT_NULL(rvals);
+    CU_ASSERT_TRUE(rvals == args + 2);
+
+    args[0] = 3.0f;
+    args[1] = 4.0f;
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, NULL, 0), LMNT_OK);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 7.0, FLOAT_ERROR_MARGIN);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[1], 12.0, FLOAT_ERROR_MARGIN);
+
+    // pointers stay valid across executions
+    args[1] = 5.0f;
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, NULL, 0), LMNT_OK);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 8.0, FLOAT_ERROR_MARGIN);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[1], 15.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+}
+
+static void test_archive_lazy_validation(void)
+{
+    test_function_data fndata = { NULL, NULL };
+    lmnt_validation_result vr;
+    lmnt_value rvals[1];
+    const size_t rvals_count = sizeof(rvals)/sizeof(lmnt_value);
+
+    // valid def is validated on lookup and then executes as normal
+    archive a = create_archive_array_with_flags("test", LMNT_DEFFLAG_HAS_BACKBRANCHES, 1, 1, 2, 4, 0, 2,
+        LMNT_OP_BYTES(LMNT_OP_ADDSS, 0x02, 0x00, 0x02),
+        LMNT_OP_BYTES(LMNT_OP_CMP, 0x02, 0x01, 0x00),
+        LMNT_OP_BYTES(LMNT_OP_BRANCHCLT, 0x00, 0x00, 0x00),
+        LMNT_OP_BYTES(LMNT_OP_ASSIGNIBS, 0x0000, 0x4180, 0x03), // 16
+        1.0, 5.0
+    );
+    CU_ASSERT_EQUAL_FATAL(lmnt_load_archive(ctx, a.buf, a.size), LMNT_OK);
+    delete_archive_array(a);
+    CU_ASSERT_EQUAL_FATAL(lmnt_prepare_archive_lazy(ctx, &vr), LMNT_OK);
+    CU_ASSERT_EQUAL(vr, LMNT_VALIDATION_OK);
+    CU_ASSERT_EQUAL_FATAL(lmnt_find_def(ctx, "test", &fndata.def), LMNT_OK);
+    CU_ASSERT_TRUE(lmnt_archive_def_is_validated(&ctx->archive, fndata.def));
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 0.0f);
+    CU_ASSERT_EQUAL(lmnt_execute(ctx, fndata.def, rvals, (lmnt_offset)rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 16.0, FLOAT_ERROR_MARGIN);
+
+
+    // def has backbranches but claims not to: preparing succeeds, but the def can't be used
+    a = create_archive_array_with_flags("test", LMNT_DEFFLAG_NONE, 1, 1, 2, 4, 0, 2,
+        LMNT_OP_BYTES(LMNT_OP_ADDSS, 0x02, 0x00, 0x02),
+        LMNT_OP_BYTES(LMNT_OP_CMP, 0x02, 0x01, 0x00),
+        LMNT_OP_BYTES(LMNT_OP_BRANCHCLT, 0x00, 0x00, 0x00),
+        LMNT_OP_BYTES(LMNT_OP_ASSIGNIBS, 0x0000, 0x4180, 0x03), // 16
+        1.0, 5.0
+    );
+    CU_ASSERT_EQUAL_FATAL(lmnt_load_archive(ctx, a.buf, a.size), LMNT_OK);
+    delete_archive_array(a);
+    CU_ASSERT_EQUAL_FATAL(lmnt_prepare_archive_lazy(ctx, &vr), LMNT_OK);
+    CU_ASSERT_EQUAL(vr, LMNT_VALIDATION_OK);
+    fndata.def = NULL;
+    CU_ASSERT_EQUAL(lmnt_find_def(ctx, "test", &fndata.def), LMNT_ERROR_INVALID_ARCHIVE);
+    CU_ASSERT_TRUE(fndata.def == NULL);
+
+    CU_ASSERT_EQUAL_FATAL(lmnt_archive_get_def(&ctx->archive, 0, &fndata.def), LMNT_OK);
+    CU_ASSERT_FALSE(lmnt_archive_def_is_validated(&ctx->archive, fndata.def));
+    CU_ASSERT_EQUAL(lmnt_validate_def(ctx, fndata.def, &vr), LMNT_ERROR_INVALID_ARCHIVE);
+    CU_ASSERT_EQUAL(vr, LMNT_VERROR_DEF_FLAGS);
+    CU_ASSERT_EQUAL(lmnt_execute(ctx, fndata.def, rvals, (lmnt_offset)rvals_count), LMNT_ERROR_INVALID_ARCHIVE);
+
+    // preparing the same archive up front still rejects it outright
+    vr = LMNT_VALIDATION_OK;
+    CU_ASSERT_EQUAL(lmnt_prepare_archive(ctx, &vr), LMNT_ERROR_INVALID_ARCHIVE);
+    CU_ASSERT_EQUAL(vr, LMNT_VERROR_DEF_FLAGS);
+}
+
 
 MAKE_REGISTER_SUITE_FUNCTION(archive,
     CUNIT_CI_TEST(test_archive_backbranches),
-    CUNIT_CI_TEST(test_archive_default_args)
+    CUNIT_CI_TEST(test_archive_default_args),
+    CUNIT_CI_TEST(test_archive_bound_args),
+    CUNIT_CI_TEST(test_archive_lazy_validation)
 );
\ No newline at end of file
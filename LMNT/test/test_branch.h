@@ -792,6 +792,158 @@ static void test_branchun(void)
 }
 
 
+static void test_branch_budgeted(void)
+{
+    lmnt_value rvals[1];
+    const size_t rvals_count = sizeof(rvals)/sizeof(lmnt_value);
+    test_function_data fndata = { NULL, NULL };
+
+    // counts down from arg 0, returning the number of iterations
+    // each iteration of the loop costs 4 instructions of budget
+    archive a = create_archive_array_with_flags("test", LMNT_DEFFLAG_HAS_BACKBRANCHES, 1, 1, 3, 6, 0, 0,
+        LMNT_OP_BYTES(LMNT_OP_ASSIGNIBS, 0x0000, 0x3F80, 0x02), // 1
+        LMNT_OP_BYTES(LMNT_OP_ASSIGNIBS, 0x0000, 0x0000, 0x01), // 0
+        LMNT_OP_BYTES(LMNT_OP_ADDSS,     0x01, 0x02, 0x01),
+        LMNT_OP_BYTES(LMNT_OP_SUBSS,     0x00, 0x02, 0x00),
+        LMNT_OP_BYTES(LMNT_OP_CMPZ,      0x00, 0x00, 0x00),
+        LMNT_OP_BYTES(LMNT_OP_BRANCHCGT, 0x00, 0x02, 0x00)
+    );
+    TEST_LOAD_ARCHIVE(ctx, "test", a, fndata);
+    delete_archive_array(a);
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 10.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 10.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 10.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE_BUDGETED(ctx, fndata, rvals, rvals_count, 1000), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 10.0, FLOAT_ERROR_MARGIN);
+    CU_ASSERT_EQUAL(lmnt_get_remaining_budget(ctx), 1000 - 9 * 4);
+
+    // runs out after the third iteration, then picks up where it left off
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 10.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE_BUDGETED(ctx, fndata, rvals, rvals_count, 10), LMNT_INTERRUPTED);
+    CU_ASSERT_EQUAL(lmnt_get_remaining_budget(ctx), 0);
+    CU_ASSERT_EQUAL(TEST_RESUME_BUDGETED(ctx, fndata, rvals, rvals_count, 12), LMNT_INTERRUPTED);
+    CU_ASSERT_EQUAL(TEST_RESUME_BUDGETED(ctx, fndata, rvals, rvals_count, 1000), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 10.0, FLOAT_ERROR_MARGIN);
+
+    // a budget only limits loops, so a single pass always completes
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 1.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE_BUDGETED(ctx, fndata, rvals, rvals_count, 0), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 1.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+}
+
+
+static void test_branch_budgeted_flags(void)
+{
+    lmnt_value rvals[1];
+    const size_t rvals_count = sizeof(rvals)/sizeof(lmnt_value);
+    test_function_data fndata = { NULL, NULL };
+
+    // as above, but the loop jumps back to a branch which reads the flags from the comparison before the jump
+    // each iteration of the loop costs 5 instructions of budget
+    archive a = create_archive_array_with_flags("test", LMNT_DEFFLAG_HAS_BACKBRANCHES, 1, 1, 3, 8, 0, 0,
+        LMNT_OP_BYTES(LMNT_OP_ASSIGNIBS, 0x0000, 0x3F80, 0x02), // 1
+        LMNT_OP_BYTES(LMNT_OP_ASSIGNIBS, 0x0000, 0x0000, 0x01), // 0
+        LMNT_OP_BYTES(LMNT_OP_CMPZ,      0x00, 0x00, 0x00),
+        LMNT_OP_BYTES(LMNT_OP_BRANCHCLE, 0x00, 0x08, 0x00),
+        LMNT_OP_BYTES(LMNT_OP_ADDSS,     0x01, 0x02, 0x01),
+        LMNT_OP_BYTES(LMNT_OP_SUBSS,     0x00, 0x02, 0x00),
+        LMNT_OP_BYTES(LMNT_OP_CMPZ,      0x00, 0x00, 0x00),
+        LMNT_OP_BYTES(LMNT_OP_BRANCH,    0x00, 0x03, 0x00)
+    );
+    TEST_LOAD_ARCHIVE(ctx, "test", a, fndata);
+    delete_archive_array(a);
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 10.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE_BUDGETED(ctx, fndata, rvals, rvals_count, 1000), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 10.0, FLOAT_ERROR_MARGIN);
+    CU_ASSERT_EQUAL(lmnt_get_remaining_budget(ctx), 1000 - 10 * 5);
+
+    // stops mid-loop, and has to carry on looping when resumed
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 10.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE_BUDGETED(ctx, fndata, rvals, rvals_count, 12), LMNT_INTERRUPTED);
+    CU_ASSERT_EQUAL(TEST_RESUME_BUDGETED(ctx, fndata, rvals, rvals_count, 1000), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 10.0, FLOAT_ERROR_MARGIN);
+
+    // stops after the final comparison, and has to leave the loop when resumed
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 10.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE_BUDGETED(ctx, fndata, rvals, rvals_count, 9 * 5 + 1), LMNT_INTERRUPTED);
+    CU_ASSERT_EQUAL(TEST_RESUME_BUDGETED(ctx, fndata, rvals, rvals_count, 1000), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 10.0, FLOAT_ERROR_MARGIN);
+    CU_ASSERT_EQUAL(lmnt_get_remaining_budget(ctx), 1000);
+
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+}
+
+
+static void test_branch_resume_interrupted(void)
+{
+    lmnt_value rvals[1];
+    const size_t rvals_count = sizeof(rvals)/sizeof(lmnt_value);
+    test_function_data fndata = { NULL, NULL };
+
+    // counts down from arg 0, returning the number of iterations
+    archive a = create_archive_array_with_flags("test", LMNT_DEFFLAG_HAS_BACKBRANCHES, 1, 1, 3, 6, 0, 0,
+        LMNT_OP_BYTES(LMNT_OP_ASSIGNIBS, 0x0000, 0x3F80, 0x02), // 1
+        LMNT_OP_BYTES(LMNT_OP_ASSIGNIBS, 0x0000, 0x0000, 0x01), // 0
+        LMNT_OP_BYTES(LMNT_OP_ADDSS,     0x01, 0x02, 0x01),
+        LMNT_OP_BYTES(LMNT_OP_SUBSS,     0x00, 0x02, 0x00),
+        LMNT_OP_BYTES(LMNT_OP_CMPZ,      0x00, 0x00, 0x00),
+        LMNT_OP_BYTES(LMNT_OP_BRANCHCGT, 0x00, 0x02, 0x00)
+    );
+    TEST_LOAD_ARCHIVE(ctx, "test", a, fndata);
+    delete_archive_array(a);
+
+    // interrupted before it gets anywhere, then resuming runs it to completion rather than stopping again
+    // this is the interpreter's lmnt_resume whichever way the test archive was loaded
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 10.0f);
+    CU_ASSERT_EQUAL(lmnt_interrupt(ctx), LMNT_OK);
+    CU_ASSERT_EQUAL(lmnt_execute(ctx, fndata.def, rvals, (lmnt_offset)rvals_count), LMNT_INTERRUPTED);
+    CU_ASSERT_EQUAL(lmnt_resume(ctx, fndata.def, rvals, (lmnt_offset)rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 10.0, FLOAT_ERROR_MARGIN);
+
+    // nothing is left over to interrupt the next call
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 10.0f);
+    CU_ASSERT_EQUAL(lmnt_execute(ctx, fndata.def, rvals, (lmnt_offset)rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 10.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+}
+
+
+#define SKIP_TO(n) LMNT_OP_BYTES(LMNT_OP_BRANCH, 0x00, (n), 0x00)
+
+static void test_branch_many(void)
+{
+    lmnt_value rvals[1];
+    const size_t rvals_count = sizeof(rvals)/sizeof(lmnt_value);
+    test_function_data fndata = { NULL, NULL };
+
+    // more branches than there used to be room for when compiling
+    archive a = create_archive_array("test", 1, 1, 2, 42, 0, 0,
+        SKIP_TO(1),  SKIP_TO(2),  SKIP_TO(3),  SKIP_TO(4),  SKIP_TO(5),  SKIP_TO(6),  SKIP_TO(7),  SKIP_TO(8),
+        SKIP_TO(9),  SKIP_TO(10), SKIP_TO(11), SKIP_TO(12), SKIP_TO(13), SKIP_TO(14), SKIP_TO(15), SKIP_TO(16),
+        SKIP_TO(17), SKIP_TO(18), SKIP_TO(19), SKIP_TO(20), SKIP_TO(21), SKIP_TO(22), SKIP_TO(23), SKIP_TO(24),
+        SKIP_TO(25), SKIP_TO(26), SKIP_TO(27), SKIP_TO(28), SKIP_TO(29), SKIP_TO(30), SKIP_TO(31), SKIP_TO(32),
+        SKIP_TO(33), SKIP_TO(34), SKIP_TO(35), SKIP_TO(36), SKIP_TO(37), SKIP_TO(38), SKIP_TO(39), SKIP_TO(40),
+        LMNT_OP_BYTES(LMNT_OP_ADDSS,   0x00, 0x00, 0x01),
+        LMNT_OP_BYTES(LMNT_OP_RETURN,  0x00, 0x00, 0x00)
+    );
+    TEST_LOAD_ARCHIVE(ctx, "test", a, fndata);
+    delete_archive_array(a);
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 3.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 6.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+}
+
+#undef SKIP_TO
 
 static void test_branchceq_cmpz(void)
 {
@@ -1466,6 +1618,10 @@ MAKE_REGISTER_SUITE_FUNCTION(branch,
     CUNIT_CI_TEST(test_branchpos),
     CUNIT_CI_TEST(test_branchneg),
     CUNIT_CI_TEST(test_branchun),
+    CUNIT_CI_TEST(test_branch_budgeted),
+    CUNIT_CI_TEST(test_branch_budgeted_flags),
+    CUNIT_CI_TEST(test_branch_resume_interrupted),
+    CUNIT_CI_TEST(test_branch_many),
     CUNIT_CI_TEST(test_branchceq),
     CUNIT_CI_TEST(test_branchcne),
     CUNIT_CI_TEST(test_branchclt),
@@ -20,6 +20,11 @@ static lmnt_result test_extcall_bad(const lmnt_ictx* ctx, const lmnt_extcall_inf
     return -123456789;
 }
 
+static lmnt_value test_extcall_scalar(lmnt_value a, lmnt_value b, lmnt_value c, lmnt_value d)
+{
+    return a * 4;
+}
+
 static const char extcall_name[] = "extcall";
 
 static archive create_archive_array_with_extcall(const char* def_name, uint16_t args_count, uint16_t rvals_count, uint16_t stack_count, uint32_t instr_count, uint32_t data_count, uint32_t consts_count, ...)
@@ -140,7 +145,7 @@ static archive create_archive_array_with_extcall(const char* def_name, uint16_t
 static void test_extcall_direct(void)
 {
     lmnt_extcall_info extcalls[] = {
-        { "extcall", 1, 1, (lmnt_extcall_fn)(&test_extcall_good) }
+        { "extcall", 1, 1, (lmnt_extcall_fn)(&test_extcall_good), LMNT_EXTCALL_NONE, NULL }
     };
     CU_ASSERT_EQUAL_FATAL(lmnt_extcalls_set(ctx, extcalls, 1), LMNT_OK);
 
@@ -194,7 +199,7 @@ static void test_extcall_direct(void)
 static void test_extcall_indirect(void)
 {
     lmnt_extcall_info extcalls[] = {
-        { "extcall", 1, 1, (lmnt_extcall_fn)(&test_extcall_good) }
+        { "extcall", 1, 1, (lmnt_extcall_fn)(&test_extcall_good), LMNT_EXTCALL_NONE, NULL }
     };
     CU_ASSERT_EQUAL_FATAL(lmnt_extcalls_set(ctx, extcalls, 1), LMNT_OK);
 
@@ -248,7 +253,7 @@ static void test_extcall_indirect(void)
 static void test_extcall_recursion(void)
 {
     lmnt_extcall_info extcalls[] = {
-        { "extcall", 1, 1, (lmnt_extcall_fn)(&test_extcall_good) }
+        { "extcall", 1, 1, (lmnt_extcall_fn)(&test_extcall_good), LMNT_EXTCALL_NONE, NULL }
     };
     CU_ASSERT_EQUAL_FATAL(lmnt_extcalls_set(ctx, extcalls, 1), LMNT_OK);
 
@@ -263,9 +268,68 @@ static void test_extcall_recursion(void)
 }
 
 
+static void test_extcall_pure_scalar(void)
+{
+    lmnt_extcall_info extcalls[] = {
+        { "extcall", 1, 1, NULL, LMNT_EXTCALL_PURE_SCALAR, &test_extcall_scalar }
+    };
+    CU_ASSERT_EQUAL_FATAL(lmnt_extcalls_set(ctx, extcalls, 1), LMNT_OK);
+
+    archive a = create_archive_array_with_extcall("test", 3, 1, 4, 2, 0, 0,
+        LMNT_OP_BYTES(LMNT_OP_ADDSS, 0x00, 0x01, 0x02),
+        LMNT_OP_BYTES(LMNT_OP_EXTCALL, 0x10, 0x00, 0x02)
+    );
+    test_function_data fndata = { NULL, NULL };
+    TEST_LOAD_ARCHIVE(ctx, "test", a, fndata);
+    delete_archive_array(a);
+
+    lmnt_value rvals[1];
+    const size_t rvals_count = sizeof(rvals)/sizeof(lmnt_value);
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 1.0f, 2.0f, 0.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 12.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, -1.0f, -6.0f, 0.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], -28.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 1.0f, nanf(""), 0.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, rvals_count), rvals_count);
+    CU_ASSERT_TRUE(isnan(rvals[0]));
+
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+
+
+    // executing the extern def directly
+    a = create_archive_array_with_extcall("test", 3, 1, 4, 1, 0, 0,
+        LMNT_OP_BYTES(LMNT_OP_EXTCALL, 0x10, 0x00, 0x02)
+    );
+    TEST_LOAD_ARCHIVE(ctx, "extcall", a, fndata);
+    delete_archive_array(a);
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 3.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 12.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+
+
+    // entries which can't be called this way
+    lmnt_extcall_info bad_extcalls[] = {
+        { "extcall", 1, 1, NULL, LMNT_EXTCALL_PURE_SCALAR, NULL },
+        { "extcall", LMNT_EXTCALL_PURE_SCALAR_MAX_ARGS + 1, 1, NULL, LMNT_EXTCALL_PURE_SCALAR, &test_extcall_scalar },
+        { "extcall", 1, 2, NULL, LMNT_EXTCALL_PURE_SCALAR, &test_extcall_scalar },
+    };
+    CU_ASSERT_EQUAL(lmnt_extcalls_set(ctx, &bad_extcalls[0], 1), LMNT_ERROR_INVALID_PTR);
+    CU_ASSERT_EQUAL(lmnt_extcalls_set(ctx, &bad_extcalls[1], 1), LMNT_ERROR_ARGS_MISMATCH);
+    CU_ASSERT_EQUAL(lmnt_extcalls_set(ctx, &bad_extcalls[2], 1), LMNT_ERROR_RVALS_MISMATCH);
+}
+
 
 MAKE_REGISTER_SUITE_FUNCTION(fncall,
     CUNIT_CI_TEST(test_extcall_direct),
     CUNIT_CI_TEST(test_extcall_indirect),
-    CUNIT_CI_TEST(test_extcall_recursion)
+    CUNIT_CI_TEST(test_extcall_recursion),
+    CUNIT_CI_TEST(test_extcall_pure_scalar)
 );
\ No newline at end of file
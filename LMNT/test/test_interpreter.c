@@ -8,6 +8,7 @@
 #include "test_misc.h"
 #include "test_branch.h"
 #include "test_fncall.h"
+#include "test_superinstructions.h"
 
 
 int main(int argc, char** argv)
@@ -20,6 +21,7 @@ int main(int argc, char** argv)
     register_suite_misc();
     register_suite_branch();
     register_suite_fncall();
+    register_suite_superinstructions();
 
     return CU_CI_main(argc, argv);
 }
\ No newline at end of file
@@ -0,0 +1,27 @@
+#include "testsetup_interpreter_threaded.h"
+
+#include "test_archive.h"
+#include "test_maths_scalar.h"
+#include "test_maths_vector.h"
+#include "test_bounds.h"
+#include "test_trig.h"
+#include "test_misc.h"
+#include "test_branch.h"
+#include "test_fncall.h"
+#include "test_superinstructions.h"
+
+
+int main(int argc, char** argv)
+{
+    register_suite_archive();
+    register_suite_maths_scalar();
+    register_suite_maths_vector();
+    register_suite_bounds();
+    register_suite_trig();
+    register_suite_misc();
+    register_suite_branch();
+    register_suite_fncall();
+    register_suite_superinstructions();
+
+    return CU_CI_main(argc, argv);
+}
\ No newline at end of file
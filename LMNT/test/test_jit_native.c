@@ -8,6 +8,9 @@
 #include "test_misc.h"
 #include "test_branch.h"
 #include "test_fncall.h"
+#include "test_superinstructions.h"
+#include "test_jit_specialised.h"
+#include "test_tier.h"
 
 
 int main(int argc, char** argv)
@@ -20,6 +23,9 @@ int main(int argc, char** argv)
     register_suite_misc();
     register_suite_branch();
     register_suite_fncall();
+    register_suite_superinstructions();
+    register_suite_jit_specialised();
+    register_suite_tier();
 
     return CU_CI_main(argc, argv);
 }
\ No newline at end of file
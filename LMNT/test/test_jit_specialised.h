@@ -0,0 +1,260 @@
+#include "CUnit/CUnitCI.h"
+#include "lmnt/interpreter.h"
+#include "lmnt/jit.h"
+#include "testhelpers.h"
+#include <stdio.h>
+#include <stdbool.h>
+
+#if !defined(TESTSETUP_INCLUDED)
+#error "This file cannot be included without a testsetup header already having been included"
+#endif
+
+
+// Loads an archive like TEST_LOAD_ARCHIVE, but compiles it with lmnt_jit_compile_specialised
+static lmnt_result load_specialised_archive(archive a, const bool* const_mask, const lmnt_value* const_values, test_function_data* fndata)
+{
+    CU_ASSERT_EQUAL_FATAL(lmnt_load_archive(ctx, a.buf, a.size), LMNT_OK);
+    lmnt_validation_result vr;
+    CU_ASSERT_EQUAL_FATAL(lmnt_prepare_archive(ctx, &vr), LMNT_OK);
+    CU_ASSERT_EQUAL_FATAL(vr, LMNT_VALIDATION_OK);
+    CU_ASSERT_EQUAL_FATAL(lmnt_find_def(ctx, "test", &(fndata->def)), LMNT_OK);
+
+    lmnt_jit_fn_data* jitfn = (lmnt_jit_fn_data*)calloc(1, sizeof(lmnt_jit_fn_data));
+    const lmnt_result result = lmnt_jit_compile_specialised(ctx, fndata->def, LMNT_JIT_TARGET_NATIVE, const_mask, const_values, jitfn);
+    if (result == LMNT_OK) {
+        fndata->data = jitfn;
+    } else {
+        free(jitfn);
+        fndata->data = NULL;
+    }
+    return result;
+}
+
+
+static void test_specialised_args(void)
+{
+    lmnt_value rvals[1];
+    const size_t rvals_count = sizeof(rvals)/sizeof(lmnt_value);
+    test_function_data fndata = { NULL, NULL };
+
+    archive a = create_archive_array("test", 2, 1, 4, 2, 0, 0,
+        LMNT_OP_BYTES(LMNT_OP_ADDSS, 0x00, 0x01, 0x03),
+        LMNT_OP_BYTES(LMNT_OP_MULSS, 0x03, 0x00, 0x02)
+    );
+    const bool mask[] = { true, false };
+    const lmnt_value values[] = { 2.0f, 0.0f };
+    CU_ASSERT_EQUAL(load_specialised_archive(a, mask, values, &fndata), LMNT_OK);
+    delete_archive_array(a);
+
+    // the fixed arg keeps its value whatever is passed in
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 100.0f, 3.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 10.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, -1.0f, 5.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 14.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+
+
+    // a NULL mask fixes every arg, so the whole function is known up front
+    a = create_archive_array("test", 4, 1, 9, 2, 0, 0,
+        LMNT_OP_BYTES(LMNT_OP_ADDVV, 0x00, 0x00, 0x05),
+        LMNT_OP_BYTES(LMNT_OP_SUMV,  0x05, 0x00, 0x04)
+    );
+    const lmnt_value vvalues[] = { 1.0f, 2.0f, 3.0f, 4.0f };
+    CU_ASSERT_EQUAL(load_specialised_archive(a, NULL, vvalues, &fndata), LMNT_OK);
+    delete_archive_array(a);
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 0.0f, 0.0f, 0.0f, 0.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 20.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+}
+
+static void test_specialised_branch(void)
+{
+    lmnt_value rvals[1];
+    const size_t rvals_count = sizeof(rvals)/sizeof(lmnt_value);
+    test_function_data fndata = { NULL, NULL };
+
+    archive a = create_archive_array("test", 1, 1, 2, 4, 0, 0,
+        LMNT_OP_BYTES(LMNT_OP_BRANCHZ,   0x00, 0x03, 0x00),
+        LMNT_OP_BYTES(LMNT_OP_ASSIGNIBS, 0x0000, 0x3F80, 0x01), // 1
+        LMNT_OP_BYTES(LMNT_OP_RETURN,    0x00, 0x00, 0x00),
+        LMNT_OP_BYTES(LMNT_OP_ASSIGNIBS, 0x0000, 0x40A0, 0x01)  // 5
+    );
+    const lmnt_value zero[] = { 0.0f };
+    CU_ASSERT_EQUAL(load_specialised_archive(a, NULL, zero, &fndata), LMNT_OK);
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 1.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 5.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+
+    const lmnt_value two[] = { 2.0f };
+    CU_ASSERT_EQUAL(load_specialised_archive(a, NULL, two, &fndata), LMNT_OK);
+    delete_archive_array(a);
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 0.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 1.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+
+
+    // comparisons which only depend on fixed args get resolved, others are left alone
+    a = create_archive_array("test", 2, 1, 3, 5, 0, 0,
+        LMNT_OP_BYTES(LMNT_OP_CMP,       0x00, 0x01, 0x00),
+        LMNT_OP_BYTES(LMNT_OP_BRANCHCLT, 0x00, 0x04, 0x00),
+        LMNT_OP_BYTES(LMNT_OP_ASSIGNCGT, 0x00, 0x01, 0x02),
+        LMNT_OP_BYTES(LMNT_OP_RETURN,    0x00, 0x00, 0x00),
+        LMNT_OP_BYTES(LMNT_OP_ASSIGNIBS, 0x0000, 0x40E0, 0x02)  // 7
+    );
+    const lmnt_value less[] = { 1.0f, 2.0f };
+    CU_ASSERT_EQUAL(load_specialised_archive(a, NULL, less, &fndata), LMNT_OK);
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 3.0f, 2.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 7.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+
+    const lmnt_value greater[] = { 3.0f, 2.0f };
+    CU_ASSERT_EQUAL(load_specialised_archive(a, NULL, greater, &fndata), LMNT_OK);
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 1.0f, 2.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 3.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+
+    const bool first_only[] = { true, false };
+    CU_ASSERT_EQUAL(load_specialised_archive(a, first_only, greater, &fndata), LMNT_OK);
+    delete_archive_array(a);
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 1.0f, 2.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 3.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 1.0f, 5.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 7.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+}
+
+static void test_specialised_loop(void)
+{
+    lmnt_value rvals[1];
+    const size_t rvals_count = sizeof(rvals)/sizeof(lmnt_value);
+    test_function_data fndata = { NULL, NULL };
+
+    // the fixed arg is the loop counter, so it can't be relied on inside the loop
+    archive a = create_archive_array_with_flags("test", LMNT_DEFFLAG_HAS_BACKBRANCHES, 1, 1, 2, 6, 0, 1,
+        LMNT_OP_BYTES(LMNT_OP_ASSIGNIBS, 0x0000, 0x0000, 0x02), // 0
+        LMNT_OP_BYTES(LMNT_OP_CMPZ,      0x01, 0x00, 0x00),
+        LMNT_OP_BYTES(LMNT_OP_BRANCHCLE, 0x00, 0x06, 0x00),
+        LMNT_OP_BYTES(LMNT_OP_ADDSS,     0x02, 0x01, 0x02),
+        LMNT_OP_BYTES(LMNT_OP_SUBSS,     0x01, 0x00, 0x01),
+        LMNT_OP_BYTES(LMNT_OP_BRANCH,    0x00, 0x01, 0x00),
+        1.0
+    );
+    const lmnt_value four[] = { 4.0f };
+    CU_ASSERT_EQUAL(load_specialised_archive(a, NULL, four, &fndata), LMNT_OK);
+    delete_archive_array(a);
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 2.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 10.0, FLOAT_ERROR_MARGIN);
+
+    // running it again starts from the fixed value rather than whatever the last run left behind
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 10.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+}
+
+static void test_specialised_default_args(void)
+{
+    lmnt_value rvals[1];
+    const size_t rvals_count = sizeof(rvals)/sizeof(lmnt_value);
+    test_function_data fndata = { NULL, NULL };
+
+    archive a = create_archive_array_with_flags("test", LMNT_DEFFLAG_HAS_DEFAULT_ARGS, 2, 1, 3, 1, 2, 0,
+        LMNT_OP_BYTES(LMNT_OP_ADDSS, 0x00, 0x01, 0x02),
+        1.0, 5.0
+    );
+    CU_ASSERT_EQUAL(load_specialised_archive(a, NULL, NULL, &fndata), LMNT_OK);
+    delete_archive_array(a);
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 3.0f, 3.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 6.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+
+
+    // with a partial set of default args, only those are fixed
+    a = create_archive_array_with_flags("test", LMNT_DEFFLAG_HAS_DEFAULT_ARGS, 2, 1, 3, 1, 1, 0,
+        LMNT_OP_BYTES(LMNT_OP_ADDSS, 0x00, 0x01, 0x02),
+        1.0
+    );
+    CU_ASSERT_EQUAL(load_specialised_archive(a, NULL, NULL, &fndata), LMNT_OK);
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 3.0f, 3.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 4.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+
+    // ... and asking for one without a default fails
+    const bool second_only[] = { false, true };
+    CU_ASSERT_EQUAL(load_specialised_archive(a, second_only, NULL, &fndata), LMNT_ERROR_ARGS_MISMATCH);
+    delete_archive_array(a);
+
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+
+
+    a = create_archive_array("test", 2, 1, 3, 1, 0, 0,
+        LMNT_OP_BYTES(LMNT_OP_ADDSS, 0x00, 0x01, 0x02)
+    );
+    CU_ASSERT_EQUAL(load_specialised_archive(a, NULL, NULL, &fndata), LMNT_ERROR_NOT_FOUND);
+    delete_archive_array(a);
+
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+}
+
+static void test_specialised_unvalidated(void)
+{
+    test_function_data fndata = { NULL, NULL };
+    lmnt_validation_result vr;
+
+    // a lazily prepared archive's defs aren't validated until they're used, which includes specialising them
+    archive a = create_archive_array("test", 2, 1, 3, 1, 0, 0,
+        LMNT_OP_BYTES(LMNT_OP_ADDSS, 0x00, 0x40, 0x02)
+    );
+    CU_ASSERT_EQUAL_FATAL(lmnt_load_archive(ctx, a.buf, a.size), LMNT_OK);
+    delete_archive_array(a);
+    CU_ASSERT_EQUAL_FATAL(lmnt_prepare_archive_lazy(ctx, &vr), LMNT_OK);
+    CU_ASSERT_EQUAL(vr, LMNT_VALIDATION_OK);
+    CU_ASSERT_EQUAL_FATAL(lmnt_archive_get_def(&ctx->archive, 0, &fndata.def), LMNT_OK);
+    CU_ASSERT_FALSE(lmnt_archive_def_is_validated(&ctx->archive, fndata.def));
+
+    const lmnt_value values[] = { 1.0f, 2.0f };
+    lmnt_jit_fn_data jitfn;
+    CU_ASSERT_EQUAL(lmnt_jit_compile_specialised(ctx, fndata.def, LMNT_JIT_TARGET_NATIVE, NULL, values, &jitfn), LMNT_ERROR_INVALID_ARCHIVE);
+    CU_ASSERT_FALSE(lmnt_archive_def_is_validated(&ctx->archive, fndata.def));
+}
+
+
+MAKE_REGISTER_SUITE_FUNCTION(jit_specialised,
+    CUNIT_CI_TEST(test_specialised_args),
+    CUNIT_CI_TEST(test_specialised_branch),
+    CUNIT_CI_TEST(test_specialised_loop),
+    CUNIT_CI_TEST(test_specialised_default_args),
+    CUNIT_CI_TEST(test_specialised_unvalidated)
+);
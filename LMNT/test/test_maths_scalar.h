@@ -531,6 +531,63 @@ static void test_log10(void)
 }
 
 
+static void test_muladdss(void)
+{
+    lmnt_value rvals[2];
+    test_function_data fndata = { NULL, NULL };
+
+    // product overwritten by the add
+    archive a = create_archive_array("test", 3, 1, 4, 2, 0, 0,
+        LMNT_OP_BYTES(LMNT_OP_MULSS, 0x00, 0x01, 0x03),
+        LMNT_OP_BYTES(LMNT_OP_ADDSS, 0x02, 0x03, 0x03)
+    );
+    TEST_LOAD_ARCHIVE(ctx, "test", a, fndata);
+    delete_archive_array(a);
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 2.0f, 3.0f, 4.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, 1), 1);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 10.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, -1.5f, 4.0f, 0.5f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, 1), 1);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], -5.5, FLOAT_ERROR_MARGIN);
+
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+
+
+    // product is also returned
+    a = create_archive_array("test", 3, 2, 5, 2, 0, 0,
+        LMNT_OP_BYTES(LMNT_OP_MULSS, 0x00, 0x01, 0x04),
+        LMNT_OP_BYTES(LMNT_OP_ADDSS, 0x04, 0x02, 0x03)
+    );
+    TEST_LOAD_ARCHIVE(ctx, "test", a, fndata);
+    delete_archive_array(a);
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 2.0f, 3.0f, 4.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, 2), 2);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 10.0, FLOAT_ERROR_MARGIN);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[1], 6.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+
+
+    // product is read again after the add
+    a = create_archive_array("test", 3, 1, 5, 3, 0, 0,
+        LMNT_OP_BYTES(LMNT_OP_MULSS, 0x00, 0x01, 0x04),
+        LMNT_OP_BYTES(LMNT_OP_ADDSS, 0x02, 0x04, 0x03),
+        LMNT_OP_BYTES(LMNT_OP_ADDSS, 0x03, 0x04, 0x03)
+    );
+    TEST_LOAD_ARCHIVE(ctx, "test", a, fndata);
+    delete_archive_array(a);
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 2.0f, 3.0f, 4.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, 1), 1);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 16.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+}
+
+
 
 MAKE_REGISTER_SUITE_FUNCTION(maths_scalar,
     CUNIT_CI_TEST(test_addss),
@@ -542,5 +599,6 @@ MAKE_REGISTER_SUITE_FUNCTION(maths_scalar,
     CUNIT_CI_TEST(test_sqrts),
     CUNIT_CI_TEST(test_ln),
     CUNIT_CI_TEST(test_log2),
-    CUNIT_CI_TEST(test_log10)
+    CUNIT_CI_TEST(test_log10),
+    CUNIT_CI_TEST(test_muladdss)
 );
@@ -708,6 +708,34 @@ static void test_sumv(void)
     TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
 }
 
+static void test_muladdvv(void)
+{
+    // product is only kept in scratch space
+    archive a = create_archive_array("test", 12, 4, 20, 2, 0, 0,
+        LMNT_OP_BYTES(LMNT_OP_MULVV, 0x00, 0x04, 0x10),
+        LMNT_OP_BYTES(LMNT_OP_ADDVV, 0x10, 0x08, 0x0C)
+    );
+    test_function_data fndata = { NULL, NULL };
+    TEST_LOAD_ARCHIVE(ctx, "test", a, fndata);
+    delete_archive_array(a);
+
+    lmnt_value rvals[4];
+    const size_t rvals_count = sizeof(rvals)/sizeof(lmnt_value);
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0,
+        1.0f, 2.0f, 3.0f, 4.0f,
+        2.0f, 3.0f, -2.0f, 0.5f,
+        4.0f, 4.0f, 4.0f, 4.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 6.0, FLOAT_ERROR_MARGIN);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[1], 10.0, FLOAT_ERROR_MARGIN);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[2], -2.0, FLOAT_ERROR_MARGIN);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[3], 6.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+}
+
+
 
 MAKE_REGISTER_SUITE_FUNCTION(maths_vector,
     CUNIT_CI_TEST(test_addvv),
@@ -718,5 +746,6 @@ MAKE_REGISTER_SUITE_FUNCTION(maths_vector,
     CUNIT_CI_TEST(test_powvv),
     CUNIT_CI_TEST(test_powvs),
     CUNIT_CI_TEST(test_sqrtv),
-    CUNIT_CI_TEST(test_sumv)
+    CUNIT_CI_TEST(test_sumv),
+    CUNIT_CI_TEST(test_muladdvv)
 );
@@ -0,0 +1,199 @@
+#include "CUnit/CUnitCI.h"
+#include "lmnt/interpreter.h"
+#include "testhelpers.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include <math.h>
+
+#if !defined(TESTSETUP_INCLUDED)
+#error "This file cannot be included without a testsetup header already having been included"
+#endif
+
+
+static lmnt_opcode get_prepared_opcode(lmnt_ictx* ctx, const lmnt_def* def, size_t index)
+{
+    const lmnt_instruction* instrs = NULL;
+    CU_ASSERT_EQUAL(lmnt_archive_get_code_instructions(&ctx->archive, def->code, &instrs), LMNT_OK);
+    return instrs ? instrs[index].opcode : LMNT_OP_END;
+}
+
+
+static void test_fmass(void)
+{
+    lmnt_value rvals[1];
+    const size_t rvals_count = sizeof(rvals)/sizeof(lmnt_value);
+    test_function_data fndata = { NULL, NULL };
+
+    archive a = create_archive_array("test", 3, 1, 5, 2, 0, 0,
+        LMNT_OP_BYTES(LMNT_OP_MULSS, 0x00, 0x01, 0x04),
+        LMNT_OP_BYTES(LMNT_OP_ADDSS, 0x04, 0x02, 0x03)
+    );
+    TEST_LOAD_ARCHIVE(ctx, "test", a, fndata);
+    delete_archive_array(a);
+
+#if !defined(LMNT_NO_SUPERINSTRUCTIONS)
+    CU_ASSERT_EQUAL(get_prepared_opcode(ctx, fndata.def, 0), LMNT_OP_FMASS);
+    CU_ASSERT_EQUAL(get_prepared_opcode(ctx, fndata.def, 1), LMNT_OP_ADDSS);
+#endif
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 2.0f, 3.0f, 4.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 10.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+
+
+    // the add does not use the product, so should be left alone
+    a = create_archive_array("test", 3, 1, 5, 3, 0, 0,
+        LMNT_OP_BYTES(LMNT_OP_MULSS, 0x00, 0x01, 0x04),
+        LMNT_OP_BYTES(LMNT_OP_ADDSS, 0x00, 0x02, 0x03),
+        LMNT_OP_BYTES(LMNT_OP_ADDSS, 0x03, 0x04, 0x03)
+    );
+    TEST_LOAD_ARCHIVE(ctx, "test", a, fndata);
+    delete_archive_array(a);
+
+    CU_ASSERT_EQUAL(get_prepared_opcode(ctx, fndata.def, 0), LMNT_OP_MULSS);
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 2.0f, 3.0f, 4.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 12.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+}
+
+static void test_cmpbr(void)
+{
+    lmnt_value rvals[1];
+    const size_t rvals_count = sizeof(rvals)/sizeof(lmnt_value);
+    test_function_data fndata = { NULL, NULL };
+
+    archive a = create_archive_array("test", 2, 1, 3, 5, 0, 0,
+        LMNT_OP_BYTES(LMNT_OP_CMP,       0x00, 0x01, 0x00),
+        LMNT_OP_BYTES(LMNT_OP_BRANCHCLT, 0x00, 0x04, 0x00),
+        LMNT_OP_BYTES(LMNT_OP_ASSIGNIBS, 0x0000, 0x40A0, 0x02), // 5
+        LMNT_OP_BYTES(LMNT_OP_RETURN,    0x00, 0x00, 0x00),
+        LMNT_OP_BYTES(LMNT_OP_ASSIGNIBS, 0x0000, 0x3F80, 0x02)  // 1
+    );
+    TEST_LOAD_ARCHIVE(ctx, "test", a, fndata);
+    delete_archive_array(a);
+
+#if !defined(LMNT_NO_SUPERINSTRUCTIONS)
+    CU_ASSERT_EQUAL(get_prepared_opcode(ctx, fndata.def, 0), LMNT_OP_CMPBRCLT);
+#endif
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 1.0f, 2.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 1.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 2.0f, 1.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 5.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, NAN, 1.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 5.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+}
+
+static void test_assign4ss(void)
+{
+    lmnt_value rvals[5];
+    const size_t rvals_count = sizeof(rvals)/sizeof(lmnt_value);
+    test_function_data fndata = { NULL, NULL };
+
+    archive a = create_archive_array("test", 1, 5, 6, 5, 0, 0,
+        LMNT_OP_BYTES(LMNT_OP_ASSIGNSS, 0x00, 0x00, 0x01),
+        LMNT_OP_BYTES(LMNT_OP_ASSIGNSS, 0x01, 0x00, 0x02),
+        LMNT_OP_BYTES(LMNT_OP_ASSIGNSS, 0x02, 0x00, 0x03),
+        LMNT_OP_BYTES(LMNT_OP_ASSIGNSS, 0x03, 0x00, 0x04),
+        LMNT_OP_BYTES(LMNT_OP_ASSIGNSS, 0x04, 0x00, 0x05)
+    );
+    TEST_LOAD_ARCHIVE(ctx, "test", a, fndata);
+    delete_archive_array(a);
+
+#if !defined(LMNT_NO_SUPERINSTRUCTIONS)
+    CU_ASSERT_EQUAL(get_prepared_opcode(ctx, fndata.def, 0), LMNT_OP_ASSIGN4SS);
+    CU_ASSERT_EQUAL(get_prepared_opcode(ctx, fndata.def, 4), LMNT_OP_ASSIGNSS);
+#endif
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 7.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, rvals_count), rvals_count);
+    for (size_t i = 0; i < rvals_count; ++i)
+        CU_ASSERT_DOUBLE_EQUAL(rvals[i], 7.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+}
+
+static void test_superinstruction_branch_target(void)
+{
+    lmnt_value rvals[1];
+    const size_t rvals_count = sizeof(rvals)/sizeof(lmnt_value);
+    test_function_data fndata = { NULL, NULL };
+
+    // branches into the middle of a fused group must only execute the remainder of it
+    archive a = create_archive_array("test", 2, 1, 4, 4, 0, 0,
+        LMNT_OP_BYTES(LMNT_OP_ASSIGNIBS, 0x0000, 0x4000, 0x03), // 2
+        LMNT_OP_BYTES(LMNT_OP_BRANCH,    0x00, 0x03, 0x00),
+        LMNT_OP_BYTES(LMNT_OP_MULSS,     0x00, 0x01, 0x03),
+        LMNT_OP_BYTES(LMNT_OP_ADDSS,     0x03, 0x01, 0x02)
+    );
+    TEST_LOAD_ARCHIVE(ctx, "test", a, fndata);
+    delete_archive_array(a);
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 5.0f, 3.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 5.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+}
+
+static void test_superinstruction_validation(void)
+{
+    test_function_data fndata = { NULL, NULL };
+
+    // superinstruction not followed by the rest of its group
+    archive a = create_archive_array("test", 3, 1, 5, 2, 0, 0,
+        LMNT_OP_BYTES(LMNT_OP_FMASS, 0x00, 0x01, 0x04),
+        LMNT_OP_BYTES(LMNT_OP_SUBSS, 0x04, 0x02, 0x03)
+    );
+    TEST_LOAD_ARCHIVE_FAILS_VALIDATION(ctx, "test", a, fndata, LMNT_ERROR_INVALID_ARCHIVE, LMNT_VERROR_BAD_INSTRUCTION);
+    delete_archive_array(a);
+
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+
+
+    // group runs off the end of the code
+    a = create_archive_array("test", 2, 1, 3, 1, 0, 0,
+        LMNT_OP_BYTES(LMNT_OP_CMPBRCEQ, 0x00, 0x01, 0x00)
+    );
+    TEST_LOAD_ARCHIVE_FAILS_VALIDATION(ctx, "test", a, fndata, LMNT_ERROR_INVALID_ARCHIVE, LMNT_VERROR_BAD_INSTRUCTION);
+    delete_archive_array(a);
+
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+
+
+    // a well-formed pre-fused group is accepted as-is
+    a = create_archive_array("test", 3, 1, 5, 2, 0, 0,
+        LMNT_OP_BYTES(LMNT_OP_FMASS, 0x00, 0x01, 0x04),
+        LMNT_OP_BYTES(LMNT_OP_ADDSS, 0x04, 0x02, 0x03)
+    );
+    TEST_LOAD_ARCHIVE(ctx, "test", a, fndata);
+    delete_archive_array(a);
+
+    lmnt_value rvals[1];
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 2.0f, 3.0f, 4.0f);
+    CU_ASSERT_EQUAL(TEST_EXECUTE(ctx, fndata, rvals, 1), 1);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 10.0, FLOAT_ERROR_MARGIN);
+
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+}
+
+
+MAKE_REGISTER_SUITE_FUNCTION(superinstructions,
+    CUNIT_CI_TEST(test_fmass),
+    CUNIT_CI_TEST(test_cmpbr),
+    CUNIT_CI_TEST(test_assign4ss),
+    CUNIT_CI_TEST(test_superinstruction_branch_target),
+    CUNIT_CI_TEST(test_superinstruction_validation)
+);
@@ -0,0 +1,102 @@
+#include "CUnit/CUnitCI.h"
+#include "lmnt/interpreter.h"
+#include "lmnt/tier.h"
+#include "testhelpers.h"
+#include <stdio.h>
+#include <stdbool.h>
+
+#if !defined(TESTSETUP_INCLUDED)
+#error "This file cannot be included without a testsetup header already having been included"
+#endif
+
+
+static void test_tier_threshold(void)
+{
+    lmnt_value rvals[1];
+    const size_t rvals_count = sizeof(rvals)/sizeof(lmnt_value);
+    test_function_data fndata = { NULL, NULL };
+
+    archive a = create_archive_array("test", 2, 1, 3, 1, 0, 0,
+        LMNT_OP_BYTES(LMNT_OP_ADDSS, 0x00, 0x01, 0x02)
+    );
+    TEST_LOAD_ARCHIVE(ctx, "test", a, fndata);
+    delete_archive_array(a);
+
+    lmnt_tier* tier = NULL;
+    CU_ASSERT_EQUAL_FATAL(lmnt_tier_create(ctx, LMNT_JIT_TARGET_NATIVE, 3, &tier), LMNT_OK);
+
+    // the first couple of executions are interpreted and don't queue anything
+    for (int i = 0; i < 2; ++i) {
+        TEST_UPDATE_ARGS(ctx, fndata, 0, (lmnt_value)i, 2.0f);
+        CU_ASSERT_EQUAL(lmnt_tier_execute(tier, ctx, fndata.def, rvals, rvals_count), rvals_count);
+        CU_ASSERT_DOUBLE_EQUAL(rvals[0], i + 2.0, FLOAT_ERROR_MARGIN);
+    }
+    lmnt_tier_flush(tier);
+    CU_ASSERT_FALSE(lmnt_tier_is_compiled(tier, ctx, fndata.def));
+
+    // the next one crosses the threshold, so once the compile thread is done we should be running natively
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 3.0f, 4.0f);
+    CU_ASSERT_EQUAL(lmnt_tier_execute(tier, ctx, fndata.def, rvals, rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 7.0, FLOAT_ERROR_MARGIN);
+    lmnt_tier_flush(tier);
+    CU_ASSERT_TRUE(lmnt_tier_is_compiled(tier, ctx, fndata.def));
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 5.0f, 6.0f);
+    CU_ASSERT_EQUAL(lmnt_tier_execute(tier, ctx, fndata.def, rvals, rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 11.0, FLOAT_ERROR_MARGIN);
+
+    lmnt_tier_delete(tier);
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+}
+
+static void test_tier_shared(void)
+{
+    lmnt_value rvals[1];
+    const size_t rvals_count = sizeof(rvals)/sizeof(lmnt_value);
+    test_function_data fndata = { NULL, NULL };
+
+    archive a = create_archive_array("test", 2, 1, 3, 1, 0, 0,
+        LMNT_OP_BYTES(LMNT_OP_MULSS, 0x00, 0x01, 0x02)
+    );
+    TEST_LOAD_ARCHIVE(ctx, "test", a, fndata);
+
+    // a second context with the same archive can share the tier and its compiled functions
+    lmnt_ictx* other = create_interpreter();
+    CU_ASSERT_PTR_NOT_NULL_FATAL(other);
+    CU_ASSERT_EQUAL_FATAL(lmnt_load_archive(other, a.buf, a.size), LMNT_OK);
+    CU_ASSERT_EQUAL_FATAL(lmnt_prepare_archive(other, NULL), LMNT_OK);
+    const lmnt_def* other_def = NULL;
+    CU_ASSERT_EQUAL_FATAL(lmnt_find_def(other, "test", &other_def), LMNT_OK);
+    delete_archive_array(a);
+
+    lmnt_tier* tier = NULL;
+    CU_ASSERT_EQUAL_FATAL(lmnt_tier_create(ctx, LMNT_JIT_TARGET_NATIVE, 0, &tier), LMNT_OK);
+
+    TEST_UPDATE_ARGS(ctx, fndata, 0, 3.0f, 4.0f);
+    CU_ASSERT_EQUAL(lmnt_tier_execute(tier, ctx, fndata.def, rvals, rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 12.0, FLOAT_ERROR_MARGIN);
+    lmnt_tier_flush(tier);
+    CU_ASSERT_TRUE(lmnt_tier_is_compiled(tier, other, other_def));
+
+    const lmnt_value args[] = { 5.0f, 6.0f };
+    CU_ASSERT_EQUAL(lmnt_update_args(other, other_def, 0, args, 2), LMNT_OK);
+    CU_ASSERT_EQUAL(lmnt_tier_execute(tier, other, other_def, rvals, rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 30.0, FLOAT_ERROR_MARGIN);
+
+    // the original context is unaffected by the other one's execution
+    CU_ASSERT_EQUAL(lmnt_tier_execute(tier, ctx, fndata.def, rvals, rvals_count), rvals_count);
+    CU_ASSERT_DOUBLE_EQUAL(rvals[0], 12.0, FLOAT_ERROR_MARGIN);
+
+    // defs from some other archive aren't accepted
+    CU_ASSERT_EQUAL(lmnt_tier_execute(tier, ctx, other_def, rvals, rvals_count), LMNT_ERROR_DEF_MISMATCH);
+
+    lmnt_tier_delete(tier);
+    delete_interpreter(other);
+    TEST_UNLOAD_ARCHIVE(ctx, a, fndata);
+}
+
+
+MAKE_REGISTER_SUITE_FUNCTION(tier,
+    CUNIT_CI_TEST(test_tier_threshold),
+    CUNIT_CI_TEST(test_tier_shared)
+);
@@ -38,6 +38,14 @@
 #define TEST_EXECUTE(ctx, fndata, rvals, rvals_count) \
     lmnt_execute(ctx, (fndata).def, (rvals), (lmnt_offset)(rvals_count))
 
+#undef  TEST_EXECUTE_BUDGETED
+#define TEST_EXECUTE_BUDGETED(ctx, fndata, rvals, rvals_count, budget) \
+    lmnt_execute_budgeted(ctx, (fndata).def, (rvals), (lmnt_offset)(rvals_count), (budget))
+
+#undef  TEST_RESUME_BUDGETED
+#define TEST_RESUME_BUDGETED(ctx, fndata, rvals, rvals_count, budget) \
+    lmnt_resume_budgeted(ctx, (fndata).def, (rvals), (lmnt_offset)(rvals_count), (budget))
+
 CU_TEST_SETUP()
 {
     ctx = create_interpreter();
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "CUnit/CUnitCI.h"
+#include "lmnt/interpreter.h"
+#include "testhelpers.h"
+
+#define TESTSETUP_INCLUDED
+
+#undef  TEST_NAME_PREFIX
+#define TEST_NAME_PREFIX "interpreter_threaded_"
+
+#undef  TEST_NAME_SUFFIX
+#define TEST_NAME_SUFFIX ""
+
+#undef  TEST_LOAD_ARCHIVE
+#define TEST_LOAD_ARCHIVE(ctx, name, a, fndata) \
+    CU_ASSERT_EQUAL_FATAL(lmnt_load_archive((ctx), (a).buf, (a).size), LMNT_OK);\
+    {\
+        lmnt_validation_result vr;\
+        CU_ASSERT_EQUAL_FATAL(lmnt_prepare_archive((ctx), &vr), LMNT_OK);\
+        CU_ASSERT_EQUAL_FATAL(vr, LMNT_VALIDATION_OK);\
+    }\
+    CU_ASSERT_EQUAL_FATAL(lmnt_find_def((ctx), (name), &((fndata).def)), LMNT_OK);\
+    {\
+        size_t tsize = 0;\
+        CU_ASSERT_EQUAL_FATAL(lmnt_get_threaded_code_size((ctx), &tsize), LMNT_OK);\
+        (fndata).data = malloc(tsize);\
+        CU_ASSERT_EQUAL_FATAL(lmnt_prepare_threaded_code((ctx), (fndata).data, tsize), LMNT_OK);\
+    }
+
+#undef  TEST_LOAD_ARCHIVE_FAILS_VALIDATION
+#define TEST_LOAD_ARCHIVE_FAILS_VALIDATION(ctx, name, a, fndata, code, vcode) \
+    CU_ASSERT_EQUAL_FATAL(lmnt_load_archive((ctx), (a).buf, (a).size), LMNT_OK);\
+    {\
+        lmnt_validation_result vr;\
+        CU_ASSERT_EQUAL_FATAL(lmnt_prepare_archive((ctx), &vr), (code));\
+        CU_ASSERT_EQUAL_FATAL(vr, (vcode));\
+    }
+
+#undef  TEST_UNLOAD_ARCHIVE
+#define TEST_UNLOAD_ARCHIVE(ctx, a, fndata) \
+    if ((fndata).data) {\
+        free((fndata).data);\
+        (fndata).data = NULL;\
+    }
+
+#undef  TEST_EXECUTE
+#define TEST_EXECUTE(ctx, fndata, rvals, rvals_count) \
+    lmnt_execute(ctx, (fndata).def, (rvals), (lmnt_offset)(rvals_count))
+
+#undef  TEST_EXECUTE_BUDGETED
+#define TEST_EXECUTE_BUDGETED(ctx, fndata, rvals, rvals_count, budget) \
+    lmnt_execute_budgeted(ctx, (fndata).def, (rvals), (lmnt_offset)(rvals_count), (budget))
+
+#undef  TEST_RESUME_BUDGETED
+#define TEST_RESUME_BUDGETED(ctx, fndata, rvals, rvals_count, budget) \
+    lmnt_resume_budgeted(ctx, (fndata).def, (rvals), (lmnt_offset)(rvals_count), (budget))
+
+CU_TEST_SETUP()
+{
+    ctx = create_interpreter();
+}
+
+CU_TEST_TEARDOWN()
+{
+    delete_interpreter(ctx);
+    ctx = NULL;
+}
@@ -47,6 +47,14 @@
 #define TEST_EXECUTE(ctx, fndata, rvals, rvals_count) \
     lmnt_jit_execute(ctx, (lmnt_jit_fn_data*)((fndata).data), (rvals), (lmnt_offset)(rvals_count))
 
+#undef  TEST_EXECUTE_BUDGETED
+#define TEST_EXECUTE_BUDGETED(ctx, fndata, rvals, rvals_count, budget) \
+    lmnt_jit_execute_budgeted(ctx, (lmnt_jit_fn_data*)((fndata).data), (rvals), (lmnt_offset)(rvals_count), (budget))
+
+#undef  TEST_RESUME_BUDGETED
+#define TEST_RESUME_BUDGETED(ctx, fndata, rvals, rvals_count, budget) \
+    lmnt_jit_resume_budgeted(ctx, (lmnt_jit_fn_data*)((fndata).data), (rvals), (lmnt_offset)(rvals_count), (budget))
+
 CU_TEST_SETUP()
 {
     ctx = create_interpreter();
@@ -159,7 +159,7 @@ int main(int argc, char** argv)
     assert(ir == LMNT_OK);
 
     lmnt_extcall_info extcalls[] = {
-        { "double", 1, 1, double_a_thing },
+        { "double", 1, 1, double_a_thing, LMNT_EXTCALL_NONE, NULL },
     };
     lmnt_result xr = lmnt_extcalls_set(&ctx, extcalls, 1);
     assert(xr == LMNT_OK);
@@ -205,6 +205,7 @@ int main(int argc, char** argv)
     LMNT_PRINTF("         Accesses unaligned: %zu\n", stats.reg_unaligned);
     LMNT_PRINTF("   Total register evictions: %zu\n", stats.reg_evicted);
     LMNT_PRINTF(" Evictions requiring writes: %zu\n", stats.reg_evicted_written);
+    LMNT_PRINTF("    Instruction set level: %d\n", (int)stats.isa);
     LMNT_PRINTF("\n");
     int c = 0;
     while (c != 'q' && c != 'Q' && c != EOF)
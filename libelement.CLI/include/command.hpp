@@ -17,6 +17,7 @@ enum class Target {
     Interpreter,
     LMNT,
     LMNTJit,
+    C,
 };
 
 struct common_command_arguments
@@ -34,6 +35,7 @@ struct common_command_arguments
         { "interpreter", Target::Interpreter },
         { "lmnt", Target::LMNT },
         { "lmnt-jit", Target::LMNTJit },
+        { "c", Target::C },
     };
 
     [[nodiscard]] std::string as_string() const
@@ -105,6 +107,7 @@ class command
 protected:
     common_command_arguments common_arguments;
     element_interpreter_ctx* context;
+    bool owns_context = true;
 
 public:
     explicit command(common_command_arguments common_arguments)
@@ -113,7 +116,19 @@ public:
         element_interpreter_create(&context);
     }
 
-    virtual ~command() { element_interpreter_delete(&context); }
+    // runs against a context which has already been set up by someone else, e.g. the serve command
+    command(common_command_arguments common_arguments, element_interpreter_ctx* shared_context)
+        : common_arguments{ std::move(common_arguments) }
+        , context{ shared_context }
+        , owns_context{ false }
+    {
+    }
+
+    virtual ~command()
+    {
+        if (owns_context)
+            element_interpreter_delete(&context);
+    }
 
     // remove copy/move to be certain no implcit conversion is happening
     command(const command& other) = delete;
@@ -182,9 +197,33 @@ public:
         element_interpreter_set_log_callback(context, log_callback, user_data);
     }
 
+    void set_compilation_stats_enabled(bool enabled) const
+    {
+        element_interpreter_set_compilation_stats_enabled(context, enabled);
+    }
+
+    [[nodiscard]] std::string get_compilation_stats_json() const
+    {
+        size_t size = 0;
+        if (element_interpreter_get_compilation_stats_json(context, nullptr, &size) != ELEMENT_OK)
+            return {};
+
+        std::string json(size, '\0');
+        if (element_interpreter_get_compilation_stats_json(context, json.data(), &size) != ELEMENT_OK)
+            return {};
+
+        // drop the null terminator
+        json.resize(size - 1);
+        return json;
+    }
+
 protected:
     [[nodiscard]] element_result setup(const compilation_input& input) const
     {
+        // a shared context already has everything loaded
+        if (!owns_context)
+            return ELEMENT_OK;
+
         element_result result = ELEMENT_OK;
         if (!input.get_no_prelude()) {
             result = element_interpreter_load_prelude(context);
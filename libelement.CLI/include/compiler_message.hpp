@@ -47,11 +47,15 @@ class compiler_message
     static constexpr const char* const key_message_level{ "MessageLevel" };
     static constexpr const char* const key_context{ "Context" };
     static constexpr const char* const key_trace_stack{ "TraceStack" };
+    static constexpr const char* const key_stats{ "Stats" };
+    static constexpr const char* const key_messages{ "Messages" };
 
     std::optional<element_result> type;
     std::optional<message_level> level;
     std::string context;
     std::vector<trace_site> trace_stack;
+    std::optional<std::string> stats;
+    std::vector<std::string> messages;
     bool serialize_to_json = false;
 
     // this is nasty, static initialisation that performs file reading, reconsider
@@ -87,7 +91,15 @@ public:
         // TODO: set trace_stack based on expression_cache frame list?
     }
 
+    // compilation statistics as a JSON object, only included when serializing to JSON
+    void set_stats(std::string stats_json) { stats = std::move(stats_json); }
+    // messages logged while producing this one, each a serialized JSON compiler_message, only included when serializing to JSON
+    void set_messages(std::vector<std::string> messages_json) { messages = std::move(messages_json); }
+
     [[nodiscard]] message_level get_level() const;
     [[nodiscard]] std::string serialize() const;
 };
+
+// formats a log message from libelement, along with the source it refers to, for display
+[[nodiscard]] std::string format_log_message(const element_log_message* msg);
 } // namespace libelement::cli
\ No newline at end of file
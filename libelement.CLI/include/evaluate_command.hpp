@@ -38,6 +38,13 @@ public:
         , custom_arguments{ std::move(custom_arguments) }
     {}
 
+    evaluate_command(common_command_arguments common_arguments,
+        evaluate_command_arguments custom_arguments,
+        element_interpreter_ctx* shared_context)
+        : command(std::move(common_arguments), shared_context)
+        , custom_arguments{ std::move(custom_arguments) }
+    {}
+
     [[nodiscard]] compiler_message execute(const compilation_input& compilation_input) const override
     {
         const auto result = setup(compilation_input);
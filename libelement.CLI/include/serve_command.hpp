@@ -0,0 +1,296 @@
+#pragma once
+
+#include <iostream>
+#include <optional>
+#include <string>
+
+#include <rapidjson/document.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <cerrno>
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+    #define ELEMENT_CLI_HAS_UNIX_SOCKETS
+#endif
+
+#include "command.hpp"
+#include "compile_command.hpp"
+#include "evaluate_command.hpp"
+#include "typeof_command.hpp"
+
+namespace libelement::cli
+{
+struct serve_command_arguments
+{
+    std::string socket_path;
+
+    [[nodiscard]] std::string as_string() const
+    {
+        std::stringstream ss;
+        ss << "serve";
+        if (!socket_path.empty())
+            ss << " --socket \"" << socket_path << "\"";
+        return ss.str();
+    }
+};
+
+// Keeps one context with the prelude and packages loaded, and answers newline-delimited JSON requests against it.
+// Each request is one object with a "command" of "evaluate", "compile", "typeof" or "shutdown", plus that command's arguments:
+//   {"command": "evaluate", "expression": "Num.add", "arguments": "(1, 2)", "interpreted": false, "target": "interpreter"}
+//   {"command": "compile", "name": "f", "parameters": "(a:Num)", "return_type": "Num", "expression": "a.mul(2)", "output_path": "f.lmnt"}
+//   {"command": "typeof", "expression": "Num.add"}
+// Each response is a single line of compiler_message JSON, with anything logged while handling the request in its "Messages".
+// Any other output produced while handling a request goes to stderr.
+// Requests share the one context. The only thing undone after a request is the function a compile request declares,
+// anything else left behind, such as cached lookups and instructions, stays in the context for later requests.
+class serve_command final : public command
+{
+    serve_command_arguments custom_arguments;
+
+public:
+    serve_command(common_command_arguments common_arguments,
+        serve_command_arguments custom_arguments)
+        : command(std::move(common_arguments))
+        , custom_arguments{ std::move(custom_arguments) }
+    {}
+
+    [[nodiscard]] compiler_message execute(const compilation_input& compilation_input) const override
+    {
+        const auto result = setup(compilation_input);
+        if (result != ELEMENT_OK)
+            return compiler_message(error_conversion(result),
+                "Failed to setup context",
+                compilation_input.get_log_json());
+
+        if (!custom_arguments.socket_path.empty())
+            return serve_socket(compilation_input);
+
+        std::string line;
+        bool shutdown = false;
+        while (!shutdown && std::getline(std::cin, line)) {
+            if (line.empty())
+                continue;
+
+            const auto response = handle_request(line, shutdown);
+            std::cout << response.serialize() << std::endl;
+        }
+
+        return compiler_message("Server stopped", compilation_input.get_log_json());
+    }
+
+    [[nodiscard]] std::string as_string() const override
+    {
+        std::stringstream ss;
+        ss << custom_arguments.as_string() << " " << common_arguments.as_string();
+        return ss.str();
+    }
+
+    static void configure(CLI::App& app,
+        const std::shared_ptr<common_command_arguments>& common_arguments,
+        callback callback)
+    {
+        const auto arguments = std::make_shared<serve_command_arguments>();
+
+        auto* command = app.add_subcommand("serve", "Keep packages loaded and answer newline-delimited JSON requests.")->fallthrough();
+
+        command->add_option("-s,--socket", arguments->socket_path,
+            "Unix socket to listen on. If not given, requests are read from stdin.");
+
+        command->callback([callback, common_arguments, arguments]() {
+            serve_command cmd(*common_arguments, *arguments);
+            callback(cmd);
+        });
+    }
+
+private:
+    static std::string get_string(const rapidjson::Value& request, const char* key)
+    {
+        const auto it = request.FindMember(key);
+        if (it == request.MemberEnd() || !it->value.IsString())
+            return {};
+        return it->value.GetString();
+    }
+
+    static void collect_log_message(const element_log_message* msg, void* user_data)
+    {
+        auto& messages = *static_cast<std::vector<std::string>*>(user_data);
+        messages.push_back(compiler_message(msg->message_code, format_log_message(msg), true).serialize());
+        if (msg->related_log_message)
+            collect_log_message(msg->related_log_message, user_data);
+    }
+
+    // sends stdout to stderr and collects log messages for as long as a request is being handled, even if a command throws
+    struct request_scope
+    {
+        const serve_command& server;
+        std::streambuf* const stdout_buffer;
+
+        request_scope(const serve_command& server, std::vector<std::string>& messages)
+            : server{ server }
+            , stdout_buffer{ std::cout.rdbuf(std::cerr.rdbuf()) }
+        {
+            server.set_log_callback(collect_log_message, &messages);
+        }
+
+        request_scope(const request_scope&) = delete;
+        request_scope& operator=(const request_scope&) = delete;
+
+        ~request_scope()
+        {
+            server.set_log_callback(nullptr, nullptr);
+            std::cout.rdbuf(stdout_buffer);
+        }
+    };
+
+    [[nodiscard]] compiler_message handle_request(const std::string& line, bool& shutdown) const
+    {
+        rapidjson::Document request;
+        request.Parse(line.c_str());
+        if (request.HasParseError() || !request.IsObject())
+            return compiler_message(ELEMENT_ERROR_UNKNOWN, "Invalid request: " + line, true);
+
+        // every request gets its own arguments, with responses always as JSON
+        auto arguments = common_arguments;
+        arguments.log_json = true;
+
+        const auto interpreted = request.FindMember("interpreted");
+        if (interpreted != request.MemberEnd() && interpreted->value.IsBool())
+            arguments.compiletime = interpreted->value.GetBool();
+
+        const auto target = get_string(request, "target");
+        if (!target.empty()) {
+            const auto it = arguments.target_mapping.find(target);
+            if (it == arguments.target_mapping.end())
+                return compiler_message(ELEMENT_ERROR_UNKNOWN, "Unknown target: " + target, true);
+            arguments.target = it->second;
+        }
+
+        const auto command_name = get_string(request, "command");
+        const compilation_input input(arguments);
+
+        // output from the commands themselves would otherwise be interleaved with the responses
+        std::optional<compiler_message> response;
+        std::vector<std::string> messages;
+        {
+            const request_scope scope(*this, messages);
+
+            if (command_name == "evaluate") {
+                evaluate_command_arguments evaluate_arguments;
+                evaluate_arguments.expression = get_string(request, "expression");
+                evaluate_arguments.arguments = get_string(request, "arguments");
+                response = evaluate_command(arguments, std::move(evaluate_arguments), context).execute(input);
+            } else if (command_name == "typeof") {
+                typeof_command_arguments typeof_arguments;
+                typeof_arguments.expression = get_string(request, "expression");
+                response = typeof_command(arguments, std::move(typeof_arguments), context).execute(input);
+            } else if (command_name == "compile") {
+                compile_command_arguments compile_arguments;
+                compile_arguments.name = get_string(request, "name");
+                compile_arguments.parameters = get_string(request, "parameters");
+                compile_arguments.return_type = get_string(request, "return_type");
+                compile_arguments.expression = get_string(request, "expression");
+                compile_arguments.output_path = get_string(request, "output_path");
+                const auto jobs = request.FindMember("jobs");
+                if (jobs != request.MemberEnd() && jobs->value.IsUint())
+                    compile_arguments.jobs = jobs->value.GetUint();
+
+                // the function being compiled is only for this request, so don't leave it behind
+                element_declaration* existing = nullptr;
+                const bool declared_already = element_interpreter_find(context, compile_arguments.name.c_str(), &existing) == ELEMENT_OK;
+                element_declaration_delete(&existing);
+
+                const auto name = compile_arguments.name;
+                response = compile_command(arguments, std::move(compile_arguments), context).execute(input);
+                if (!declared_already)
+                    element_interpreter_remove(context, name.c_str());
+            } else if (command_name == "shutdown") {
+                shutdown = true;
+                response = compiler_message("Shutting down", true);
+            } else {
+                response = compiler_message(ELEMENT_ERROR_UNKNOWN, "Unknown command: " + command_name, true);
+            }
+        }
+
+        response->set_messages(std::move(messages));
+        return *response;
+    }
+
+    [[nodiscard]] compiler_message serve_socket(const compilation_input& compilation_input) const
+    {
+#if defined(ELEMENT_CLI_HAS_UNIX_SOCKETS)
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (custom_arguments.socket_path.size() >= sizeof(address.sun_path))
+            return compiler_message(ELEMENT_ERROR_UNKNOWN, "Socket path is too long: " + custom_arguments.socket_path, compilation_input.get_log_json());
+        custom_arguments.socket_path.copy(address.sun_path, custom_arguments.socket_path.size());
+
+        const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listener < 0)
+            return compiler_message(ELEMENT_ERROR_UNKNOWN, "Failed to create socket", compilation_input.get_log_json());
+
+        unlink(custom_arguments.socket_path.c_str());
+        if (bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 1) != 0) {
+            close(listener);
+            return compiler_message(ELEMENT_ERROR_UNKNOWN, "Failed to listen on " + custom_arguments.socket_path, compilation_input.get_log_json());
+        }
+
+        // a client disconnecting mid-response must only lose us that client, rather than SIGPIPE taking down the server
+#if defined(MSG_NOSIGNAL)
+        constexpr int send_flags = MSG_NOSIGNAL;
+#else
+        constexpr int send_flags = 0;
+#endif
+
+        // clients are served one at a time, each sending any number of requests before disconnecting
+        bool shutdown = false;
+        while (!shutdown) {
+            const int connection = accept(listener, nullptr, nullptr);
+            if (connection < 0)
+                break;
+#if defined(SO_NOSIGPIPE)
+            const int no_sigpipe = 1;
+            setsockopt(connection, SOL_SOCKET, SO_NOSIGPIPE, &no_sigpipe, sizeof(no_sigpipe));
+#endif
+
+            std::string pending;
+            char buffer[4096];
+            ssize_t received = 0;
+            bool connected = true;
+            while (connected && !shutdown && (received = recv(connection, buffer, sizeof(buffer), 0)) > 0) {
+                pending.append(buffer, static_cast<size_t>(received));
+
+                size_t end = 0;
+                while (connected && !shutdown && (end = pending.find('\n')) != std::string::npos) {
+                    const auto line = pending.substr(0, end);
+                    pending.erase(0, end + 1);
+                    if (line.empty())
+                        continue;
+
+                    const auto response = handle_request(line, shutdown).serialize() + "\n";
+                    for (size_t sent = 0; sent < response.size();) {
+                        const auto count = send(connection, response.data() + sent, response.size() - sent, send_flags);
+                        if (count < 0 && errno == EINTR)
+                            continue;
+                        // EPIPE or anything else means the client's gone, so drop it and wait for the next one
+                        if (count <= 0) {
+                            connected = false;
+                            break;
+                        }
+                        sent += static_cast<size_t>(count);
+                    }
+                }
+            }
+
+            close(connection);
+        }
+
+        close(listener);
+        unlink(custom_arguments.socket_path.c_str());
+        return compiler_message("Server stopped", compilation_input.get_log_json());
+#else
+        return compiler_message(ELEMENT_ERROR_UNKNOWN, "Unix sockets are not supported on this platform, serve from stdin instead", compilation_input.get_log_json());
+#endif
+    }
+};
+} // namespace libelement::cli
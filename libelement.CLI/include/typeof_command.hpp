@@ -30,6 +30,14 @@ public:
               custom_arguments) }
     {}
 
+    typeof_command(common_command_arguments common_arguments,
+        typeof_command_arguments custom_arguments,
+        element_interpreter_ctx* shared_context)
+        : command(std::move(common_arguments), shared_context)
+        , custom_arguments{ std::move(
+              custom_arguments) }
+    {}
+
     [[nodiscard]] compiler_message
     execute(const compilation_input& compilation_input) const override
     {
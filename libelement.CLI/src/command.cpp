@@ -6,6 +6,7 @@
 #include "evaluate_command.hpp"
 #include "parse_command.hpp"
 #include "typeof_command.hpp"
+#include "serve_command.hpp"
 
 using namespace libelement::cli;
 
@@ -25,15 +26,15 @@ void command::configure(CLI::App& app, command::callback callback)
     app.add_option("--verbosity", arguments->verbosity,
         "--NOT IMPLEMENTED-- Verbosity of compiler messages.");
     app.add_flag("--logjson", arguments->log_json,
-        "--NOT IMPLEMENTED-- Serializes log messages structured as Json "
-        "instead of plain string.");
-    app.add_flag("--no-parse-trace", arguments->log_json,
+        "Serializes log messages structured as Json instead of plain "
+        "string, with compilation statistics included in the result.");
+    app.add_flag("--no-parse-trace", arguments->no_parse_trace,
         "--NOT IMPLEMENTED-- Controls whether or not to display the "
         "parse trace if parsing fails.");
     app.add_flag("--interpreted", arguments->compiletime,
         "");
     app.add_option("--target", arguments->target,
-           "Target to execute. default is 'interpreter'. must be one of 'interpreter', 'lmnt', or 'lmnt-jit'")
+           "Target to execute. default is 'interpreter'. must be one of 'interpreter', 'lmnt', 'lmnt-jit', or 'c' (compile only)")
         ->transform(CLI::CheckedTransformer(arguments->target_mapping, CLI::ignore_case));
 
     // not a big fan of this but it works, so leaving it for now
@@ -42,4 +43,5 @@ void command::configure(CLI::App& app, command::callback callback)
     compile_command::configure(app, arguments, callback);
     declaration_command::configure(app, arguments, callback);
     typeof_command::configure(app, arguments, callback);
+    serve_command::configure(app, arguments, callback);
 }
@@ -1,3 +1,5 @@
+#include <fmt/format.h>
+
 #include "rapidjson/stringbuffer.h"
 #include "rapidjson/writer.h"
 
@@ -37,6 +39,17 @@ std::string compiler_message::serialize() const
             writer.String(stack_item.get_message().c_str());
         }
         writer.EndArray();
+        if (stats.has_value()) {
+            writer.String(key_stats);
+            writer.RawValue(stats->c_str(), stats->size(), rapidjson::kObjectType);
+        }
+        if (!messages.empty()) {
+            writer.String(key_messages);
+            writer.StartArray();
+            for (const auto& message : messages)
+                writer.RawValue(message.c_str(), message.size(), rapidjson::kObjectType);
+            writer.EndArray();
+        }
         writer.EndObject();
 
         return buffer.GetString();
@@ -44,3 +57,24 @@ std::string compiler_message::serialize() const
 
     return context + "\n";
 }
+
+std::string libelement::cli::format_log_message(const element_log_message* const msg)
+{
+    std::string formatted_error = fmt::format("ELE {} ------------- {}\n{}\n\n",
+        msg->message_code,
+        msg->filename ? msg->filename : "<no filename>",
+        msg->message ? msg->message : "<no message>");
+
+    if (msg->line > 0) {
+        formatted_error += fmt::format("{}|{}\n", msg->line, msg->line_in_source ? msg->line_in_source : "<no source line>");
+
+        if (msg->character > 0) {
+            const auto digits = std::to_string(msg->line).size();
+            formatted_error += fmt::format("{}{}",
+                std::string(digits + msg->character, ' '),
+                std::string(msg->length, '^'));
+        }
+    }
+
+    return formatted_error;
+}
@@ -19,21 +19,7 @@ void log_callback(const element_log_message* const msg, void* user_data)
 {
     auto message_code = msg->message_code;
 
-    std::string formatted_error = fmt::format("ELE {} ------------- {}\n{}\n\n",
-        msg->message_code,
-        msg->filename ? msg->filename : "<no filename>",
-        msg->message ? msg->message : "<no message>");
-
-    if (msg->line > 0) {
-        formatted_error += fmt::format("{}|{}\n", msg->line, msg->line_in_source ? msg->line_in_source : "<no source line>");
-
-        if (msg->character > 0) {
-            const auto digits = std::to_string(msg->line).size();
-            formatted_error += fmt::format("{}{}",
-                std::string(digits + msg->character, ' '),
-                std::string(msg->length, '^'));
-        }
-    }
+    const auto formatted_error = format_log_message(msg);
 
     // todo: hack to force parse errors
     auto log = compiler_message(
@@ -72,8 +58,16 @@ void command_callback(command& command)
 
     // callback in case we need access to the command for some compiler_message
     // generation shenanigans
+    const auto log_json = command.get_common_arguments().log_json;
     const auto input = compilation_input(command.get_common_arguments());
-    const auto response = command.execute(input);
+    // json output is for tools, so also tell them where the compilation time went
+    if (log_json)
+        command.set_compilation_stats_enabled(true);
+
+    auto response = command.execute(input);
+    if (log_json)
+        response.set_stats(command.get_compilation_stats_json());
+
     std::cout << response.serialize() << std::endl;
     command.set_log_callback(nullptr, nullptr);
 }
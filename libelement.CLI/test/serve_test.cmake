@@ -0,0 +1,50 @@
+# Round-trips serve_requests.jsonl through "element_cli serve" on stdin and checks each response.
+# Expects ELEMENT_CLI and REQUESTS to be defined, and to be run from the directory containing element_cli's packages.
+
+execute_process(
+    COMMAND "${ELEMENT_CLI}" serve
+    INPUT_FILE "${REQUESTS}"
+    OUTPUT_VARIABLE output
+    ERROR_VARIABLE errors
+    RESULT_VARIABLE result
+    TIMEOUT 120)
+
+if (NOT result EQUAL 0)
+    message(FATAL_ERROR "element_cli serve exited with ${result}\n${output}\n${errors}")
+endif()
+
+string(REPLACE "\n" ";" lines "${output}")
+set(responses "")
+foreach (line IN LISTS lines)
+    if (line MATCHES "^{\"MessageTypePrefix\"")
+        list(APPEND responses "${line}")
+    endif()
+endforeach()
+
+# without --log-json only the responses to each request are JSON, so there's exactly one line per request
+list(LENGTH responses response_count)
+if (NOT response_count EQUAL 5)
+    message(FATAL_ERROR "Expected 5 responses, got ${response_count}\n${output}")
+endif()
+
+function(expect_response index text found description)
+    list(GET responses ${index} response)
+    string(FIND "${response}" "${text}" position)
+    if ((found AND position EQUAL -1) OR (NOT found AND NOT position EQUAL -1))
+        message(FATAL_ERROR "${description}, got:\n${response}")
+    endif()
+endfunction()
+
+expect_response(0 "\"Context\":\"3\"" TRUE "Expected Num.add(1, 2) to evaluate to 3")
+expect_response(0 "\"Messages\"" FALSE "Expected no messages from a successful evaluation")
+expect_response(1 "\"Messages\":[{" TRUE "Expected the failed evaluation's diagnostics in its response")
+expect_response(2 "\"MessageCode\"" FALSE "Expected the first compile to succeed")
+expect_response(3 "\"MessageCode\"" FALSE "Expected recompiling the same function in the same server to succeed")
+expect_response(4 "Shutting down" TRUE "Expected shutdown to be acknowledged")
+
+# anything logged should only have been reported inside a response
+foreach (line IN LISTS lines)
+    if (line MATCHES "^ELE [0-9]+ -------------")
+        message(FATAL_ERROR "Diagnostics were written outside of a response\n${output}")
+    endif()
+endforeach()
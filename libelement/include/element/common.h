@@ -96,6 +96,7 @@ typedef enum element_result {
     ELEMENT_ERROR_DIRECTORY_NOT_FOUND = -101,
     ELEMENT_ERROR_FILE_NOT_FOUND = -102,
     ELEMENT_ERROR_INVALID_FILE_TYPE = -103,
+    ELEMENT_ERROR_INVALID_SNAPSHOT = -104,
     ELEMENT_ERROR_ACCESSED_TOKEN_PAST_END = -200,
     ELEMENT_ERROR_EXCEPTION = -201,
     ELEMENT_ERROR_CONSTRAINT_HAS_BODY = -202,
@@ -156,6 +156,45 @@ ELEMENT_API element_result element_interpreter_load_packages(
 ELEMENT_API element_result element_interpreter_load_prelude(
     element_interpreter_ctx* interpreter);
 
+/**
+ * @brief saves everything the interpreter has loaded from files and packages as a snapshot, to be loaded again later
+ * without tokenising or parsing it
+ *
+ * Code loaded from strings isn't included.
+ *
+ * @param[in] interpreter       interpreter context
+ * @param[in] path              file to write the snapshot to
+ *
+ * @return ELEMENT_OK saved snapshot successfully
+ * @return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL interpreter pointer is null
+ * @return ELEMENT_ERROR_API_STRING_IS_NULL path is null
+ * @return ELEMENT_ERROR_FILE_NOT_FOUND a loaded file no longer exists
+ * @return ELEMENT_ERROR_INVALID_SNAPSHOT snapshot could not be written
+ */
+ELEMENT_API element_result element_interpreter_save_snapshot(
+    const element_interpreter_ctx* interpreter,
+    const char* path);
+
+/**
+ * @brief loads a snapshot saved with element_interpreter_save_snapshot
+ *
+ * Files whose contents have changed since the snapshot was saved are loaded from source instead, as are files which
+ * have since been added to the snapshot's packages.
+ *
+ * @param[in] interpreter       interpreter context
+ * @param[in] path              snapshot file
+ *
+ * @return ELEMENT_OK loaded snapshot successfully
+ * @return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL interpreter pointer is null
+ * @return ELEMENT_ERROR_API_STRING_IS_NULL path is null
+ * @return ELEMENT_ERROR_FILE_NOT_FOUND snapshot cannot be found
+ * @return ELEMENT_ERROR_INVALID_SNAPSHOT snapshot is corrupt or from a different version of element
+ * @return ELEMENT_ERROR_PRELUDE_ALREADY_LOADED snapshot contains the prelude, which is already loaded
+ */
+ELEMENT_API element_result element_interpreter_load_snapshot(
+    element_interpreter_ctx* interpreter,
+    const char* path);
+
 /**
  * @brief clears interpreter context (CURRENTLY DOES NOTHING)
  *
@@ -194,6 +233,37 @@ ELEMENT_API element_result element_interpreter_set_parse_only(
     element_interpreter_ctx* interpreter,
     bool parse_only);
 
+/**
+ * @brief sets the maximum number of iterations a for loop may run for when evaluated at compile time
+ *
+ * loops which exceed this are reported as ELEMENT_ERROR_INFINITE_LOOP, defaults to 10000
+ *
+ * @param[in] interpreter           interpreter context
+ * @param[in] max_loop_iterations   maximum number of iterations
+ *
+ * @return ELEMENT_OK iteration limit set successfully
+ * @return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL interpreter pointer is null
+ */
+ELEMENT_API element_result element_interpreter_set_max_loop_iterations(
+    element_interpreter_ctx* interpreter,
+    size_t max_loop_iterations);
+
+/**
+ * @brief sets how many threads are used to tokenise and parse files when loading several at once, e.g. a package
+ *
+ * the object model is still built and merged one file at a time in load order, so the result doesn't depend on this.
+ * defaults to 1, which loads files one after another
+ *
+ * @param[in] interpreter           interpreter context
+ * @param[in] worker_count          number of threads, or 0 to use one per hardware thread
+ *
+ * @return ELEMENT_OK worker count set successfully
+ * @return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL interpreter pointer is null
+ */
+ELEMENT_API element_result element_interpreter_set_load_worker_count(
+    element_interpreter_ctx* interpreter,
+    size_t worker_count);
+
 /**
  * @brief element inputs structure
  */
@@ -293,6 +363,23 @@ ELEMENT_API element_result element_interpreter_find(
     const char* path,
     element_declaration** declaration);
 
+/**
+ * @brief removes a top-level declaration from the loaded element code, e.g. one which was only loaded temporarily
+ * if it was the last declaration from its source file, the source is released too
+ * nothing previously compiled from the declaration may be used afterwards
+ *
+ * @param[in] interpreter       interpreter context
+ * @param[in] name              declaration name
+ *
+ * @return ELEMENT_OK removed declaration successfully
+ * @return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL interpreter pointer is null
+ * @return ELEMENT_ERROR_API_STRING_IS_NULL declaration name is null
+ * @return ELEMENT_ERROR_IDENTIFIER_NOT_FOUND no top-level declaration has that name
+ */
+ELEMENT_API element_result element_interpreter_remove(
+    element_interpreter_ctx* interpreter,
+    const char* name);
+
 /**
  * @brief gets the name of a declaration
  *
@@ -382,6 +469,143 @@ ELEMENT_API element_result element_interpreter_compile_expression(
     const char* expression_string,
     element_instruction** instruction);
 
+/**
+ * @brief compiled expression cache statistics
+ */
+typedef struct element_expression_cache_stats
+{
+    //number of compilations which were found in the cache
+    size_t hits;
+    //number of compilations which had to compile the expression
+    size_t misses;
+    //number of expressions currently cached
+    size_t size;
+    //maximum number of expressions cached
+    size_t capacity;
+} element_expression_cache_stats;
+
+/**
+ * @brief sets how many compiled expressions the interpreter keeps, discarding the least recently used
+ *
+ * successfully compiled expressions are cached by their text and compiler options, until more source is loaded or the
+ * interpreter is cleared. defaults to 64, 0 disables the cache
+ *
+ * @param[in] interpreter       interpreter context
+ * @param[in] capacity          maximum number of cached expressions
+ *
+ * @return ELEMENT_OK capacity set successfully
+ * @return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL interpreter pointer is null
+ */
+ELEMENT_API element_result element_interpreter_set_expression_cache_capacity(
+    element_interpreter_ctx* interpreter,
+    size_t capacity);
+
+/**
+ * @brief gets statistics for the compiled expression cache
+ *
+ * @param[in] interpreter       interpreter context
+ * @param[out] stats            statistics
+ *
+ * @return ELEMENT_OK got statistics successfully
+ * @return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL interpreter pointer is null
+ * @return ELEMENT_ERROR_API_OUTPUT_IS_NULL stats pointer is null
+ */
+ELEMENT_API element_result element_interpreter_get_expression_cache_stats(
+    const element_interpreter_ctx* interpreter,
+    element_expression_cache_stats* stats);
+
+/**
+ * @brief time spent in each phase of compilation and counts of the work done, since instrumentation was last reset
+ *
+ * times are in nanoseconds. files tokenised and parsed on several threads at once sum their time across threads, and
+ * instruction_cache is also counted as part of compile
+ */
+typedef struct element_compilation_stats
+{
+    //tokenising loaded source
+    uint64_t tokenise_ns;
+    //parsing loaded source to ASTs
+    uint64_t parse_ns;
+    //building the object model from ASTs and merging it in to the global scope
+    uint64_t build_object_model_ns;
+    //compiling declarations and expressions to instruction trees, including expanding calls
+    uint64_t compile_ns;
+    //finding or creating instructions in the interpreter's instruction caches
+    uint64_t instruction_cache_ns;
+    //lowering instruction trees to LMNT when exporting
+    uint64_t lmnt_lowering_ns;
+
+    //number of function calls compiled
+    uint64_t calls;
+    //number of function calls whose result was reused from an identical call earlier in the same compilation
+    uint64_t memoised_calls;
+    //number of distinct instructions created
+    uint64_t instructions_created;
+    //number of instructions which were already in the instruction caches
+    uint64_t instruction_cache_hits;
+    //number of declarations looked up in a scope
+    uint64_t scope_lookups;
+    //number of scope lookups which were answered from the lookup caches
+    uint64_t scope_lookup_cache_hits;
+} element_compilation_stats;
+
+/**
+ * @brief enables or disables recording compilation statistics, which are disabled by default
+ *
+ * statistics already recorded are kept, use element_interpreter_reset_compilation_stats to clear them
+ *
+ * @param[in] interpreter       interpreter context
+ * @param[in] enabled           whether to record statistics
+ *
+ * @return ELEMENT_OK set successfully
+ * @return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL interpreter pointer is null
+ */
+ELEMENT_API element_result element_interpreter_set_compilation_stats_enabled(
+    element_interpreter_ctx* interpreter,
+    bool enabled);
+
+/**
+ * @brief clears all recorded compilation statistics
+ *
+ * @param[in] interpreter       interpreter context
+ *
+ * @return ELEMENT_OK cleared statistics successfully
+ * @return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL interpreter pointer is null
+ */
+ELEMENT_API element_result element_interpreter_reset_compilation_stats(
+    element_interpreter_ctx* interpreter);
+
+/**
+ * @brief gets the compilation statistics recorded so far
+ *
+ * @param[in] interpreter       interpreter context
+ * @param[out] stats            statistics
+ *
+ * @return ELEMENT_OK got statistics successfully
+ * @return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL interpreter pointer is null
+ * @return ELEMENT_ERROR_API_OUTPUT_IS_NULL stats pointer is null
+ */
+ELEMENT_API element_result element_interpreter_get_compilation_stats(
+    const element_interpreter_ctx* interpreter,
+    element_compilation_stats* stats);
+
+/**
+ * @brief gets the compilation statistics recorded so far as a null terminated JSON object
+ *
+ * @param[in] interpreter       interpreter context
+ * @param[out] buffer           output buffer, or null to only query the size
+ * @param[in,out] bufsize       size of the output buffer, set to the size of the JSON including the null terminator
+ *
+ * @return ELEMENT_OK got statistics successfully
+ * @return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL interpreter pointer is null
+ * @return ELEMENT_ERROR_API_OUTPUT_IS_NULL buffer size pointer is null
+ * @return ELEMENT_ERROR_API_INSUFFICIENT_BUFFER buffer size is too small
+ */
+ELEMENT_API element_result element_interpreter_get_compilation_stats_json(
+    const element_interpreter_ctx* interpreter,
+    char* buffer,
+    size_t* bufsize);
+
 typedef struct element_evaluator_ctx element_evaluator_ctx;
 
 ELEMENT_API element_result element_evaluator_create(
@@ -483,6 +707,10 @@ ELEMENT_API element_result element_interpreter_typeof_expression(
     int buffer_size);
 
 
+/**
+ * @brief compiles declarations and exports them as an LMNT archive, equivalent to
+ * element_interpreter_export_lmnt_parallel with a single worker
+ */
 ELEMENT_API element_result element_interpreter_export_lmnt(
     element_interpreter_ctx* context,
     const element_declaration** decls,
@@ -491,6 +719,154 @@ ELEMENT_API element_result element_interpreter_export_lmnt(
     char* buffer,
     size_t* bufsize);
 
+/**
+ * @brief compiles declarations and exports them as an LMNT archive, lowering functions to LMNT on multiple threads
+ *
+ * Declarations are compiled serially, as the interpreter context is not thread-safe. The resulting
+ * archive is identical regardless of the number of workers used.
+ *
+ * @param[in] context           interpreter context
+ * @param[in] decls             declarations to export
+ * @param[in] funcnames         names of the resulting LMNT defs, one per declaration
+ * @param[in] decls_count       number of declarations
+ * @param[in] worker_count      number of threads to use, or 0 to use the hardware concurrency
+ * @param[out] buffer           output buffer, or null to only query the archive size
+ * @param[in,out] bufsize       size of the output buffer, set to the size of the archive
+ *
+ * @return ELEMENT_OK exported archive successfully
+ * @return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL interpreter pointer is null
+ * @return ELEMENT_ERROR_API_DECLARATION_IS_NULL declarations or names pointer is null
+ * @return ELEMENT_ERROR_API_INVALID_INPUT no declarations were provided
+ * @return ELEMENT_ERROR_API_OUTPUT_IS_NULL buffer size pointer is null
+ * @return ELEMENT_ERROR_API_INSUFFICIENT_BUFFER buffer size is too small
+ */
+ELEMENT_API element_result element_interpreter_export_lmnt_parallel(
+    element_interpreter_ctx* context,
+    const element_declaration** decls,
+    const char** funcnames,
+    size_t decls_count,
+    size_t worker_count,
+    char* buffer,
+    size_t* bufsize);
+
+/**
+ * @brief LMNT archive allocated by libelement
+ */
+typedef struct element_lmnt_archive element_lmnt_archive;
+
+/**
+ * @brief compiles declarations and exports them as an LMNT archive allocated by libelement
+ *
+ * Equivalent to element_interpreter_export_lmnt_parallel, but the declarations are only compiled and lowered once,
+ * rather than once to query the archive size and again to fill the buffer.
+ *
+ * @param[in] context           interpreter context
+ * @param[in] decls             declarations to export
+ * @param[in] funcnames         names of the resulting LMNT defs, one per declaration
+ * @param[in] decls_count       number of declarations
+ * @param[in] worker_count      number of threads to use, or 0 to use the hardware concurrency
+ * @param[out] archive          resulting archive, to be deleted with element_lmnt_archive_delete
+ *
+ * @return ELEMENT_OK exported archive successfully
+ * @return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL interpreter pointer is null
+ * @return ELEMENT_ERROR_API_DECLARATION_IS_NULL declarations or names pointer is null
+ * @return ELEMENT_ERROR_API_INVALID_INPUT no declarations were provided
+ * @return ELEMENT_ERROR_API_OUTPUT_IS_NULL archive pointer is null
+ */
+ELEMENT_API element_result element_interpreter_export_lmnt_archive(
+    element_interpreter_ctx* context,
+    const element_declaration** decls,
+    const char** funcnames,
+    size_t decls_count,
+    size_t worker_count,
+    element_lmnt_archive** archive);
+
+/**
+ * @brief gets the contents of an archive, which remain valid until it's deleted
+ *
+ * @return ELEMENT_OK retrieved the contents successfully
+ * @return ELEMENT_ERROR_API_INVALID_INPUT archive pointer is null
+ * @return ELEMENT_ERROR_API_OUTPUT_IS_NULL data or size pointer is null
+ */
+ELEMENT_API element_result element_lmnt_archive_get_data(
+    const element_lmnt_archive* archive,
+    const char** data,
+    size_t* size);
+
+/**
+ * @brief deletes an archive, assigns nullptr
+ *
+ * @param[in,out] archive       archive to delete
+ */
+ELEMENT_API void element_lmnt_archive_delete(
+    element_lmnt_archive** archive);
+
+/**
+ * @brief compiles declarations with the same inputs and exports them as an LMNT archive with a single fused def
+ *
+ * The fused def takes the declarations' shared inputs and returns all of their outputs, concatenated in the order
+ * the declarations were given. Subexpressions common to several declarations are only computed once, so a host
+ * needing all of the results can make one call instead of one per declaration.
+ * Each declaration is also exported as an alias def with its own name, which shares the fused def's code but only
+ * returns that declaration's outputs. An alias's args start with the declaration's inputs as normal, followed by
+ * the outputs of any declarations before it, which are ignored - so an alias's args_count can be larger than its
+ * inputs, but only the inputs need to be set. Running an alias still runs all of the fused def's code, so prefer the
+ * fused def when more than one declaration's outputs are needed.
+ *
+ * @param[in] context           interpreter context
+ * @param[in] decls             declarations to export, whose inputs must all have the same sizes
+ * @param[in] funcnames         names of the alias defs, one per declaration
+ * @param[in] decls_count       number of declarations
+ * @param[in] fused_name        name of the fused def
+ * @param[out] buffer           output buffer, or null to only query the archive size
+ * @param[in,out] bufsize       size of the output buffer, set to the size of the archive
+ *
+ * @return ELEMENT_OK exported archive successfully
+ * @return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL interpreter pointer is null
+ * @return ELEMENT_ERROR_API_DECLARATION_IS_NULL declarations or names pointer is null
+ * @return ELEMENT_ERROR_API_STRING_IS_NULL fused name is null
+ * @return ELEMENT_ERROR_API_INVALID_INPUT no declarations were provided, their inputs differ, or names are repeated
+ * @return ELEMENT_ERROR_API_OUTPUT_IS_NULL buffer size pointer is null
+ * @return ELEMENT_ERROR_API_INSUFFICIENT_BUFFER buffer size is too small
+ */
+ELEMENT_API element_result element_interpreter_export_lmnt_fused(
+    element_interpreter_ctx* context,
+    const element_declaration** decls,
+    const char** funcnames,
+    size_t decls_count,
+    const char* fused_name,
+    char* buffer,
+    size_t* bufsize);
+
+/**
+ * @brief compiles declarations and exports them as C source code, defining one function per declaration
+ *
+ * Each function takes a struct of its inputs (one field per input of the declaration) and writes a struct of its
+ * outputs, named after the function. The source has no dependencies other than math.h and can be used as a header.
+ *
+ * @param[in] context           interpreter context
+ * @param[in] decls             declarations to export
+ * @param[in] funcnames         names of the resulting C functions, one per declaration
+ * @param[in] decls_count       number of declarations
+ * @param[out] buffer           output buffer, or null to only query the source size
+ * @param[in,out] bufsize       size of the output buffer, set to the size of the source including the null terminator
+ *
+ * @return ELEMENT_OK exported source successfully
+ * @return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL interpreter pointer is null
+ * @return ELEMENT_ERROR_API_DECLARATION_IS_NULL declarations or names pointer is null
+ * @return ELEMENT_ERROR_API_INVALID_INPUT no declarations were provided, or a name isn't a valid C identifier
+ * @return ELEMENT_ERROR_API_OUTPUT_IS_NULL buffer size pointer is null
+ * @return ELEMENT_ERROR_API_INSUFFICIENT_BUFFER buffer size is too small
+ * @return ELEMENT_ERROR_NO_IMPL a declaration uses something which can't be exported to C
+ */
+ELEMENT_API element_result element_interpreter_export_c(
+    element_interpreter_ctx* context,
+    const element_declaration** decls,
+    const char** funcnames,
+    size_t decls_count,
+    char* buffer,
+    size_t* bufsize);
+
 
     #if defined(__cplusplus)
 }
@@ -13,10 +13,10 @@ void element_ast_delete(element_ast** ast)
     if (!ast)
         return;
 
-    if (*ast)
-        (*ast)->clear_children();
+    //nodes are released along with the rest of their tree, which happens when the root that owns the arena is deleted
+    if (*ast && (*ast)->arena->owner == *ast)
+        delete (*ast)->arena;
 
-    delete *ast;
     *ast = nullptr;
 }
 
@@ -89,7 +89,7 @@ element_result element_ast_get_value_as_identifier(const element_ast* ast, const
     if (!ast->has_identifier())
         return ELEMENT_ERROR_API_INVALID_INPUT;
 
-    *value = ast->identifier.c_str();
+    *value = ast->identifier.data();
     return ELEMENT_OK;
 }
 
@@ -0,0 +1,48 @@
+#include "ast/ast_arena.hpp"
+
+//STD
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+//SELF
+#include "ast/ast_internal.hpp"
+
+using namespace element;
+
+element_ast* ast_arena::new_root()
+{
+    return new (allocate(sizeof(element_ast), alignof(element_ast))) element_ast(this);
+}
+
+void* ast_arena::allocate(std::size_t size, std::size_t alignment)
+{
+    auto address = reinterpret_cast<std::uintptr_t>(current);
+    auto padding = (alignment - address % alignment) % alignment;
+
+    if (!current || padding + size > remaining) {
+        //anything too big for a block gets a block of its own
+        const auto new_block_size = std::max(block_size, size + alignment);
+        blocks.emplace_back(new std::byte[new_block_size]);
+        current = blocks.back().get();
+        remaining = new_block_size;
+        reserved += new_block_size;
+
+        address = reinterpret_cast<std::uintptr_t>(current);
+        padding = (alignment - address % alignment) % alignment;
+    }
+
+    auto* result = current + padding;
+    current = result + size;
+    remaining -= padding + size;
+    return result;
+}
+
+std::string_view ast_arena::store(std::string_view str)
+{
+    auto* data = static_cast<char*>(allocate(str.size() + 1, alignof(char)));
+    std::memcpy(data, str.data(), str.size());
+    data[str.size()] = '\0';
+    return { data, str.size() };
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+//STD
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+struct element_ast;
+
+namespace element
+{
+//Bump allocator for the nodes of one AST, along with their identifiers and child lists
+//Nothing allocated from it is ever freed individually, the whole tree is released along with the arena
+class ast_arena
+{
+public:
+    ast_arena() = default;
+    ast_arena(const ast_arena&) = delete;
+    ast_arena& operator=(const ast_arena&) = delete;
+
+    //creates a node with no parent, which lives as long as this arena
+    [[nodiscard]] element_ast* new_root();
+
+    [[nodiscard]] void* allocate(std::size_t size, std::size_t alignment);
+
+    //copies str in to the arena with a null terminator, so the result can also be used as a C string
+    [[nodiscard]] std::string_view store(std::string_view str);
+
+    [[nodiscard]] std::size_t bytes_reserved() const { return reserved; }
+
+    //set for arenas created by element_ast::new_tree, which are deleted along with their root
+    const element_ast* owner = nullptr;
+
+private:
+    static constexpr std::size_t block_size = 32 * 1024;
+
+    std::vector<std::unique_ptr<std::byte[]>> blocks;
+    std::byte* current = nullptr;
+    std::size_t remaining = 0;
+    std::size_t reserved = 0;
+};
+
+template <typename T>
+class ast_arena_allocator
+{
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    explicit ast_arena_allocator(ast_arena* arena)
+        : arena(arena)
+    {}
+
+    template <typename U>
+    ast_arena_allocator(const ast_arena_allocator<U>& other)
+        : arena(other.arena)
+    {}
+
+    [[nodiscard]] T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, std::size_t) {}
+
+    template <typename U>
+    bool operator==(const ast_arena_allocator<U>& other) const { return arena == other.arena; }
+
+    template <typename U>
+    bool operator!=(const ast_arena_allocator<U>& other) const { return arena != other.arena; }
+
+    ast_arena* arena;
+};
+
+//nodes are released with their arena, so the owning pointers in a node's children only exist to express ownership
+struct ast_arena_deleter
+{
+    void operator()(element_ast*) const {}
+};
+} // namespace element
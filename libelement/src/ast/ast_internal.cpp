@@ -5,9 +5,6 @@
 #include <cassert>
 #include <memory>
 
-//LIBS
-#include "MemoryPool.h"
-
 //SELF
 #include "ast/ast_indexes.hpp"
 #include "token_internal.hpp"
@@ -16,14 +13,31 @@
 
 element_ast::element_ast(element_ast* ast_parent)
     : type(ELEMENT_AST_NODE_NONE)
+    , arena(ast_parent->arena)
     , parent(ast_parent)
+    , children(element::ast_arena_allocator<ast_unique_ptr>(arena))
+{
+}
+
+element_ast::element_ast(element::ast_arena* arena)
+    : type(ELEMENT_AST_NODE_NONE)
+    , arena(arena)
+    , children(element::ast_arena_allocator<ast_unique_ptr>(arena))
+{
+}
+
+element_ast* element_ast::new_tree()
 {
-    children.reserve(20);
+    auto* arena = new element::ast_arena();
+    auto* root = arena->new_root();
+    arena->owner = root;
+    return root;
 }
 
 void element_ast::move(element_ast* from, element_ast* to, bool reparent)
 {
     assert(from != to);
+    assert(from->arena == to->arena);
     element_ast* new_parent = reparent ? from->parent : to->parent;
     to->clear_children();
 
@@ -34,27 +48,15 @@ void element_ast::move(element_ast* from, element_ast* to, bool reparent)
     to->parent = new_parent;
 }
 
-// AST memory pool
-static MemoryPool<element_ast> ast_pool;
-
-static void delete_ast_unique_ptr(element_ast* p)
-{
-    ast_pool.deleteElement(p);
-}
-
 element_ast* element_ast::new_child(element_ast_node_type type)
 {
-    // return std::make_unique<element_ast>(this);
-    element_ast* node = ast_pool.newElement(this);
+    auto* slot = arena->allocate(sizeof(element_ast), alignof(element_ast));
+    element_ast* node = new (slot) element_ast(this);
     node->type = type;
     node->flags = 0;
-    auto child = ast_unique_ptr(node, delete_ast_unique_ptr);
-    assert(child);
 
-    child->parent = this;
-    element_ast* child_raw = child.get();
-    children.push_back(std::move(child));
-    return child_raw;
+    children.emplace_back(node);
+    return node;
 }
 
 void element_ast::clear_children()
@@ -62,6 +64,11 @@ void element_ast::clear_children()
     children.clear();
 }
 
+void element_ast::set_identifier(std::string_view value)
+{
+    identifier = arena->store(value);
+}
+
 bool element_ast::has_flag(element_ast_flags flag) const
 {
     return (flags & flag) == flag;
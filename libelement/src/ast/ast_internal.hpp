@@ -3,27 +3,36 @@
 //STD
 #include <vector>
 #include <string>
+#include <string_view>
 #include <memory>
 #include <functional>
 
 //SELF
+#include "ast_arena.hpp"
 #include "ast_indexes.hpp"
 #include "common_internal.hpp"
 #include "element/ast.h"
 #include "element/token.h"
 #include <cassert>
 
-using ast_unique_ptr = std::unique_ptr<element_ast, void (*)(element_ast*)>;
+using ast_unique_ptr = std::unique_ptr<element_ast, element::ast_arena_deleter>;
 
+//Nodes are allocated from the arena of the tree they're in, and are never destroyed individually
+//Everything a node owns must come from the same arena, so that releasing the arena doesn't leak anything
 struct element_ast
 {
 public:
-    element_ast(element_ast* ast_parent);
+    explicit element_ast(element_ast* ast_parent);
+    explicit element_ast(element::ast_arena* arena);
+
+    //creates the root of a new tree with its own arena, which element_ast_delete releases
+    [[nodiscard]] static element_ast* new_tree();
 
     static void move(element_ast* from, element_ast* to, bool reparent);
 
     element_ast* new_child(element_ast_node_type type = ELEMENT_AST_NODE_NONE);
     void clear_children();
+    void set_identifier(std::string_view value);
 
     [[nodiscard]] bool has_flag(element_ast_flags flag) const;
     [[nodiscard]] bool has_identifier() const;
@@ -62,8 +71,10 @@ public:
     };
 
     element_ast_node_type type;
-    std::string identifier;
+    //null terminated, points in to the arena
+    std::string_view identifier = "";
+    element::ast_arena* arena;
     element_ast* parent = nullptr;
-    std::vector<ast_unique_ptr> children;
+    std::vector<ast_unique_ptr, element::ast_arena_allocator<ast_unique_ptr>> children;
     const element_token* nearest_token = nullptr;
 };
@@ -17,12 +17,12 @@
 #include "token_internal.hpp"
 #include "log_errors.hpp"
 
-static const std::unordered_set<std::string> qualifiers{ "intrinsic" };
-static const std::unordered_set<std::string> constructs{ "struct", "namespace", "constraint" };
-static const std::unordered_set<std::string> reserved_args{};
-static const std::unordered_set<std::string> reserved_names{ "return" };
+static const std::unordered_set<std::string_view> qualifiers{ "intrinsic" };
+static const std::unordered_set<std::string_view> constructs{ "struct", "namespace", "constraint" };
+static const std::unordered_set<std::string_view> reserved_args{};
+static const std::unordered_set<std::string_view> reserved_names{ "return" };
 
-static element_result check_reserved_words(const std::string& text, bool allow_reserved_arg, bool allow_reserved_names)
+static element_result check_reserved_words(std::string_view text, bool allow_reserved_arg, bool allow_reserved_names)
 {
     const bool is_not_reserved_qualifier = qualifiers.count(text) == 0;
     const bool is_not_reserved_construct = constructs.count(text) == 0;
@@ -37,13 +37,13 @@ element_result element_parser_ctx::parse_literal(element_ast& terminal)
 {
     assert(current_token->type == ELEMENT_TOK_NUMBER);
     terminal.type = ELEMENT_AST_NODE_LITERAL;
-    terminal.literal = std::stof(tokeniser->text(current_token));
+    terminal.literal = std::stof(std::string(tokeniser->text(current_token)));
     return advance();
 }
 
 element_result element_parser_ctx::parse_identifier(element_ast& terminal, bool allow_reserved_args, bool allow_reserved_names)
 {
-    terminal.identifier.assign(tokeniser->text(current_token));
+    terminal.set_identifier(tokeniser->text(current_token));
 
     if (current_token->type != ELEMENT_TOK_IDENTIFIER) {
         return element::log_error<element::log_error_message_code::parse_identifier_failed>(
@@ -273,7 +273,7 @@ element_result element_parser_ctx::parse_qualifiers(element_ast_flags& flags)
     std::vector<element_ast_flags> qualifier_flags;
 
     while (current_token->type == ELEMENT_TOK_IDENTIFIER) {
-        std::string id = tokeniser->text(current_token);
+        const auto id = tokeniser->text(current_token);
         if (id == "intrinsic") {
             bool found_duplicate_intrinsic = false;
             for (element_ast_flags flag : qualifier_flags) {
@@ -528,9 +528,8 @@ element_result element_parser_ctx::parse(std::size_t& tindex, element_ast* input
 
 element_result element_parser_ctx::ast_build()
 {
-    // don't use ast_new here, as we need to return this pointer to the user
     element_ast_delete(&root);
-    root = new element_ast(nullptr);
+    root = element_ast::new_tree();
     size_t index = 0;
     const auto result = parse(index, root);
     if (result != ELEMENT_OK) {
@@ -704,7 +703,7 @@ element_result element_parser_ctx::validate_scope(element_ast* ast)
                 child_declaration);
             result = ELEMENT_ERROR_MULTIPLE_DEFINITIONS;
         } else {
-            names.push_back(child_declaration->identifier);
+            names.emplace_back(child_declaration->identifier);
         }
     }
 
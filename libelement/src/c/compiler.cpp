@@ -0,0 +1,575 @@
+#include "c/compiler.hpp"
+
+//STD
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+
+//LIBS
+#include <fmt/format.h>
+
+using namespace element;
+
+namespace
+{
+std::string format_constant(element_value value)
+{
+    if (std::isnan(value))
+        return "NAN";
+
+    if (std::isinf(value))
+        return value > 0 ? "INFINITY" : "(-INFINITY)";
+
+    //9 significant digits is enough for any float to survive the round trip
+    auto text = fmt::format("{:.9g}", value);
+    if (text.find_first_of(".e") == std::string::npos)
+        text += ".0";
+    text += "f";
+
+    return value < 0 ? "(" + text + ")" : text;
+}
+
+std::string unary_expression(element_unary_op op, const std::string& a)
+{
+    switch (op) {
+    //num
+    case element_unary_op::sin:
+        return fmt::format("sinf({})", a);
+    case element_unary_op::cos:
+        return fmt::format("cosf({})", a);
+    case element_unary_op::tan:
+        return fmt::format("tanf({})", a);
+    case element_unary_op::asin:
+        return fmt::format("asinf({})", a);
+    case element_unary_op::acos:
+        return fmt::format("acosf({})", a);
+    case element_unary_op::atan:
+        return fmt::format("atanf({})", a);
+    case element_unary_op::ln:
+        return fmt::format("logf({})", a);
+    case element_unary_op::abs:
+        return fmt::format("fabsf({})", a);
+    case element_unary_op::ceil:
+        return fmt::format("ceilf({})", a);
+    case element_unary_op::floor:
+        return fmt::format("floorf({})", a);
+
+    //boolean
+    case element_unary_op::not_:
+        return fmt::format("({} == 0.0f ? 1.0f : 0.0f)", a);
+    }
+
+    return {};
+}
+
+//these match the evaluator exactly, including how NaN is treated by min, max and the booleans
+std::string binary_expression(element_binary_op op, const std::string& a, const std::string& b)
+{
+    switch (op) {
+    //num
+    case element_binary_op::add:
+        return fmt::format("({} + {})", a, b);
+    case element_binary_op::sub:
+        return fmt::format("({} - {})", a, b);
+    case element_binary_op::mul:
+        return fmt::format("({} * {})", a, b);
+    case element_binary_op::div:
+        return fmt::format("({} / {})", a, b);
+    case element_binary_op::rem:
+        return fmt::format("({0} - floorf({0} / {1}) * {1})", a, b);
+    case element_binary_op::pow:
+        return fmt::format("powf({}, {})", a, b);
+    case element_binary_op::min:
+        return fmt::format("({1} < {0} ? {1} : {0})", a, b);
+    case element_binary_op::max:
+        return fmt::format("({0} < {1} ? {1} : {0})", a, b);
+    case element_binary_op::log:
+        return fmt::format("({1} != 0.0f ? log10f({0}) / log10f({1}) : NAN)", a, b);
+    case element_binary_op::atan2:
+        return fmt::format("atan2f({}, {})", a, b);
+
+    //boolean
+    case element_binary_op::and_:
+        return fmt::format("({} > 0.0f && {} > 0.0f ? 1.0f : 0.0f)", a, b);
+    case element_binary_op::or_:
+        return fmt::format("({} > 0.0f || {} > 0.0f ? 1.0f : 0.0f)", a, b);
+
+    //comparison
+    case element_binary_op::eq:
+        return fmt::format("({} == {} ? 1.0f : 0.0f)", a, b);
+    case element_binary_op::neq:
+        return fmt::format("({} != {} ? 1.0f : 0.0f)", a, b);
+    case element_binary_op::lt:
+        return fmt::format("({} < {} ? 1.0f : 0.0f)", a, b);
+    case element_binary_op::leq:
+        return fmt::format("({} <= {} ? 1.0f : 0.0f)", a, b);
+    case element_binary_op::gt:
+        return fmt::format("({} > {} ? 1.0f : 0.0f)", a, b);
+    case element_binary_op::geq:
+        return fmt::format("({} >= {} ? 1.0f : 0.0f)", a, b);
+    }
+
+    return {};
+}
+
+//writes the statements of a function body, each instruction being written once as a local the first time it's needed
+//everything is evaluated eagerly like the evaluator does, except for the options of a select and the inside of a loop
+class function_writer
+{
+public:
+    explicit function_writer(std::vector<std::string> input_values)
+    {
+        boundaries.push_back(std::move(input_values));
+        scopes.emplace_back();
+    }
+
+    element_result write(const instruction_const_shared_ptr& instruction, std::vector<std::string>& values)
+    {
+        for (auto it = scopes.rbegin(); it != scopes.rend(); ++it) {
+            const auto found = it->find(instruction.get());
+            if (found != it->end()) {
+                values.insert(values.end(), found->second.begin(), found->second.end());
+                return ELEMENT_OK;
+            }
+        }
+
+        std::vector<std::string> written;
+        ELEMENT_OK_OR_RETURN(write_new(*instruction, written));
+        values.insert(values.end(), written.begin(), written.end());
+        scopes.back().emplace(instruction.get(), std::move(written));
+        return ELEMENT_OK;
+    }
+
+    std::string body;
+
+private:
+    element_result write_single(const instruction_const_shared_ptr& instruction, std::string& value)
+    {
+        std::vector<std::string> values;
+        ELEMENT_OK_OR_RETURN(write(instruction, values));
+        if (values.size() != 1)
+            return ELEMENT_ERROR_UNKNOWN;
+
+        value = std::move(values[0]);
+        return ELEMENT_OK;
+    }
+
+    element_result write_new(const instruction& instruction, std::vector<std::string>& values)
+    {
+        if (const auto* constant = instruction.as<instruction_constant>()) {
+            values.push_back(format_constant(constant->value()));
+            return ELEMENT_OK;
+        }
+
+        if (const auto* input = instruction.as<instruction_input>()) {
+            if (input->scope() >= boundaries.size() || input->index() >= boundaries[input->scope()].size())
+                return ELEMENT_ERROR_UNKNOWN;
+
+            values.push_back(boundaries[input->scope()][input->index()]);
+            return ELEMENT_OK;
+        }
+
+        if (const auto* structure = instruction.as<instruction_serialised_structure>()) {
+            for (const auto& dependent : structure->dependents())
+                ELEMENT_OK_OR_RETURN(write(dependent, values));
+            return ELEMENT_OK;
+        }
+
+        if (const auto* nullary = instruction.as<instruction_nullary>()) {
+            switch (nullary->operation()) {
+            case element_nullary_op::nan:
+                values.emplace_back("NAN");
+                return ELEMENT_OK;
+            case element_nullary_op::positive_infinity:
+                values.emplace_back("INFINITY");
+                return ELEMENT_OK;
+            case element_nullary_op::negative_infinity:
+                values.emplace_back("(-INFINITY)");
+                return ELEMENT_OK;
+            case element_nullary_op::true_value:
+                values.emplace_back("1.0f");
+                return ELEMENT_OK;
+            case element_nullary_op::false_value:
+                values.emplace_back("0.0f");
+                return ELEMENT_OK;
+            }
+
+            return ELEMENT_ERROR_NO_IMPL;
+        }
+
+        if (const auto* unary = instruction.as<instruction_unary>()) {
+            std::string a;
+            ELEMENT_OK_OR_RETURN(write_single(unary->input(), a));
+            values.push_back(local(unary_expression(unary->operation(), a)));
+            return ELEMENT_OK;
+        }
+
+        if (const auto* binary = instruction.as<instruction_binary>()) {
+            std::string a, b;
+            ELEMENT_OK_OR_RETURN(write_single(binary->input1(), a));
+            ELEMENT_OK_OR_RETURN(write_single(binary->input2(), b));
+            values.push_back(local(binary_expression(binary->operation(), a, b)));
+            return ELEMENT_OK;
+        }
+
+        if (const auto* if_instruction = instruction.as<instruction_if>()) {
+            std::string predicate, if_true, if_false;
+            ELEMENT_OK_OR_RETURN(write_single(if_instruction->predicate(), predicate));
+            ELEMENT_OK_OR_RETURN(write_single(if_instruction->if_true(), if_true));
+            ELEMENT_OK_OR_RETURN(write_single(if_instruction->if_false(), if_false));
+            values.push_back(local(fmt::format("({} > 0.0f ? {} : {})", predicate, if_true, if_false)));
+            return ELEMENT_OK;
+        }
+
+        if (const auto* select = instruction.as<instruction_select>())
+            return write_select(*select, values);
+
+        if (const auto* for_instruction = instruction.as<instruction_for>())
+            return write_for(*for_instruction, values);
+
+        if (const auto* indexer = instruction.as<instruction_indexer>()) {
+            std::vector<std::string> for_values;
+            ELEMENT_OK_OR_RETURN(write(indexer->for_instruction(), for_values));
+            if (indexer->index < 0 || static_cast<size_t>(indexer->index) >= for_values.size())
+                return ELEMENT_ERROR_UNKNOWN;
+
+            values.push_back(for_values[indexer->index]);
+            return ELEMENT_OK;
+        }
+
+        return ELEMENT_ERROR_NO_IMPL;
+    }
+
+    //only the selected option is evaluated, so each one is written in its own block
+    element_result write_select(const instruction_select& select, std::vector<std::string>& values)
+    {
+        std::string selector;
+        ELEMENT_OK_OR_RETURN(write_single(select.selector(), selector));
+
+        const auto id = next_id++;
+        const auto last = select.options_count() - 1;
+
+        //the options can be structures or selects themselves, so how many values they have is only known once the
+        //first one is written, and the variables they're assigned to are declared before the switch afterwards
+        const auto declarations_start = body.size();
+        const auto declarations_indent = indent;
+
+        //truncated and clamped like the evaluator, where anything that doesn't fit in an int (or NaN) becomes the
+        //smallest int, so picks the first option. that's done without casting it, which would be undefined
+        line(fmt::format("switch ({0} >= 1.0f && {0} < 2147483648.0f ? ({0} < {1}.0f ? (int){0} : {1}) : 0)", selector, last));
+        line("{");
+        std::vector<std::string> variables;
+        for (size_t option = 0; option <= last; ++option) {
+            line(option == last ? "default:" : fmt::format("case {}:", option));
+            line("{");
+            begin_block();
+
+            std::vector<std::string> option_values;
+            ELEMENT_OK_OR_RETURN(write(select.options_at(option), option_values));
+            if (option == 0) {
+                for (size_t i = 0; i < option_values.size(); ++i)
+                    variables.push_back(fmt::format("s{}_{}", id, i));
+            }
+
+            if (option_values.size() != variables.size())
+                return ELEMENT_ERROR_UNKNOWN;
+
+            for (size_t i = 0; i < variables.size(); ++i)
+                line(fmt::format("{} = {};", variables[i], option_values[i]));
+            line("break;");
+
+            end_block();
+            line("}");
+        }
+        line("}");
+
+        std::string declarations;
+        for (const auto& variable : variables)
+            declarations += std::string(declarations_indent * 4, ' ') + fmt::format("float {};\n", variable);
+        body.insert(declarations_start, declarations);
+
+        values.insert(values.end(), variables.begin(), variables.end());
+        return ELEMENT_OK;
+    }
+
+    //the body's inputs are a new boundary, which are the loop's variables
+    element_result write_for(const instruction_for& for_instruction, std::vector<std::string>& values)
+    {
+        std::vector<std::string> initial;
+        ELEMENT_OK_OR_RETURN(write(for_instruction.initial(), initial));
+
+        const auto id = next_id++;
+        std::vector<std::string> variables;
+        for (size_t i = 0; i < initial.size(); ++i) {
+            variables.push_back(fmt::format("l{}_{}", id, i));
+            line(fmt::format("float {} = {};", variables.back(), initial[i]));
+        }
+
+        line("for (;;)");
+        line("{");
+        begin_block();
+        boundaries.push_back(variables);
+
+        std::string condition;
+        ELEMENT_OK_OR_RETURN(write_single(for_instruction.condition(), condition));
+        line(fmt::format("if (!({} > 0.0f))", condition));
+        line("    break;");
+
+        std::vector<std::string> body;
+        ELEMENT_OK_OR_RETURN(write(for_instruction.body(), body));
+        if (body.size() != variables.size())
+            return ELEMENT_ERROR_UNKNOWN;
+
+        //every new value is calculated from the old ones, so they're all taken before any are updated
+        for (auto& value : body)
+            value = local(value);
+        for (size_t i = 0; i < variables.size(); ++i)
+            line(fmt::format("{} = {};", variables[i], body[i]));
+
+        boundaries.pop_back();
+        end_block();
+        line("}");
+
+        values.insert(values.end(), variables.begin(), variables.end());
+        return ELEMENT_OK;
+    }
+
+    void begin_block()
+    {
+        ++indent;
+        scopes.emplace_back();
+    }
+
+    void end_block()
+    {
+        scopes.pop_back();
+        --indent;
+    }
+
+    void line(const std::string& text)
+    {
+        body.append(indent * 4, ' ');
+        body += text;
+        body += '\n';
+    }
+
+    std::string local(const std::string& expression)
+    {
+        auto name = fmt::format("v{}", next_id++);
+        line(fmt::format("const float {} = {};", name, expression));
+        return name;
+    }
+
+    //locals written in a block can't be used after it, so each block has its own
+    std::vector<std::unordered_map<const element::instruction*, std::vector<std::string>>> scopes;
+    std::vector<std::vector<std::string>> boundaries;
+    size_t next_id = 0;
+    size_t indent = 1;
+};
+
+//keywords of C and C++, which can't be used for the names of fields
+bool is_keyword(const std::string& name)
+{
+    static const std::unordered_set<std::string> keywords = {
+        "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break", "case", "catch",
+        "char", "class", "compl", "const", "const_cast", "constexpr", "continue", "decltype", "default", "delete",
+        "do", "double", "dynamic_cast", "else", "enum", "explicit", "export", "extern", "false", "float", "for",
+        "friend", "goto", "if", "inline", "int", "long", "mutable", "namespace", "new", "noexcept", "not", "not_eq",
+        "nullptr", "operator", "or", "or_eq", "private", "protected", "public", "register", "reinterpret_cast",
+        "restrict", "return", "short", "signed", "sizeof", "static", "static_assert", "static_cast", "struct",
+        "switch", "template", "this", "thread_local", "throw", "true", "try", "typedef", "typeid", "typename",
+        "union", "unsigned", "using", "virtual", "void", "volatile", "wchar_t", "while", "xor", "xor_eq"
+    };
+
+    return keywords.count(name) != 0;
+}
+
+//gives every field a distinct name that's usable in C. names which already are keep them, so keywords which have
+//to be escaped (and anything we've added ourselves, which comes last) are the ones changed to avoid a clash
+void assign_field_names(std::vector<element_c_field>& fields)
+{
+    std::unordered_set<std::string> used;
+    std::vector<element_c_field*> renamed;
+    for (auto& field : fields) {
+        if (is_keyword(field.name) || !used.insert(field.name).second)
+            renamed.push_back(&field);
+    }
+
+    for (auto* field : renamed) {
+        const auto base = is_keyword(field->name) ? field->name + "_" : field->name;
+        auto name = base;
+        for (size_t suffix = 1; used.count(name) != 0; ++suffix)
+            name = fmt::format("{}_{}", base, suffix);
+
+        used.insert(name);
+        field->name = std::move(name);
+    }
+}
+
+void write_struct(std::string& source, const std::string& name, const std::vector<element_c_field>& fields)
+{
+    source += fmt::format("typedef struct {}\n{{\n", name);
+    for (const auto& field : fields) {
+        if (field.size == 1)
+            source += fmt::format("    float {};\n", field.name);
+        else
+            source += fmt::format("    float {}[{}];\n", field.name, field.size);
+    }
+    source += fmt::format("}} {};\n\n", name);
+}
+
+//the expressions for each individual value in a struct, in order
+std::vector<std::string> field_values(const std::string& prefix, const std::vector<element_c_field>& fields)
+{
+    std::vector<std::string> values;
+    for (const auto& field : fields) {
+        if (field.size == 1) {
+            values.push_back(prefix + field.name);
+            continue;
+        }
+
+        for (size_t i = 0; i < field.size; ++i)
+            values.push_back(fmt::format("{}{}[{}]", prefix, field.name, i));
+    }
+
+    return values;
+}
+
+size_t count_values(const std::vector<element_c_field>& fields)
+{
+    size_t count = 0;
+    for (const auto& field : fields)
+        count += field.size;
+    return count;
+}
+
+void find_inputs_count(const element::instruction& instruction, size_t& count)
+{
+    if (const auto* input = instruction.as<instruction_input>()) {
+        if (input->scope() == 0)
+            count = (std::max)(count, input->index() + 1);
+    }
+
+    for (const auto& dependent : instruction.dependents())
+        find_inputs_count(*dependent, count);
+}
+} // namespace
+
+bool element_c_is_identifier(const std::string& name)
+{
+    if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0])))
+        return false;
+
+    const auto valid_character = [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; };
+    return std::all_of(name.begin(), name.end(), valid_character) && !is_keyword(name);
+}
+
+element_result element_c_compile_function(
+    const element::instruction_const_shared_ptr& instruction,
+    std::string name,
+    std::vector<element_c_field> inputs,
+    element_c_compiled_function& output)
+{
+    if (!instruction)
+        return ELEMENT_ERROR_API_INSTRUCTION_IS_NULL;
+
+    if (!element_c_is_identifier(name))
+        return ELEMENT_ERROR_API_INVALID_INPUT;
+
+    for (const auto& field : inputs) {
+        if ((!element_c_is_identifier(field.name) && !is_keyword(field.name)) || field.size == 0)
+            return ELEMENT_ERROR_API_INVALID_INPUT;
+    }
+
+    size_t used_inputs_count = 0;
+    find_inputs_count(*instruction, used_inputs_count);
+    const auto declared_inputs_count = count_values(inputs);
+    if (declared_inputs_count < used_inputs_count)
+        inputs.push_back({ "values", used_inputs_count - declared_inputs_count });
+
+    assign_field_names(inputs);
+    const auto inputs_count = count_values(inputs);
+    function_writer writer(field_values("inputs->", inputs));
+
+    //the size of each field is however many values were written for it, as a select reports a size of one no
+    //matter what its options are
+    std::vector<element_c_field> outputs;
+    std::vector<std::string> values;
+    const auto* structure = instruction->as<instruction_serialised_structure>();
+    if (structure && structure->get_field_names().size() == structure->dependents().size()) {
+        for (size_t i = 0; i < structure->dependents().size(); ++i) {
+            const auto written = values.size();
+            ELEMENT_OK_OR_RETURN(writer.write(structure->dependents()[i], values));
+            outputs.push_back({ structure->get_field_names()[i], values.size() - written });
+        }
+    } else {
+        ELEMENT_OK_OR_RETURN(writer.write(instruction, values));
+        outputs.push_back({ "value", values.size() });
+    }
+
+    //a field without any values can't be declared
+    const auto empty_field = [](const element_c_field& field) { return field.size == 0; };
+    if (std::any_of(outputs.begin(), outputs.end(), empty_field))
+        return ELEMENT_ERROR_UNKNOWN;
+
+    assign_field_names(outputs);
+    const auto outputs_count = count_values(outputs);
+
+    const auto output_values = field_values("outputs->", outputs);
+    for (size_t i = 0; i < outputs_count; ++i)
+        writer.body += fmt::format("    {} = {};\n", output_values[i], values[i]);
+
+    std::string source;
+    source += fmt::format("#define {}_INPUTS_COUNT {}\n", name, inputs_count);
+    source += fmt::format("#define {}_OUTPUTS_COUNT {}\n\n", name, outputs_count);
+
+    //C doesn't allow empty structs, so functions without inputs don't take any
+    if (inputs_count > 0)
+        write_struct(source, name + "_inputs", inputs);
+    write_struct(source, name + "_outputs", outputs);
+
+    if (inputs_count > 0)
+        source += fmt::format("ELEMENT_FUNCTION void {0}(const {0}_inputs* inputs, {0}_outputs* outputs)\n{{\n", name);
+    else
+        source += fmt::format("ELEMENT_FUNCTION void {0}({0}_outputs* outputs)\n{{\n", name);
+    source += writer.body;
+    source += "}\n";
+
+    output.name = std::move(name);
+    output.inputs = std::move(inputs);
+    output.outputs = std::move(outputs);
+    output.inputs_count = inputs_count;
+    output.outputs_count = outputs_count;
+    output.source = std::move(source);
+    return ELEMENT_OK;
+}
+
+std::string element_c_create_source(const std::vector<element_c_compiled_function>& functions)
+{
+    std::string source = R"(/* generated by libelement */
+#include <math.h>
+
+/* functions are static inline so this can be included as a header, define ELEMENT_FUNCTION to change that */
+#if !defined(ELEMENT_FUNCTION)
+    #define ELEMENT_FUNCTION static inline
+#endif
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+)";
+
+    for (const auto& function : functions) {
+        source += function.source;
+        source += "\n";
+    }
+
+    source += R"(#if defined(__cplusplus)
+}
+#endif
+)";
+
+    return source;
+}
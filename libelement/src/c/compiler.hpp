@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "instruction_tree/instructions.hpp"
+
+//a named member of a generated function's input or output struct, which is an array when size isn't 1
+struct element_c_field
+{
+    std::string name;
+    size_t size = 1;
+};
+
+struct element_c_compiled_function
+{
+    std::string name;
+    std::vector<element_c_field> inputs;
+    std::vector<element_c_field> outputs;
+    size_t inputs_count = 0;
+    size_t outputs_count = 0;
+    //the structs and the function, without the includes and macros from element_c_create_source
+    std::string source;
+};
+
+//lowers an instruction tree to a C function taking a struct of inputs and writing a struct of outputs
+//inputs are matched to the tree's boundary inputs in order. when there aren't enough of them, the rest are added as
+//an array named "values", and the output struct's fields come from the tree's serialised structure if it has one
+//fields are renamed where needed to be unique and valid in C, e.g. keywords get a trailing underscore, and the
+//compiled function has the names used in the generated source
+element_result element_c_compile_function(
+    const element::instruction_const_shared_ptr& instruction,
+    std::string name,
+    std::vector<element_c_field> inputs,
+    element_c_compiled_function& output);
+
+//creates a self-contained translation unit (or header) defining all of the functions
+std::string element_c_create_source(const std::vector<element_c_compiled_function>& functions);
+
+//whether name can be used as-is as a C identifier
+bool element_c_is_identifier(const std::string& name);
@@ -0,0 +1,91 @@
+#include <element/element.h>
+#include <interpreter_internal.hpp>
+#include <cstring>
+
+#include "c/compiler.hpp"
+#include "object_model/compilation_context.hpp"
+#include "object_model/declarations/declaration.hpp"
+
+struct instruction_deleter
+{
+    void operator()(element_instruction* instr)
+    {
+        element_instruction_delete(&instr);
+    }
+};
+
+// one field per port of the declaration, sized by how many boundary inputs its placeholder takes up
+static std::vector<element_c_field> create_input_fields(element_interpreter_ctx* context, const element::declaration& decl)
+{
+    const element::compilation_context compilation_context(context->global_scope.get(), context);
+
+    std::vector<element_c_field> fields;
+    std::size_t index = 0;
+    for (const auto& input : decl.get_inputs()) {
+        const auto start = index;
+        const auto placeholder = input.generate_placeholder(compilation_context, index, 0);
+        if (!placeholder || placeholder->is_error())
+            return {};
+
+        if (index > start)
+            fields.push_back({ input.get_name(), index - start });
+    }
+
+    return fields;
+}
+
+element_result element_interpreter_export_c(
+    element_interpreter_ctx* context,
+    const element_declaration** decls,
+    const char** funcnames,
+    size_t decls_count,
+    char* buffer,
+    size_t* bufsize)
+{
+    if (!context)
+        return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL;
+    if (!decls || !funcnames)
+        return ELEMENT_ERROR_API_DECLARATION_IS_NULL;
+    if (decls_count == 0)
+        return ELEMENT_ERROR_API_INVALID_INPUT;
+    if (!bufsize)
+        return ELEMENT_ERROR_API_OUTPUT_IS_NULL;
+
+    for (size_t i = 0; i < decls_count; ++i) {
+        if (!decls[i] || !decls[i]->decl || !funcnames[i])
+            return ELEMENT_ERROR_API_DECLARATION_IS_NULL;
+
+        // the names are used as-is for the functions and their structs, so they have to be valid in C
+        if (!element_c_is_identifier(funcnames[i]))
+            return ELEMENT_ERROR_API_INVALID_INPUT;
+    }
+
+    using instruction = std::unique_ptr<element_instruction, instruction_deleter>;
+    std::vector<element_c_compiled_function> functions(decls_count);
+    for (size_t i = 0; i < decls_count; ++i) {
+        element_instruction* instr = nullptr;
+        ELEMENT_OK_OR_RETURN(element_interpreter_compile_declaration(context, nullptr, decls[i], &instr));
+        const instruction function(instr);
+        if (!function)
+            return ELEMENT_ERROR_UNKNOWN;
+
+        auto inputs = create_input_fields(context, *decls[i]->decl);
+        ELEMENT_OK_OR_RETURN(element_c_compile_function(function->instruction, funcnames[i], std::move(inputs), functions[i]));
+    }
+
+    const auto source = element_c_create_source(functions);
+
+    size_t current_bufsize = *bufsize;
+    // always write the size of the source (including the null terminator) back out to the user
+    *bufsize = source.size() + 1;
+
+    // if the user gave us a buffer, check it's big enough and write to it
+    if (buffer) {
+        if (source.size() + 1 > current_bufsize)
+            return ELEMENT_ERROR_API_INSUFFICIENT_BUFFER;
+
+        memcpy(buffer, source.c_str(), source.size() + 1);
+    }
+
+    return ELEMENT_OK;
+}
@@ -15,6 +15,7 @@
 #include "element/token.h"
 #include "element/common.h"
 #include "instruction_tree/fwd.hpp"
+#include "source_buffer.hpp"
 
 struct element_tokeniser_ctx;
 struct element_interpreter_ctx;
@@ -117,13 +118,6 @@ private:
     std::string msg;
 };
 
-struct file_information
-{
-    //note: unique_ptr so it's on the heap and the memory address doesn't change
-    std::vector<std::unique_ptr<std::string>> source_lines;
-    std::unique_ptr<std::string> file_name;
-};
-
 //after talking to james we can/should change this around, something to discuss another time
 struct source_context
 {
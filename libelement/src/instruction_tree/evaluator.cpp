@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <limits>
 
 using namespace element;
 
@@ -50,13 +51,10 @@ static element_result do_evaluate(element_evaluator_ctx& context, const element:
         initial.resize(eb->initial()->get_size());
 
         ELEMENT_OK_OR_RETURN(do_evaluate(context, eb->initial(), nullptr, initial.data(), eb->initial()->get_size(), intermediate_written));
-        intermediate_written = 0;
-        auto for_result = element_evaluate_for(context, eb->initial(), eb->condition(), eb->body());
-        assert(outputs_count >= outputs_written + for_result.size());
-        assert(for_result.size() == eb->initial()->get_size());
-        std::copy(for_result.begin(), for_result.begin() + for_result.size(), &outputs[outputs_written]);
-        //std::memcpy(outputs + outputs_written, for_result.data(), for_result.size() * );
-        outputs_written += for_result.size();
+        ELEMENT_OK_OR_RETURN(element_iterate_for(context, eb->condition(), eb->body(), initial, std::numeric_limits<std::size_t>::max()));
+        assert(outputs_count >= outputs_written + initial.size());
+        std::copy(initial.begin(), initial.end(), &outputs[outputs_written]);
+        outputs_written += initial.size();
         return ELEMENT_OK;
     }
 
@@ -324,54 +322,63 @@ std::vector<element_value> element_evaluate_for(element_evaluator_ctx& context,
     const auto value_size = initial->get_size();
     std::vector<element_value> inputs;
     inputs.resize(value_size);
-    context.boundaries.push_back({ inputs.data(), value_size });
 
     auto result = do_evaluate(context, initial, nullptr, inputs.data(), value_size, intermediate_written);
     if (result != ELEMENT_OK)
         throw;
 
-    intermediate_written = 0;
-
-    element_value predicate_value;
-    result = do_evaluate(context, condition, nullptr, &predicate_value, 1, intermediate_written);
-    intermediate_written = 0;
-
+    result = element_iterate_for(context, condition, body, inputs, std::numeric_limits<std::size_t>::max());
     if (result != ELEMENT_OK)
         throw;
 
-    // Create a buffer for outputs, so that we do not modify 'inputs' during the evaluation
+    return inputs;
+}
+
+element_result element_iterate_for(
+    element_evaluator_ctx& context,
+    const element::instruction_const_shared_ptr& condition,
+    const element::instruction_const_shared_ptr& body,
+    std::vector<element_value>& values,
+    std::size_t max_iterations)
+{
+    const auto value_size = values.size();
+    context.boundaries.push_back({ values.data(), value_size });
+
+    // Create a buffer for outputs, so that we do not modify 'values' during the evaluation
     // of the body.
     std::vector<element_value> body_output_buffer(value_size);
 
-    while (to_bool(predicate_value)) //predicate returned true
-    {
-        result = do_evaluate(context, body, nullptr, body_output_buffer.data(), value_size, intermediate_written);
+    element_result result = ELEMENT_OK;
+    std::size_t iterations = 0;
+    while (true) {
+        size_t intermediate_written = 0;
+        element_value predicate_value;
+        result = do_evaluate(context, condition, nullptr, &predicate_value, 1, intermediate_written);
+        if (result == ELEMENT_OK && intermediate_written != 1)
+            result = ELEMENT_ERROR_UNKNOWN;
 
-        std::swap(body_output_buffer, inputs);
-        context.boundaries.back().inputs = inputs.data();
+        if (result != ELEMENT_OK || !to_bool(predicate_value))
+            break;
 
-        if (result != ELEMENT_OK)
-            throw;
-
-        if (intermediate_written != value_size)
-            throw;
+        if (iterations++ == max_iterations) {
+            result = ELEMENT_ERROR_INFINITE_LOOP;
+            break;
+        }
 
         intermediate_written = 0;
-        result = do_evaluate(context, condition, nullptr, &predicate_value, 1, intermediate_written);
-        if (result != ELEMENT_OK)
-            throw;
+        result = do_evaluate(context, body, nullptr, body_output_buffer.data(), value_size, intermediate_written);
+        if (result == ELEMENT_OK && intermediate_written != value_size)
+            result = ELEMENT_ERROR_UNKNOWN;
 
-        if (intermediate_written != 1)
-            throw;
+        if (result != ELEMENT_OK)
+            break;
 
-        intermediate_written = 0;
+        std::swap(body_output_buffer, values);
+        context.boundaries.back().inputs = values.data();
     }
 
-    if (result != ELEMENT_OK)
-        throw;
-
     context.boundaries.pop_back();
-    return inputs;
+    return result;
 }
 
 std::size_t element_evaluate_select(element_value selector, size_t options_count)
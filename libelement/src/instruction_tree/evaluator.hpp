@@ -30,4 +30,13 @@ element_value element_evaluate_unary(element::instruction_unary::op op, element_
 element_value element_evaluate_binary(element::instruction_binary::op op, element_value a, element_value b);
 element_value element_evaluate_if(element_value predicate, element_value if_true, element_value if_false);
 std::vector<element_value> element_evaluate_for(element_evaluator_ctx& context, const element::instruction_const_shared_ptr& initial, const element::instruction_const_shared_ptr& condition, const element::instruction_const_shared_ptr&);
+
+//runs a for loop from the given values until the condition fails, the body inputs being a new boundary pushed on to the context
+//returns ELEMENT_ERROR_INFINITE_LOOP if the condition still holds after max_iterations
+element_result element_iterate_for(
+    element_evaluator_ctx& context,
+    const element::instruction_const_shared_ptr& condition,
+    const element::instruction_const_shared_ptr& body,
+    std::vector<element_value>& values,
+    std::size_t max_iterations);
 std::size_t element_evaluate_select(element_value selector, size_t option_count);
\ No newline at end of file
@@ -14,6 +14,10 @@
 #include <numeric>
 #include <unordered_map>
 #include <set>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
 
 namespace element
 {
@@ -24,6 +28,15 @@ namespace element
     return value > element_value{ 0 };
 }
 
+//combines the hashes of the values which make up an instruction's key
+template <typename... Values>
+[[nodiscard]] std::size_t hash_values(const Values&... values) noexcept
+{
+    std::size_t hash = 0;
+    ((hash = (hash * 31) ^ std::hash<Values>{}(values)), ...);
+    return hash;
+}
+
 struct instruction : public object, public rtti_type<instruction>, public std::enable_shared_from_this<instruction>
 {
 public:
@@ -106,6 +119,28 @@ struct instruction_constant final : public instruction
         return fmt::format("Num = {:g}", m_value);
     }
 
+    //identifies an instruction when hash-consing, so an existing one can be found without creating another first
+    //equal when operator< considers them equivalent, so all NaNs are the same, as are 0 and -0
+    struct key
+    {
+        element_value value;
+        type_const_ptr type;
+
+        [[nodiscard]] bool operator==(const key& other) const noexcept
+        {
+            return type == other.type && (value == other.value || (std::isnan(value) && std::isnan(other.value)));
+        }
+
+        [[nodiscard]] std::size_t hash() const noexcept
+        {
+            const auto normalised = std::isnan(value) ? std::numeric_limits<element_value>::quiet_NaN() : value == 0 ? 0 : value;
+            return hash_values(normalised, type);
+        }
+    };
+
+    [[nodiscard]] static key make_key(element_value val, type_const_ptr type = type::num.get()) { return { val, type }; }
+    [[nodiscard]] key get_key() const { return { m_value, actual_type }; }
+
     bool operator<(const instruction_constant& other) const noexcept
     {
         if (actual_type != other.actual_type)
@@ -143,6 +178,19 @@ struct instruction_input final : public instruction
     [[nodiscard]] bool get_constant_value(element_value& result) const override { return false; }
     [[nodiscard]] std::string to_string() const override { return fmt::format("<scope {}, index {}>", m_scope, m_index); }
 
+    struct key
+    {
+        size_t scope;
+        size_t index;
+        type_const_ptr type;
+
+        [[nodiscard]] bool operator==(const key& other) const noexcept { return scope == other.scope && index == other.index && type == other.type; }
+        [[nodiscard]] std::size_t hash() const noexcept { return hash_values(scope, index, type); }
+    };
+
+    [[nodiscard]] static key make_key(size_t scope, size_t input_index, type_const_ptr type) { return { scope, input_index, type }; }
+    [[nodiscard]] key get_key() const { return { m_scope, m_index, actual_type }; }
+
     bool operator<(const instruction_input& other) const noexcept
     {
         if (m_scope != other.m_scope)
@@ -197,6 +245,33 @@ struct instruction_serialised_structure final : public instruction
         return m_debug_dependents_names;
     }
 
+    struct key
+    {
+        const std::vector<instruction_const_shared_ptr>* dependents;
+        const std::vector<std::string>* dependents_names;
+        const std::string* type_name;
+
+        [[nodiscard]] bool operator==(const key& other) const noexcept
+        {
+            return *dependents == *other.dependents && *type_name == *other.type_name && *dependents_names == *other.dependents_names;
+        }
+
+        [[nodiscard]] std::size_t hash() const noexcept
+        {
+            auto hash = hash_values(*type_name);
+            for (const auto& dependent : *dependents)
+                hash = (hash * 31) ^ std::hash<const instruction*>{}(dependent.get());
+            return hash;
+        }
+    };
+
+    [[nodiscard]] static key make_key(const std::vector<instruction_const_shared_ptr>& deps, const std::vector<std::string>& deps_names, const std::string& type_name)
+    {
+        return { &deps, &deps_names, &type_name };
+    }
+
+    [[nodiscard]] key get_key() const { return { &m_dependents, &m_debug_dependents_names, &m_debug_type_name }; }
+
     bool operator<(const instruction_serialised_structure& other) const noexcept
     {
         if (m_dependents != other.m_dependents)
@@ -235,6 +310,18 @@ struct instruction_nullary final : public instruction
     [[nodiscard]] bool is_constant() const override { return true; }
     [[nodiscard]] bool get_constant_value(element_value& result) const override;
 
+    struct key
+    {
+        op operation;
+        type_const_ptr type;
+
+        [[nodiscard]] bool operator==(const key& other) const noexcept { return operation == other.operation && type == other.type; }
+        [[nodiscard]] std::size_t hash() const noexcept { return hash_values(operation, type); }
+    };
+
+    [[nodiscard]] static key make_key(op t, type_const_ptr actual_type) { return { t, actual_type }; }
+    [[nodiscard]] key get_key() const { return { m_op, actual_type }; }
+
     [[nodiscard]] bool operator<(const instruction_nullary& other) const noexcept
     {
         if (m_op != other.m_op)
@@ -266,6 +353,19 @@ struct instruction_unary final : public instruction
     [[nodiscard]] size_t get_size() const override { return 1; }
     [[nodiscard]] bool get_constant_value(element_value& result) const override;
 
+    struct key
+    {
+        op operation;
+        const instruction* input;
+        type_const_ptr type;
+
+        [[nodiscard]] bool operator==(const key& other) const noexcept { return operation == other.operation && input == other.input && type == other.type; }
+        [[nodiscard]] std::size_t hash() const noexcept { return hash_values(operation, input, type); }
+    };
+
+    [[nodiscard]] static key make_key(op t, const instruction_const_shared_ptr& input, type_const_ptr actual_type) { return { t, input.get(), actual_type }; }
+    [[nodiscard]] key get_key() const { return { m_op, input().get(), actual_type }; }
+
     bool operator<(const instruction_unary& other) const noexcept
     {
         if (m_op != other.m_op)
@@ -307,6 +407,28 @@ struct instruction_binary final : public instruction
     [[nodiscard]] size_t get_size() const override { return 1; }
     [[nodiscard]] bool get_constant_value(element_value& result) const override;
 
+    struct key
+    {
+        op operation;
+        const instruction* input1;
+        const instruction* input2;
+        type_const_ptr type;
+
+        [[nodiscard]] bool operator==(const key& other) const noexcept
+        {
+            return operation == other.operation && input1 == other.input1 && input2 == other.input2 && type == other.type;
+        }
+
+        [[nodiscard]] std::size_t hash() const noexcept { return hash_values(operation, input1, input2, type); }
+    };
+
+    [[nodiscard]] static key make_key(op t, const instruction_const_shared_ptr& in1, const instruction_const_shared_ptr& in2, type_const_ptr actual_type)
+    {
+        return { t, in1.get(), in2.get(), actual_type };
+    }
+
+    [[nodiscard]] key get_key() const { return { m_op, input1().get(), input2().get(), actual_type }; }
+
     bool operator<(const instruction_binary& other) const noexcept
     {
         if (operation() != other.operation())
@@ -337,6 +459,28 @@ struct instruction_if final : public instruction
     [[nodiscard]] size_t get_size() const override { return 1; }
     [[nodiscard]] bool get_constant_value(element_value& result) const override;
 
+    //the type comes from the branches, so isn't part of the key
+    struct key
+    {
+        const instruction* predicate;
+        const instruction* if_true;
+        const instruction* if_false;
+
+        [[nodiscard]] bool operator==(const key& other) const noexcept
+        {
+            return predicate == other.predicate && if_true == other.if_true && if_false == other.if_false;
+        }
+
+        [[nodiscard]] std::size_t hash() const noexcept { return hash_values(predicate, if_true, if_false); }
+    };
+
+    [[nodiscard]] static key make_key(const instruction_const_shared_ptr& predicate, const instruction_const_shared_ptr& if_true, const instruction_const_shared_ptr& if_false)
+    {
+        return { predicate.get(), if_true.get(), if_false.get() };
+    }
+
+    [[nodiscard]] key get_key() const { return { predicate().get(), if_true().get(), if_false().get() }; }
+
     [[nodiscard]] bool operator<(const instruction_if& other) const noexcept
     {
         if (predicate() != other.predicate())
@@ -370,6 +514,28 @@ struct instruction_for final : public instruction
         return it != inputs.end();
     }
 
+    struct key
+    {
+        const instruction* initial;
+        const instruction* condition;
+        const instruction* body;
+        const std::set<std::shared_ptr<const instruction_input>>* inputs;
+
+        [[nodiscard]] bool operator==(const key& other) const noexcept
+        {
+            return initial == other.initial && condition == other.condition && body == other.body && *inputs == *other.inputs;
+        }
+
+        [[nodiscard]] std::size_t hash() const noexcept { return hash_values(initial, condition, body); }
+    };
+
+    [[nodiscard]] static key make_key(const instruction_const_shared_ptr& initial, const instruction_const_shared_ptr& condition, const instruction_const_shared_ptr& body, const std::set<std::shared_ptr<const instruction_input>>& inputs)
+    {
+        return { initial.get(), condition.get(), body.get(), &inputs };
+    }
+
+    [[nodiscard]] key get_key() const { return { initial().get(), condition().get(), body().get(), &inputs }; }
+
     bool operator<(const instruction_for& other) const noexcept
     {
         if (initial() != other.initial())
@@ -399,6 +565,27 @@ struct instruction_indexer final : public instruction
 
     [[nodiscard]] const instruction_const_shared_ptr& for_instruction() const { return m_dependents[0]; }
 
+    struct key
+    {
+        const instruction* for_instruction;
+        int index;
+        type_const_ptr type;
+
+        [[nodiscard]] bool operator==(const key& other) const noexcept
+        {
+            return for_instruction == other.for_instruction && index == other.index && type == other.type;
+        }
+
+        [[nodiscard]] std::size_t hash() const noexcept { return hash_values(for_instruction, index, type); }
+    };
+
+    [[nodiscard]] static key make_key(const std::shared_ptr<const instruction_for>& for_instruction, int index, type_const_ptr type)
+    {
+        return { for_instruction.get(), index, type };
+    }
+
+    [[nodiscard]] key get_key() const { return { for_instruction().get(), index, actual_type }; }
+
     bool operator<(const instruction_indexer& other) const noexcept
     {
         if (for_instruction() != other.for_instruction())
@@ -425,6 +612,33 @@ struct instruction_select final : public instruction
     [[nodiscard]] const instruction_const_shared_ptr& selector() const { return m_dependents[0]; };
     [[nodiscard]] bool get_constant_value(element_value& result) const override;
 
+    struct key
+    {
+        const instruction* selector;
+        const instruction_const_shared_ptr* options;
+        size_t options_count;
+
+        [[nodiscard]] bool operator==(const key& other) const noexcept
+        {
+            return selector == other.selector && std::equal(options, options + options_count, other.options, other.options + other.options_count);
+        }
+
+        [[nodiscard]] std::size_t hash() const noexcept
+        {
+            auto hash = hash_values(selector, options_count);
+            for (size_t i = 0; i < options_count; ++i)
+                hash = (hash * 31) ^ std::hash<const instruction*>{}(options[i].get());
+            return hash;
+        }
+    };
+
+    [[nodiscard]] static key make_key(const instruction_const_shared_ptr& selector, const std::vector<instruction_const_shared_ptr>& options)
+    {
+        return { selector.get(), options.data(), options.size() };
+    }
+
+    [[nodiscard]] key get_key() const { return { selector().get(), m_dependents.data() + 1, options_count() }; }
+
     [[nodiscard]] bool operator<(const instruction_select& other) const noexcept
     {
         if (selector() != other.selector())
@@ -0,0 +1,61 @@
+#include "instrumentation.hpp"
+
+//LIBS
+#include <fmt/format.h>
+
+using namespace element;
+
+void instrumentation::reset()
+{
+    for (auto& time : times)
+        time.store(0, std::memory_order_relaxed);
+
+    for (auto& counter : counters)
+        counter.store(0, std::memory_order_relaxed);
+}
+
+void instrumentation::get(element_compilation_stats& stats) const
+{
+    const auto time = [this](compilation_phase phase) {
+        return times[static_cast<std::size_t>(phase)].load(std::memory_order_relaxed);
+    };
+
+    const auto count = [this](compilation_counter counter) {
+        return counters[static_cast<std::size_t>(counter)].load(std::memory_order_relaxed);
+    };
+
+    stats.tokenise_ns = time(compilation_phase::tokenise);
+    stats.parse_ns = time(compilation_phase::parse);
+    stats.build_object_model_ns = time(compilation_phase::build_object_model);
+    stats.compile_ns = time(compilation_phase::compile);
+    stats.instruction_cache_ns = time(compilation_phase::instruction_cache);
+    stats.lmnt_lowering_ns = time(compilation_phase::lmnt_lowering);
+    stats.calls = count(compilation_counter::calls);
+    stats.memoised_calls = count(compilation_counter::memoised_calls);
+    stats.instructions_created = count(compilation_counter::instructions_created);
+    stats.instruction_cache_hits = count(compilation_counter::instruction_cache_hits);
+    stats.scope_lookups = count(compilation_counter::scope_lookups);
+    stats.scope_lookup_cache_hits = count(compilation_counter::scope_lookup_cache_hits);
+}
+
+std::string instrumentation::to_json() const
+{
+    element_compilation_stats stats{};
+    get(stats);
+
+    return fmt::format(
+        "{{\"phase_nanoseconds\":{{\"tokenise\":{},\"parse\":{},\"build_object_model\":{},\"compile\":{},\"instruction_cache\":{},\"lmnt_lowering\":{}}},"
+        "\"counters\":{{\"calls\":{},\"memoised_calls\":{},\"instructions_created\":{},\"instruction_cache_hits\":{},\"scope_lookups\":{},\"scope_lookup_cache_hits\":{}}}}}",
+        stats.tokenise_ns,
+        stats.parse_ns,
+        stats.build_object_model_ns,
+        stats.compile_ns,
+        stats.instruction_cache_ns,
+        stats.lmnt_lowering_ns,
+        stats.calls,
+        stats.memoised_calls,
+        stats.instructions_created,
+        stats.instruction_cache_hits,
+        stats.scope_lookups,
+        stats.scope_lookup_cache_hits);
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+//STD
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+//SELF
+#include "element/interpreter.h"
+
+namespace element
+{
+enum class compilation_phase
+{
+    tokenise,
+    parse,
+    build_object_model,
+    compile,
+    instruction_cache,
+    lmnt_lowering,
+    count
+};
+
+enum class compilation_counter
+{
+    calls,
+    memoised_calls,
+    instructions_created,
+    instruction_cache_hits,
+    scope_lookups,
+    scope_lookup_cache_hits,
+    count
+};
+
+//Timers and counters for each phase of compilation, so we can tell where the time goes
+//Disabled by default, in which case recording anything is just a branch
+//Files tokenised and parsed on several threads at once sum their time across threads, so everything is atomic
+class instrumentation
+{
+public:
+    [[nodiscard]] bool is_enabled() const { return enabled.load(std::memory_order_relaxed); }
+    void set_enabled(bool enable) { enabled.store(enable, std::memory_order_relaxed); }
+
+    void add_time(compilation_phase phase, std::chrono::steady_clock::duration duration)
+    {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+        times[static_cast<std::size_t>(phase)].fetch_add(static_cast<std::uint64_t>(ns), std::memory_order_relaxed);
+    }
+
+    void increment(compilation_counter counter)
+    {
+        if (is_enabled())
+            counters[static_cast<std::size_t>(counter)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void reset();
+    void get(element_compilation_stats& stats) const;
+    [[nodiscard]] std::string to_json() const;
+
+private:
+    std::atomic<bool> enabled = false;
+    std::array<std::atomic<std::uint64_t>, static_cast<std::size_t>(compilation_phase::count)> times{};
+    std::array<std::atomic<std::uint64_t>, static_cast<std::size_t>(compilation_counter::count)> counters{};
+};
+
+//adds the time from construction to destruction to a phase, if instrumentation was enabled when it started
+class scoped_phase_timer
+{
+public:
+    scoped_phase_timer(instrumentation& stats, compilation_phase phase)
+        : stats(stats.is_enabled() ? &stats : nullptr)
+        , phase(phase)
+    {
+        if (this->stats)
+            start = std::chrono::steady_clock::now();
+    }
+
+    scoped_phase_timer(const scoped_phase_timer&) = delete;
+    scoped_phase_timer& operator=(const scoped_phase_timer&) = delete;
+
+    ~scoped_phase_timer()
+    {
+        if (stats)
+            stats->add_time(phase, std::chrono::steady_clock::now() - start);
+    }
+
+private:
+    instrumentation* stats;
+    compilation_phase phase;
+    std::chrono::steady_clock::time_point start;
+};
+} // namespace element
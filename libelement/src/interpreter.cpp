@@ -142,6 +142,32 @@ element_result element_interpreter_load_prelude(element_interpreter_ctx* interpr
     return interpreter->load_prelude();
 }
 
+element_result element_interpreter_save_snapshot(const element_interpreter_ctx* interpreter, const char* path)
+{
+    assert(interpreter);
+
+    if (!interpreter)
+        return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL;
+
+    if (!path)
+        return ELEMENT_ERROR_API_STRING_IS_NULL;
+
+    return interpreter->save_snapshot(path);
+}
+
+element_result element_interpreter_load_snapshot(element_interpreter_ctx* interpreter, const char* path)
+{
+    assert(interpreter);
+
+    if (!interpreter)
+        return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL;
+
+    if (!path)
+        return ELEMENT_ERROR_API_STRING_IS_NULL;
+
+    return interpreter->load_snapshot(path);
+}
+
 element_result element_interpreter_set_log_callback(element_interpreter_ctx* interpreter, element_log_callback log_callback, void* user_data)
 {
     assert(interpreter);
@@ -159,6 +185,26 @@ element_result element_interpreter_set_parse_only(element_interpreter_ctx* inter
         return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL;
 
     interpreter->parse_only = parse_only;
+    ++interpreter->scope_generation;
+    return ELEMENT_OK;
+}
+
+element_result element_interpreter_set_max_loop_iterations(element_interpreter_ctx* interpreter, size_t max_loop_iterations)
+{
+    if (!interpreter)
+        return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL;
+
+    interpreter->max_loop_iterations = max_loop_iterations;
+    ++interpreter->scope_generation;
+    return ELEMENT_OK;
+}
+
+element_result element_interpreter_set_load_worker_count(element_interpreter_ctx* interpreter, size_t worker_count)
+{
+    if (!interpreter)
+        return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL;
+
+    interpreter->load_worker_count = worker_count;
     return ELEMENT_OK;
 }
 
@@ -298,6 +344,35 @@ element_result element_interpreter_find(const element_interpreter_ctx* interpret
     return ELEMENT_OK;
 }
 
+element_result element_interpreter_remove(element_interpreter_ctx* interpreter, const char* name)
+{
+    if (!interpreter)
+        return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL;
+
+    if (!name)
+        return ELEMENT_ERROR_API_STRING_IS_NULL;
+
+    const element::identifier identifier{ name };
+    const auto& declarations = interpreter->global_scope->get_declarations();
+    const auto it = declarations.find(identifier);
+    if (it == declarations.end())
+        return ELEMENT_ERROR_IDENTIFIER_NOT_FOUND;
+
+    const char* filename = it->second->source_info.filename;
+    interpreter->global_scope->remove_declaration(identifier, interpreter->cache_scope_find);
+    ++interpreter->scope_generation;
+
+    //once nothing from a file is left, neither is anything which could report an error in it, so its source can go too
+    //otherwise a process which keeps loading and removing declarations, e.g. the CLI's serve command, holds on to all of them
+    const bool file_still_used = std::any_of(declarations.begin(), declarations.end(), [filename](const auto& declaration) {
+        return declaration.second->source_info.filename == filename;
+    });
+    if (filename && !file_still_used)
+        interpreter->src_context->file_info.erase(filename);
+
+    return ELEMENT_OK;
+}
+
 element_result element_declaration_get_name(const element_declaration* decl, char* buffer, size_t* bufsize)
 {
     if (!decl || !decl->decl)
@@ -428,6 +503,7 @@ element_result element_interpreter_compile_declaration(
     if (!options)
         options = &element_compiler_options_default;
 
+    element::scoped_phase_timer timer(interpreter->stats, element::compilation_phase::compile);
     const element::compilation_context compilation_context(interpreter->global_scope.get(), interpreter);
 
     const bool declaration_is_nullary = declaration->decl->get_inputs().empty();
@@ -531,6 +607,15 @@ element_result element_interpreter_compile_expression(
     if (!instruction)
         return ELEMENT_ERROR_API_OUTPUT_IS_NULL;
 
+    const auto key = compiled_expression_cache::make_key(options, expression_string);
+    if (auto cached = interpreter->compiled_expressions.find(key, interpreter->scope_generation)) {
+        element::instruction_cache cache(cached.get());
+        *instruction = new element_instruction{ std::move(cached), std::move(cache) };
+        return ELEMENT_OK;
+    }
+
+    element::scoped_phase_timer timer(interpreter->stats, element::compilation_phase::compile);
+
     element_object* object_ptr;
     auto result = interpreter->expression_to_object(options, expression_string, &object_ptr);
 
@@ -553,6 +638,7 @@ element_result element_interpreter_compile_expression(
             return ELEMENT_ERROR_UNKNOWN;
         }
 
+        interpreter->compiled_expressions.insert(key, instr, interpreter->scope_generation);
         (*instruction)->instruction = std::move(instr);
         element_object_delete(&object_ptr);
         return ELEMENT_OK;
@@ -588,12 +674,91 @@ element_result element_interpreter_compile_expression(
         return ELEMENT_ERROR_UNKNOWN;
     }
 
+    interpreter->compiled_expressions.insert(key, instr, interpreter->scope_generation);
     element::instruction_cache cache(instr.get());
     *instruction = new element_instruction{ std::move(instr), std::move(cache) };
     element_object_delete(&object_ptr);
     return ELEMENT_OK;
 }
 
+element_result element_interpreter_set_expression_cache_capacity(element_interpreter_ctx* interpreter, size_t capacity)
+{
+    if (!interpreter)
+        return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL;
+
+    interpreter->compiled_expressions.set_capacity(capacity);
+    return ELEMENT_OK;
+}
+
+element_result element_interpreter_get_expression_cache_stats(const element_interpreter_ctx* interpreter, element_expression_cache_stats* stats)
+{
+    if (!interpreter)
+        return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL;
+
+    if (!stats)
+        return ELEMENT_ERROR_API_OUTPUT_IS_NULL;
+
+    const auto& cache = interpreter->compiled_expressions;
+    stats->hits = cache.hits;
+    stats->misses = cache.misses;
+    stats->size = cache.size();
+    stats->capacity = cache.capacity;
+    return ELEMENT_OK;
+}
+
+element_result element_interpreter_set_compilation_stats_enabled(element_interpreter_ctx* interpreter, bool enabled)
+{
+    if (!interpreter)
+        return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL;
+
+    interpreter->stats.set_enabled(enabled);
+    return ELEMENT_OK;
+}
+
+element_result element_interpreter_reset_compilation_stats(element_interpreter_ctx* interpreter)
+{
+    if (!interpreter)
+        return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL;
+
+    interpreter->stats.reset();
+    return ELEMENT_OK;
+}
+
+element_result element_interpreter_get_compilation_stats(const element_interpreter_ctx* interpreter, element_compilation_stats* stats)
+{
+    if (!interpreter)
+        return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL;
+
+    if (!stats)
+        return ELEMENT_ERROR_API_OUTPUT_IS_NULL;
+
+    interpreter->stats.get(*stats);
+    return ELEMENT_OK;
+}
+
+element_result element_interpreter_get_compilation_stats_json(const element_interpreter_ctx* interpreter, char* buffer, size_t* bufsize)
+{
+    if (!interpreter)
+        return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL;
+
+    if (!bufsize)
+        return ELEMENT_ERROR_API_OUTPUT_IS_NULL;
+
+    const auto json = interpreter->stats.to_json();
+    const auto current_bufsize = *bufsize;
+    *bufsize = json.size() + 1;
+
+    if (buffer) {
+        if (json.size() + 1 > current_bufsize)
+            return ELEMENT_ERROR_API_INSUFFICIENT_BUFFER;
+
+        std::copy(json.begin(), json.end(), buffer);
+        buffer[json.size()] = '\0';
+    }
+
+    return ELEMENT_OK;
+}
+
 element_result element_evaluator_create(element_interpreter_ctx* interpreter, element_evaluator_ctx** evaluator)
 {
     if (!interpreter)
@@ -656,24 +821,25 @@ element_result element_interpreter_evaluate_expression(
     if (!outputs)
         return ELEMENT_ERROR_API_INVALID_INPUT;
 
-    element_instruction instruction;
-    auto* instruction_ptr = &instruction;
-    auto result = element_interpreter_compile_expression(interpreter, nullptr, expression_string, &instruction_ptr);
+    element_instruction* instruction = nullptr;
+    auto result = element_interpreter_compile_expression(interpreter, nullptr, expression_string, &instruction);
     if (result != ELEMENT_OK) {
+        element_instruction_delete(&instruction);
         outputs->count = 0;
         return result;
     }
 
     constexpr auto log_expression_tree = flag_set(logging_bitmask, log_flags::debug | log_flags::output_instruction_tree);
     if constexpr (log_expression_tree)
-        interpreter->log("\n------\nINSTRUCTION TREE\n------\n" + instruction_to_string(*instruction.instruction));
+        interpreter->log("\n------\nINSTRUCTION TREE\n------\n" + instruction_to_string(*instruction->instruction));
 
     float inputs[] = { 0 };
     element_inputs input;
     input.values = inputs;
     input.count = 1;
 
-    result = element_interpreter_evaluate_instruction(interpreter, evaluator, instruction_ptr, &input, outputs);
+    result = element_interpreter_evaluate_instruction(interpreter, evaluator, instruction, &input, outputs);
+    element_instruction_delete(&instruction);
 
     return result;
 }
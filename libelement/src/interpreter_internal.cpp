@@ -4,7 +4,10 @@
 #include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <memory>
+#include <mutex>
+#include <unordered_set>
 
 //LIBS
 #include <fmt/format.h>
@@ -12,6 +15,7 @@
 //SELF
 #include "element/ast.h"
 #include "instruction_tree/evaluator.hpp"
+#include "ast/ast_internal.hpp"
 #include "ast/parser_internal.hpp"
 #include "common_internal.hpp"
 #include "token_internal.hpp"
@@ -24,6 +28,8 @@
 #include "object_model/expressions/call_expression.hpp"
 #include "object_model/declarations/function_declaration.hpp"
 #include "filesystem.hpp"
+#include "parallel.hpp"
+#include "snapshot.hpp"
 
 static bool file_exists(const std::string& file)
 {
@@ -35,11 +41,32 @@ static bool directory_exists(const std::string& directory)
     return fs::exists(directory) && fs::is_directory(directory);
 }
 
-element_result element_interpreter_ctx::load_into_scope(const char* str, const char* filename, element::scope* src_scope)
+static std::string package_directory(const std::string& package)
+{
+    const auto last_dash = package.find_last_of('-');
+    auto actual_package_name = package;
+    if (last_dash != std::string::npos)
+        actual_package_name = package.substr(0, last_dash);
+
+    return "ElementPackages/" + actual_package_name;
+}
+
+static bool should_log(const std::string& filename, log_flags output)
 {
     //HACK: JM - Not a fan of this...
-    const std::string file = filename;
-    const auto starts_with_prelude = file.rfind("Prelude/", 0) == 0;
+    const auto starts_with_prelude = filename.rfind("Prelude/", 0) == 0;
+    return starts_with_prelude
+        ? flag_set(logging_bitmask, log_flags::output_prelude) && flag_set(logging_bitmask, output)
+        : flag_set(logging_bitmask, log_flags::debug | output);
+}
+
+element_result element_interpreter_ctx::load_into_scope(const char* str, const char* filename, element::scope* src_scope)
+{
+    return load_into_scope(std::make_shared<const element::source_buffer>(str), filename, src_scope);
+}
+
+element_result element_interpreter_ctx::load_into_scope(std::shared_ptr<const element::source_buffer> source, const char* filename, element::scope* src_scope, element::snapshot_file* loaded)
+{
     element_tokeniser_ctx* tokeniser;
     ELEMENT_OK_OR_RETURN(element_tokeniser_create(&tokeniser));
 
@@ -55,22 +82,18 @@ element_result element_interpreter_ctx::load_into_scope(const char* str, const c
     element::file_information info;
     info.file_name = std::make_unique<std::string>(filename);
     //pass the pointer to the filename, so that the pointer stored in tokens matches the one we have
-    ELEMENT_OK_OR_RETURN(element_tokeniser_run(tokeniser, str, info.file_name.get()->data()));
-    const auto total_lines_parsed = tokeniser->line;
-
-    for (auto i = 0; i < total_lines_parsed; ++i) {
-        //lines start at 1
-        info.source_lines.emplace_back(std::make_unique<std::string>(tokeniser->text_on_line(i + 1)));
+    {
+        element::scoped_phase_timer timer(stats, element::compilation_phase::tokenise);
+        ELEMENT_OK_OR_RETURN(tokeniser->run(source, info.file_name.get()->data()));
     }
+    if (loaded)
+        loaded->hash = element::hash_source(source->text());
+    info.set_source(std::move(source), tokeniser->line_number_to_line_pos);
 
     auto* const data = info.file_name->data();
     src_context->file_info[data] = std::move(info);
 
-    const auto log_tokens = starts_with_prelude
-        ? flag_set(logging_bitmask, log_flags::output_prelude) && flag_set(logging_bitmask, log_flags::output_tokens)
-        : flag_set(logging_bitmask, log_flags::debug | log_flags::output_tokens);
-
-    if (log_tokens) {
+    if (should_log(filename, log_flags::output_tokens)) {
         log("\n------\nTOKENS\n------\n" + tokens_to_string(tokeniser));
     }
 
@@ -79,32 +102,47 @@ element_result element_interpreter_ctx::load_into_scope(const char* str, const c
     parser.logger = logger;
     parser.src_context = src_context;
 
-    auto result = parser.ast_build();
+    auto result = ELEMENT_OK;
+    {
+        element::scoped_phase_timer timer(stats, element::compilation_phase::parse);
+        result = parser.ast_build();
+    }
     ELEMENT_OK_OR_RETURN(result);
 
-    const auto log_ast = starts_with_prelude
-        ? flag_set(logging_bitmask, log_flags::output_prelude) && flag_set(logging_bitmask, log_flags::output_ast)
-        : flag_set(logging_bitmask, log_flags::debug | log_flags::output_ast);
-
-    if (log_ast) {
+    if (should_log(filename, log_flags::output_ast)) {
         log("\n---\nAST\n---\n" + ast_to_string(parser.root));
     }
 
+    result = build_into_scope(parser.root, filename, src_scope);
+    if (!loaded) {
+        element_ast_delete(&parser.root);
+        return result;
+    }
+
+    //moving the tokens keeps their addresses, so the AST's pointers in to them stay valid
+    loaded->line_offsets = tokeniser->line_number_to_line_pos;
+    loaded->tokens = std::move(tokeniser->tokens);
+    loaded->root = parser.root;
+    return result;
+}
+
+element_result element_interpreter_ctx::build_into_scope(const element_ast* root, const char* filename, element::scope* src_scope)
+{
     //parse only enabled, skip object model generation to avoid error codes with positive values
     //i.e. errors returned other than ELEMENT_ERROR_PARSE
-    if (parse_only) {
-        element_ast_delete(&parser.root);
+    if (parse_only)
         return ELEMENT_OK;
-    }
 
-    auto object_model = element::build_root_scope(this, parser.root, result);
-    element_ast_delete(&parser.root);
+    element::scoped_phase_timer timer(stats, element::compilation_phase::build_object_model);
+    auto result = ELEMENT_OK;
+    auto object_model = element::build_root_scope(this, root, result);
 
     if (result != ELEMENT_OK) {
         log(result, fmt::format("building object model failed with element_result {}", result), filename);
         return result;
     }
 
+    ++scope_generation;
     result = src_scope->merge(std::move(object_model));
     if (result != ELEMENT_OK) {
         log(result, fmt::format("merging object models failed with element_result {}", result), filename);
@@ -119,7 +157,7 @@ element_result element_interpreter_ctx::load(const char* str, const char* filena
     return load_into_scope(str, filename, global_scope.get());
 }
 
-element_result element_interpreter_ctx::load_file(const std::string& file)
+element_result element_interpreter_ctx::find_source_file(const std::string& file, std::string& abs) const
 {
     const auto extension = fs::path(file).extension().string();
     if (extension != ".ele") {
@@ -129,7 +167,7 @@ element_result element_interpreter_ctx::load_file(const std::string& file)
         return result;
     }
 
-    const auto abs = fs::absolute(fs::path(file)).string();
+    abs = fs::absolute(fs::path(file)).string();
 
     if (!file_exists(abs)) {
         std::string msg = fmt::format("File not file:  {} was not found at path {}\n", file, abs.c_str());
@@ -138,39 +176,159 @@ element_result element_interpreter_ctx::load_file(const std::string& file)
         return result;
     }
 
-    std::string buffer;
+    return ELEMENT_OK;
+}
+
+element_result element_interpreter_ctx::load_file(const std::string& file)
+{
+    std::string abs;
+    ELEMENT_OK_OR_RETURN(find_source_file(file, abs));
+
+    auto source = element::source_buffer::from_file(abs);
+    if (!source) {
+        element_result result = ELEMENT_ERROR_FILE_NOT_FOUND;
+        log(result, fmt::format("'{}' could not be opened", abs), file);
+        return result;
+    }
 
-    std::ifstream f(abs);
-    f.seekg(0, std::ios::end);
-    buffer.resize(f.tellg());
-    f.seekg(0);
-    f.read(buffer.data(), buffer.size());
+    auto loaded = std::make_unique<element::snapshot_file>();
+    loaded->path = abs;
+    const auto result = load_into_scope(std::move(source), abs.c_str(), global_scope.get(), loaded.get());
+    if (result == ELEMENT_OK)
+        loaded_files.push_back(std::move(loaded));
 
-    const auto result = load(buffer.c_str(), abs.c_str());
     return result;
 }
 
+void element_interpreter_ctx::load_files_in_order(const std::vector<std::string>& files, std::vector<element_result>& results)
+{
+    results.assign(files.size(), ELEMENT_OK);
+
+    const auto worker_count = element::resolve_worker_count(load_worker_count, files.size());
+    if (worker_count == 1) {
+        for (std::size_t i = 0; i < files.size(); ++i)
+            results[i] = load_file(files[i]);
+        return;
+    }
+
+    struct parsed_file
+    {
+        std::string path;
+        std::uint64_t hash = 0;
+        element::file_information* info = nullptr;
+        element_tokeniser_ctx* tokeniser = nullptr;
+        element_parser_ctx parser;
+    };
+    std::vector<parsed_file> parsed(files.size());
+
+    //the source context is shared by every parser, so everything is added to it up front and only read while parsing
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        results[i] = find_source_file(files[i], parsed[i].path);
+        if (results[i] != ELEMENT_OK)
+            continue;
+
+        element::file_information info;
+        info.file_name = std::make_unique<std::string>(parsed[i].path);
+        auto* const data = info.file_name->data();
+        parsed[i].info = &(src_context->file_info[data] = std::move(info));
+    }
+
+    //the log callback might not be thread-safe, so messages from the workers are passed on to it one at a time
+    struct serialised_log
+    {
+        std::mutex mutex;
+        std::shared_ptr<element_log_ctx> logger;
+    } serialised{ {}, logger };
+
+    std::shared_ptr<element_log_ctx> worker_logger;
+    if (logger) {
+        worker_logger = std::make_shared<element_log_ctx>();
+        worker_logger->user_data = &serialised;
+        worker_logger->callback = [](const element_log_message* msg, void* user_data) {
+            auto* log = static_cast<serialised_log*>(user_data);
+            std::lock_guard<std::mutex> lock(log->mutex);
+            if (log->logger->callback)
+                log->logger->callback(msg, log->logger->user_data);
+        };
+    }
+
+    //tokenising and parsing each file only touches that file's state, so can be spread across workers
+    element::run_parallel(files.size(), worker_count, [&](std::size_t i) {
+        if (results[i] != ELEMENT_OK)
+            return results[i];
+
+        auto& file = parsed[i];
+        auto source = element::source_buffer::from_file(file.path);
+        if (!source)
+            return results[i] = ELEMENT_ERROR_FILE_NOT_FOUND;
+
+        results[i] = element_tokeniser_create(&file.tokeniser);
+        if (results[i] != ELEMENT_OK)
+            return results[i];
+
+        file.tokeniser->logger = worker_logger;
+        {
+            element::scoped_phase_timer timer(stats, element::compilation_phase::tokenise);
+            results[i] = file.tokeniser->run(source, file.info->file_name->data());
+        }
+        if (results[i] != ELEMENT_OK)
+            return results[i];
+
+        file.hash = element::hash_source(source->text());
+        file.info->set_source(std::move(source), file.tokeniser->line_number_to_line_pos);
+
+        file.parser.tokeniser = file.tokeniser;
+        file.parser.logger = worker_logger;
+        file.parser.src_context = src_context;
+        element::scoped_phase_timer timer(stats, element::compilation_phase::parse);
+        results[i] = file.parser.ast_build();
+        return results[i];
+    });
+
+    //building the object models and merging them in to the global scope happens in file order, as if they'd been loaded one at a time
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        auto& file = parsed[i];
+        if (results[i] == ELEMENT_OK) {
+            if (should_log(file.path, log_flags::output_tokens))
+                log("\n------\nTOKENS\n------\n" + tokens_to_string(file.tokeniser));
+
+            if (should_log(file.path, log_flags::output_ast))
+                log("\n---\nAST\n---\n" + ast_to_string(file.parser.root));
+
+            results[i] = build_into_scope(file.parser.root, file.info->file_name->data(), global_scope.get());
+            if (results[i] == ELEMENT_OK) {
+                auto loaded = std::make_unique<element::snapshot_file>();
+                loaded->path = file.path;
+                loaded->hash = file.hash;
+                loaded->line_offsets = file.tokeniser->line_number_to_line_pos;
+                loaded->tokens = std::move(file.tokeniser->tokens);
+                loaded->root = file.parser.root;
+                file.parser.root = nullptr;
+                loaded_files.push_back(std::move(loaded));
+            }
+        }
+
+        element_ast_delete(&file.parser.root);
+        element_tokeniser_delete(&file.tokeniser);
+    }
+}
+
 element_result element_interpreter_ctx::load_files(const std::vector<std::string>& files)
 {
-    element_result ret = ELEMENT_OK;
+    std::vector<element_result> results;
+    load_files_in_order(files, results);
 
-    for (const auto& filename : files) {
-        const element_result result = load_file(filename);
-        if (result != ELEMENT_OK && ret == ELEMENT_OK) //todo: only returns first error
-            ret = result;
+    for (const auto result : results) {
+        if (result != ELEMENT_OK) //todo: only returns first error
+            return result;
     }
 
-    return ret;
+    return ELEMENT_OK;
 }
 
 element_result element_interpreter_ctx::load_package(const std::string& package)
 {
-    const auto last_dash = package.find_last_of('-');
-    auto actual_package_name = package;
-    if (last_dash != std::string::npos)
-        actual_package_name = package.substr(0, last_dash);
-
-    auto package_path = "ElementPackages/" + actual_package_name;
+    const auto package_path = package_directory(package);
     if (!directory_exists(package_path)) {
         auto abs = fs::absolute(fs::path(package_path)).string();
         std::string msg = fmt::format("package '{}' does not exist at path '{}'\n",
@@ -180,20 +338,15 @@ element_result element_interpreter_ctx::load_package(const std::string& package)
         return result;
     }
 
-    element_result ret = ELEMENT_OK;
+    loaded_packages.push_back({ package, fs::absolute(fs::path(package_path)).string() });
+    std::vector<std::string> files;
 
     for (const auto& file : fs::recursive_directory_iterator(package_path)) {
         const auto filename = file.path().string();
         const auto extension = file.path().extension().string();
 
         if (extension == ".ele") {
-            const element_result result = load_file(file.path().string());
-            if (result != ELEMENT_OK && ret == ELEMENT_OK) {
-                std::string msg = fmt::format("Error when loading '.ele' file '{}' in package '{}'.\n",
-                    package_path, filename);
-                log(msg);
-                ret = result;
-            }
+            files.push_back(filename);
         } else if (extension != ".bond") {
             std::string msg = fmt::format("Unexpected file in package '{}'. File '{}' has extension '{}' instead of '.ele' or '.bond'\n",
                 package_path, filename, extension);
@@ -201,7 +354,19 @@ element_result element_interpreter_ctx::load_package(const std::string& package)
         }
     }
 
-    return ret;
+    std::vector<element_result> results;
+    load_files_in_order(files, results);
+
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        if (results[i] != ELEMENT_OK) {
+            std::string msg = fmt::format("Error when loading '.ele' file '{}' in package '{}'.\n",
+                package_path, files[i]);
+            log(msg);
+            return results[i];
+        }
+    }
+
+    return ELEMENT_OK;
 }
 
 element_result element_interpreter_ctx::load_packages(const std::vector<std::string>& packages)
@@ -228,6 +393,125 @@ element_result element_interpreter_ctx::load_prelude()
     return result;
 }
 
+element_result element_interpreter_ctx::save_snapshot(const std::string& path) const
+{
+    element::snapshot_writer writer(prelude_loaded, loaded_packages, loaded_files.size());
+
+    for (const auto& file : loaded_files)
+        writer.write_file(*file);
+
+    std::ofstream out(path, std::ios::binary);
+    out.write(writer.data().data(), static_cast<std::streamsize>(writer.data().size()));
+    if (!out) {
+        element_result result = ELEMENT_ERROR_INVALID_SNAPSHOT;
+        log(result, fmt::format("failed to write snapshot to '{}'", path), path);
+        return result;
+    }
+
+    return ELEMENT_OK;
+}
+
+element_result element_interpreter_ctx::load_snapshot(const std::string& path)
+{
+    if (!file_exists(path)) {
+        element_result result = ELEMENT_ERROR_FILE_NOT_FOUND;
+        log(result, fmt::format("snapshot '{}' was not found", path), path);
+        return result;
+    }
+
+    std::string data;
+    {
+        std::ifstream f(path, std::ios::binary);
+        data.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    }
+
+    element::snapshot_reader reader(std::move(data));
+    bool snapshot_has_prelude = false;
+    std::vector<element::snapshot_package> packages;
+    std::size_t file_count = 0;
+    if (!reader.read_header(snapshot_has_prelude, packages, file_count)) {
+        element_result result = ELEMENT_ERROR_INVALID_SNAPSHOT;
+        log(result, fmt::format("'{}' is not a snapshot from this version of element", path), path);
+        return result;
+    }
+
+    if (snapshot_has_prelude && prelude_loaded)
+        return ELEMENT_ERROR_PRELUDE_ALREADY_LOADED;
+
+    element_result ret = ELEMENT_OK;
+    std::unordered_set<std::string> snapshot_files;
+
+    for (std::size_t i = 0; i < file_count; ++i) {
+        auto file = std::make_unique<element::snapshot_file>();
+        if (!reader.read_file_header(*file)) {
+            element_result result = ELEMENT_ERROR_INVALID_SNAPSHOT;
+            log(result, fmt::format("snapshot '{}' is truncated or corrupt", path), path);
+            return result;
+        }
+
+        snapshot_files.insert(file->path);
+
+        //files which have changed since the snapshot was taken are loaded from source instead, and removed files are dropped
+        auto source = file_exists(file->path) ? element::source_buffer::from_file(file->path) : nullptr;
+        if (!source || element::hash_source(source->text()) != file->hash) {
+            reader.skip_file_contents();
+            if (!source)
+                continue;
+
+            const auto result = load_into_scope(std::move(source), file->path.c_str(), global_scope.get(), file.get());
+            if (result == ELEMENT_OK)
+                loaded_files.push_back(std::move(file));
+            else if (ret == ELEMENT_OK)
+                ret = result;
+            continue;
+        }
+
+        if (!reader.read_file_contents(*file)) {
+            element_result result = ELEMENT_ERROR_INVALID_SNAPSHOT;
+            log(result, fmt::format("snapshot '{}' is truncated or corrupt", path), path);
+            return result;
+        }
+
+        //the source is unchanged, so its lines can come from the file we've just read
+        file->info.set_source(std::move(source), file->line_offsets);
+
+        //pass the pointer to the filename, so that it matches the one the snapshot's tokens refer to
+        const char* filename = file->info.file_name->data();
+        src_context->file_info[filename] = std::move(file->info);
+
+        const auto result = build_into_scope(file->root, filename, global_scope.get());
+        if (result == ELEMENT_OK)
+            loaded_files.push_back(std::move(file));
+        else if (ret == ELEMENT_OK)
+            ret = result;
+    }
+
+    //files which have been added to the packages since the snapshot was taken, found from where the packages were
+    //rather than the working directory, which may not be the one the snapshot was saved from
+    for (const auto& package : packages) {
+        if (!directory_exists(package.root))
+            continue;
+
+        loaded_packages.push_back(package);
+        for (const auto& file : fs::recursive_directory_iterator(package.root)) {
+            if (file.path().extension().string() != ".ele")
+                continue;
+
+            if (snapshot_files.count(file.path().string()) != 0)
+                continue;
+
+            const auto result = load_file(file.path().string());
+            if (result != ELEMENT_OK && ret == ELEMENT_OK)
+                ret = result;
+        }
+    }
+
+    if (snapshot_has_prelude)
+        prelude_loaded = (ret == ELEMENT_OK);
+
+    return ret;
+}
+
 void element_interpreter_ctx::set_log_callback(LogCallback callback, void* user_data)
 {
     logger = std::make_shared<element_log_ctx>();
@@ -287,11 +571,8 @@ element_result element_interpreter_ctx::call_expression_to_objects(
     if (tokeniser->tokens.empty())
         return ELEMENT_OK;
 
-    const auto total_lines_parsed = tokeniser->line;
 
-    //lines start at 1
-    for (auto i = 0; i < total_lines_parsed; ++i)
-        info.source_lines.emplace_back(std::make_unique<std::string>(tokeniser->text_on_line(i + 1)));
+    info.set_source(tokeniser->source, tokeniser->line_number_to_line_pos);
 
     auto* const data = info.file_name->data();
     //todo: remove file_info added to interpreter source interpreter
@@ -307,7 +588,8 @@ element_result element_interpreter_ctx::call_expression_to_objects(
     parser.logger = logger;
     parser.src_context = src_context;
 
-    element_ast root(nullptr);
+    element::ast_arena arena;
+    element_ast& root = *arena.new_root();
     parser.root = &root;
     parser.current_token = tokeniser->get_token(0, result);
     root.nearest_token = parser.current_token;
@@ -396,11 +678,8 @@ element_result element_interpreter_ctx::expression_to_object(
     if (tokeniser->tokens.empty())
         return ELEMENT_OK;
 
-    const auto total_lines_parsed = tokeniser->line;
 
-    //lines start at 1
-    for (auto i = 0; i < total_lines_parsed; ++i)
-        info.source_lines.emplace_back(std::make_unique<std::string>(tokeniser->text_on_line(i + 1)));
+    info.set_source(tokeniser->source, tokeniser->line_number_to_line_pos);
 
     auto* const data = info.file_name->data();
     //todo: remove file_info added to interpreter source interpreter
@@ -416,7 +695,8 @@ element_result element_interpreter_ctx::expression_to_object(
     parser.logger = logger;
     parser.src_context = src_context;
 
-    element_ast root(nullptr);
+    element::ast_arena arena;
+    element_ast& root = *arena.new_root();
     parser.root = &root;
     parser.current_token = tokeniser->get_token(0, result);
     root.nearest_token = parser.current_token;
@@ -487,6 +767,8 @@ element_interpreter_ctx::element_interpreter_ctx()
 
 element_result element_interpreter_ctx::clear()
 {
+    ++scope_generation;
+
     //todo: ?
     //trees.clear();
     //names.reset();
@@ -1,11 +1,16 @@
 #pragma once
 
 //STD
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <list>
 #include <vector>
 #include <string>
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 
 //SELF
 #include "element/interpreter.h"
@@ -14,6 +19,8 @@
 #include "object_model/scope_caches.hpp"
 #include "instruction_tree/instructions.hpp"
 #include "instruction_tree/cache.hpp"
+#include "instrumentation.hpp"
+#include "snapshot.hpp"
 
 struct element_declaration
 {
@@ -62,38 +69,151 @@ struct element_evaluator_ctx
     element_evaluator_options options;
 };
 
+//Hash-conses instructions, so that structurally identical instructions are the same object
+//Instructions are found by a key made from the arguments they'd be created with, so nothing is created when they
+//already exist. Entries are only weakly held, so instructions are released once nothing else is using them
 template <typename Instruction>
 class compiletime_instruction_cache
 {
 public:
-    class compare_instruction
+    explicit compiletime_instruction_cache(element::instrumentation& stats)
+        : stats(stats)
+    {}
+
+    template <typename... Args>
+    std::shared_ptr<const Instruction> get(Args&&... args)
     {
-    public:
-        constexpr bool operator()(const std::shared_ptr<const Instruction>& a, const std::shared_ptr<const Instruction>& b) const
+        static_assert(std::is_base_of_v<element::instruction, Instruction>, "This cache is meant to be used for element::instruction only");
+
+        element::scoped_phase_timer timer(stats, element::compilation_phase::instruction_cache);
+
+        //the key refers to the arguments, so it's finished with before they're forwarded on
+        std::size_t hash;
         {
-            // When comparing shared_ptr's of instructions, we want to go through the instructions' operator `<`, as each one will have its own specific way of comparing
-            if (a && b && a != b)
-                return *a < *b;
+            const auto key = Instruction::make_key(std::as_const(args)...);
+            hash = key.hash();
+
+            auto [it, end] = entries.equal_range(hash);
+            while (it != end) {
+                auto existing = it->second.lock();
+                if (!existing) {
+                    it = entries.erase(it);
+                    continue;
+                }
 
-            // Comparing the shared_ptr compares the underlying raw pointer
-            return a < b;
+                if (existing->get_key() == key) {
+                    stats.increment(element::compilation_counter::instruction_cache_hits);
+                    return existing;
+                }
+
+                ++it;
+            }
         }
-    };
 
-    using cache = std::set<std::shared_ptr<const Instruction>, compare_instruction>;
+        auto instruction = std::make_shared<const Instruction>(std::forward<Args>(args)...);
+        entries.emplace(hash, instruction);
+        stats.increment(element::compilation_counter::instructions_created);
 
-    template <typename... Args>
-    std::shared_ptr<const Instruction> get(Args&&... args)
+        if (entries.size() >= sweep_threshold)
+            sweep();
+
+        return instruction;
+    }
+
+    [[nodiscard]] std::size_t size() const { return entries.size(); }
+
+private:
+    //expired entries are also removed when they're found by a lookup, but that never happens for ones nobody asks for again
+    void sweep()
     {
-        static_assert(std::is_base_of_v<element::instruction, Instruction>, "This cache is meant to be used for element::instruction only");
+        for (auto it = entries.begin(); it != entries.end();)
+            it = it->second.expired() ? entries.erase(it) : std::next(it);
 
-        auto instruction = std::make_shared<const Instruction>(std::forward<Args&&>(args)...);
-        auto&& [iterator, inserted] = m_cache.emplace(std::move(instruction));
-        return *iterator;
+        sweep_threshold = (std::max)(minimum_sweep_threshold, entries.size() * 2);
+    }
+
+    static constexpr std::size_t minimum_sweep_threshold = 1024;
+
+    element::instrumentation& stats;
+    std::unordered_multimap<std::size_t, std::weak_ptr<const Instruction>> entries;
+    std::size_t sweep_threshold = minimum_sweep_threshold;
+};
+
+//most recently used compiled expressions, so that evaluating the same expression repeatedly doesn't parse and compile it every time
+//entries are only valid for the generation of the global scope they were compiled against
+class compiled_expression_cache
+{
+public:
+    using instruction_ptr = std::shared_ptr<const element::instruction>;
+
+    std::size_t capacity = 64;
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+
+    [[nodiscard]] static std::string make_key(const element_compiler_options* options, const char* expression)
+    {
+        //options are part of the key as they change whether compilation succeeds, no options is distinct from the defaults
+        std::string key(1, options ? static_cast<char>(options->check_valid_boundary_function | (options->check_valid_boundary_function_when_nullary << 1)) : '\xff');
+        key += expression;
+        return key;
     }
 
+    instruction_ptr find(const std::string& key, std::uint64_t scope_generation)
+    {
+        invalidate_if_stale(scope_generation);
+
+        const auto it = entries.find(key);
+        if (it == entries.end()) {
+            ++misses;
+            return nullptr;
+        }
+
+        ++hits;
+        recently_used.splice(recently_used.begin(), recently_used, it->second);
+        return it->second->second;
+    }
+
+    void insert(const std::string& key, instruction_ptr instruction, std::uint64_t scope_generation)
+    {
+        invalidate_if_stale(scope_generation);
+        if (capacity == 0 || entries.count(key) != 0)
+            return;
+
+        recently_used.emplace_front(key, std::move(instruction));
+        entries.emplace(key, recently_used.begin());
+        trim();
+    }
+
+    void set_capacity(std::size_t new_capacity)
+    {
+        capacity = new_capacity;
+        trim();
+    }
+
+    [[nodiscard]] std::size_t size() const { return entries.size(); }
+
 private:
-    cache m_cache;
+    void invalidate_if_stale(std::uint64_t scope_generation)
+    {
+        if (scope_generation == generation)
+            return;
+
+        entries.clear();
+        recently_used.clear();
+        generation = scope_generation;
+    }
+
+    void trim()
+    {
+        while (entries.size() > capacity) {
+            entries.erase(recently_used.back().first);
+            recently_used.pop_back();
+        }
+    }
+
+    std::uint64_t generation = 0;
+    std::list<std::pair<std::string, instruction_ptr>> recently_used;
+    std::unordered_map<std::string, decltype(recently_used)::iterator> entries;
 };
 
 struct element_interpreter_ctx
@@ -102,12 +222,16 @@ public:
     element_interpreter_ctx();
 
     element_result load_into_scope(const char* str, const char* filename, element::scope*);
+    //if loaded is given, the file's hash, tokens and AST are moved in to it rather than being discarded
+    element_result load_into_scope(std::shared_ptr<const element::source_buffer> source, const char* filename, element::scope*, element::snapshot_file* loaded = nullptr);
     element_result load(const char* str, const char* filename = "<input>");
     element_result load_file(const std::string& file);
     element_result load_files(const std::vector<std::string>& files);
     element_result load_package(const std::string& package);
     element_result load_packages(const std::vector<std::string>& packages);
     element_result load_prelude();
+    element_result save_snapshot(const std::string& path) const;
+    element_result load_snapshot(const std::string& path);
     element_result clear();
     void set_log_callback(LogCallback callback, void* user_data);
     void log(element_result message_code, const std::string& message, const std::string& filename) const;
@@ -127,21 +251,39 @@ public:
     using intrinsic_map_type = std::unordered_map<const element::declaration*, std::unique_ptr<const element::intrinsic>>;
     mutable intrinsic_map_type intrinsic_map;
 
+    //what has been loaded, in order, so that it can be saved to a snapshot without parsing anything again
+    std::vector<std::unique_ptr<element::snapshot_file>> loaded_files;
+    std::vector<element::snapshot_package> loaded_packages;
+
+    //incremented whenever anything which could change the result of compiling an expression changes, e.g. loading more source
+    std::uint64_t scope_generation = 0;
+    mutable compiled_expression_cache compiled_expressions;
+
     bool parse_only = false;
+    std::size_t max_loop_iterations = 10'000;
+    //how many threads tokenise and parse files when loading several at once, or 0 for one per hardware thread
+    std::size_t load_worker_count = 1;
     bool prelude_loaded = false;
     std::shared_ptr<element_log_ctx> logger;
     std::shared_ptr<element::source_context> src_context;
     std::unique_ptr<element::scope> global_scope;
 
-    mutable element::scope_caches cache_scope_find;
-    mutable compiletime_instruction_cache<element::instruction_constant> cache_instruction_constant;
-    mutable compiletime_instruction_cache<element::instruction_nullary> cache_instruction_nullary;
-    mutable compiletime_instruction_cache<element::instruction_unary> cache_instruction_unary;
-    mutable compiletime_instruction_cache<element::instruction_binary> cache_instruction_binary;
-    mutable compiletime_instruction_cache<element::instruction_input> cache_instruction_input;
-    mutable compiletime_instruction_cache<element::instruction_serialised_structure> cache_instruction_serialised_structure;
-    mutable compiletime_instruction_cache<element::instruction_if> cache_instruction_if;
-    mutable compiletime_instruction_cache<element::instruction_select> cache_instruction_select;
-    mutable compiletime_instruction_cache<element::instruction_for> cache_instruction_for;
-    mutable compiletime_instruction_cache<element::instruction_indexer> cache_instruction_indexer;
+    //declared before the caches, which record in to it
+    mutable element::instrumentation stats;
+    mutable element::scope_caches cache_scope_find{ &stats };
+    mutable compiletime_instruction_cache<element::instruction_constant> cache_instruction_constant{ stats };
+    mutable compiletime_instruction_cache<element::instruction_nullary> cache_instruction_nullary{ stats };
+    mutable compiletime_instruction_cache<element::instruction_unary> cache_instruction_unary{ stats };
+    mutable compiletime_instruction_cache<element::instruction_binary> cache_instruction_binary{ stats };
+    mutable compiletime_instruction_cache<element::instruction_input> cache_instruction_input{ stats };
+    mutable compiletime_instruction_cache<element::instruction_serialised_structure> cache_instruction_serialised_structure{ stats };
+    mutable compiletime_instruction_cache<element::instruction_if> cache_instruction_if{ stats };
+    mutable compiletime_instruction_cache<element::instruction_select> cache_instruction_select{ stats };
+    mutable compiletime_instruction_cache<element::instruction_for> cache_instruction_for{ stats };
+    mutable compiletime_instruction_cache<element::instruction_indexer> cache_instruction_indexer{ stats };
+
+private:
+    element_result find_source_file(const std::string& file, std::string& abs) const;
+    void load_files_in_order(const std::vector<std::string>& files, std::vector<element_result>& results);
+    element_result build_into_scope(const element_ast* root, const char* filename, element::scope* src_scope);
 };
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <vector>
 #include <unordered_map>
 #include <cmath>
+#include <limits>
 
 #define U16_LO(x) static_cast<uint16_t>((x)&0xFFFF)
 #define U16_HI(x) static_cast<uint16_t>(((x) >> 16) & 0xFFFF)
@@ -1168,6 +1169,7 @@ static element_result compile_select(
         uint16_t option0_stack_idx;
         ELEMENT_OK_OR_RETURN(state.calculate_stack_index(es.options_at(0).get(), option0_stack_idx));
         output.emplace_back(lmnt_instruction{ LMNT_OP_INDEXRIS, selector_scratch_idx, option0_stack_idx, stack_idx });
+        state.indexed_ranges.emplace_back(option0_stack_idx, uint16_t(opts_size));
     } else {
         const size_t branches_start_idx = output.size();
         for (size_t i = 0; i < opts_size; ++i) {
@@ -1464,6 +1466,128 @@ element_result element_lmnt_compile_function(
 
     output.outputs_count = vr->count;
     output.local_stack_count = state.allocator->get_max_stack_usage();
+    output.indexed_ranges = std::move(state.indexed_ranges);
     output.name = std::move(name);
     return ELEMENT_OK;
+}
+
+static bool is_stack_operand(lmnt_operand_type type)
+{
+    return type == LMNT_OPERAND_STACK1 || type == LMNT_OPERAND_STACK4 || type == LMNT_OPERAND_STACKREF;
+}
+
+static uint16_t stack_operand_count(lmnt_operand_type type)
+{
+    return (type == LMNT_OPERAND_STACK4) ? 4 : 1;
+}
+
+element_result element_lmnt_compact_constants(
+    std::vector<element_lmnt_compiled_function>& functions,
+    std::vector<element_value>& constants)
+{
+    const size_t old_count = constants.size();
+    static constexpr size_t unused = std::numeric_limits<size_t>::max();
+    // where each constant is first used, counting instructions across all the functions in order
+    std::vector<size_t> first_use(old_count, unused);
+    // whether a constant is read together with the one after it, so they have to stay adjacent and in order
+    std::vector<bool> joined(old_count, false);
+
+    size_t position = 0;
+    const auto use = [&](size_t index, size_t count) {
+        if (index >= old_count)
+            return true;
+        // a range running off the end of the constants into the rest of the stack can't be moved
+        if (index + count > old_count)
+            return false;
+        for (size_t i = index; i < index + count; ++i) {
+            first_use[i] = (std::min)(first_use[i], position);
+            joined[i] = joined[i] || (i + 1 < index + count);
+        }
+        return true;
+    };
+
+    for (const auto& function : functions) {
+        for (const auto& in : function.instructions) {
+            const lmnt_op_info* info = lmnt_get_opcode_info(in.opcode);
+            if (!info)
+                return ELEMENT_ERROR_UNKNOWN;
+
+            // we only know how much of the stack an extcall touches from the def it calls, so leave everything alone
+            const lmnt_operand_type types[] = { info->operand1, info->operand2, info->operand3 };
+            const uint16_t args[] = { in.arg1, in.arg2, in.arg3 };
+            for (size_t i = 0; i < 3; ++i) {
+                if (types[i] == LMNT_OPERAND_STACKN)
+                    return ELEMENT_OK;
+                if (is_stack_operand(types[i]) && !use(args[i], stack_operand_count(types[i])))
+                    return ELEMENT_OK;
+            }
+
+            // INDEXRIR writes to a stack index held in a value rather than the instruction, which we can't remap
+            if (in.opcode == LMNT_OP_INDEXRIR)
+                return ELEMENT_OK;
+
+            // dynamic indexing reads a whole range relative to arg2, which the compiler told us the size of
+            if (in.opcode == LMNT_OP_INDEXRIS) {
+                const auto range = std::find_if(function.indexed_ranges.begin(), function.indexed_ranges.end(),
+                    [&](const auto& r) { return r.first == in.arg2; });
+                if (range == function.indexed_ranges.end() ? in.arg2 < old_count : !use(range->first, range->second))
+                    return ELEMENT_OK;
+            }
+
+            ++position;
+        }
+    }
+
+    // split the constants into runs which have to move together, and keep the used ones in order of first use
+    // each function's constants then end up next to each other, apart from any already placed by earlier functions
+    struct run
+    {
+        size_t start;
+        size_t count;
+        size_t first_use;
+    };
+    std::vector<run> runs;
+    for (size_t start = 0; start < old_count;) {
+        run r{ start, 0, unused };
+        do {
+            r.first_use = (std::min)(r.first_use, first_use[start + r.count]);
+        } while (joined[start + r.count++]);
+        if (r.first_use != unused)
+            runs.push_back(r);
+        start += r.count;
+    }
+    std::stable_sort(runs.begin(), runs.end(), [](const run& a, const run& b) { return a.first_use < b.first_use; });
+
+    std::vector<uint16_t> remapped(old_count, 0);
+    std::vector<element_value> new_constants;
+    for (const auto& r : runs) {
+        for (size_t i = r.start; i < r.start + r.count; ++i) {
+            remapped[i] = uint16_t(new_constants.size());
+            new_constants.push_back(constants[i]);
+        }
+    }
+
+    // everything after the constants just moves down by however many were removed
+    const auto remap = [&](uint16_t index) {
+        return (index < old_count) ? remapped[index] : uint16_t(index - old_count + new_constants.size());
+    };
+
+    for (auto& function : functions) {
+        for (auto& in : function.instructions) {
+            const lmnt_op_info* info = lmnt_get_opcode_info(in.opcode);
+            if (is_stack_operand(info->operand1))
+                in.arg1 = remap(in.arg1);
+            if (is_stack_operand(info->operand2))
+                in.arg2 = remap(in.arg2);
+            if (is_stack_operand(info->operand3))
+                in.arg3 = remap(in.arg3);
+            if (in.opcode == LMNT_OP_INDEXRIS)
+                in.arg2 = remap(in.arg2);
+        }
+        for (auto& range : function.indexed_ranges)
+            range.first = remap(range.first);
+    }
+
+    constants = std::move(new_constants);
+    return ELEMENT_OK;
 }
\ No newline at end of file
@@ -12,6 +12,8 @@ struct element_lmnt_compiler_optimisers
     bool minimise_moves = true;
     bool stack_reuse = true;
     bool allow_dynamic = true;
+    // drop constants nothing uses after compilation and lay the rest out in order of first use
+    bool compact_constants = true;
 };
 
 struct element_lmnt_compiler_settings
@@ -34,6 +36,8 @@ struct element_lmnt_compiled_function
     size_t inputs_count = 0;
     size_t outputs_count = 0;
     lmnt_def_flags flags = LMNT_DEFFLAG_NONE;
+    // stack ranges read through a dynamic index (start, count), which have to stay contiguous
+    std::vector<std::pair<uint16_t, uint16_t>> indexed_ranges;
 
     size_t total_stack_count() const { return inputs_count + outputs_count + local_stack_count; }
 };
@@ -50,3 +54,11 @@ element_result element_lmnt_compile_function(
     std::vector<element_value>& constants,
     const size_t inputs_count,
     element_lmnt_compiled_function& output);
+
+// removes constants which none of the functions use, and orders the rest by where they're first used
+// so that the constants each function needs are close together, renumbering the functions' operands to match
+// functions must all have been compiled against the same constants table, and if any of them touch the stack in ways
+// which can't be followed (extcalls, or indexing into a location held in a value) the constants are left as they are
+element_result element_lmnt_compact_constants(
+    std::vector<element_lmnt_compiled_function>& functions,
+    std::vector<element_value>& constants);
@@ -99,6 +99,8 @@ struct compiler_state
 
     size_t cur_instruction_index = 0;
     std::unordered_map<element_value, size_t> candidate_constants;
+    // see element_lmnt_compiled_function::indexed_ranges
+    std::vector<std::pair<uint16_t, uint16_t>> indexed_ranges;
 
     element_result add_constant(element_value value, uint16_t* index = nullptr);
     element_result find_constant(element_value value, uint16_t& index) const;
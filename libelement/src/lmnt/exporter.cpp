@@ -2,27 +2,61 @@
 #include <interpreter_internal.hpp>
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
 
 #include "lmnt/opcodes.h"
 #include "lmnt/archive.h"
 #include "lmnt/interpreter.h"
 #include "lmnt/compiler.hpp"
 #include "lmnt/jit.h"
+#include "object_model/compilation_context.hpp"
+#include "object_model/declarations/declaration.hpp"
+#include "parallel.hpp"
 
 
 // TODO: support data sections?
 
+// a def which runs another def's code, but only returns a slice of its outputs
+struct lmnt_alias
+{
+    std::string name;
+    size_t target = 0;       // index of the def being aliased
+    size_t rvals_offset = 0; // first of the target's outputs which this def returns
+    size_t rvals_count = 0;
+};
+
 static std::vector<char> create_archive(
     const std::vector<element_lmnt_compiled_function>& defs,
+    const std::vector<lmnt_alias>& aliases,
     const std::vector<lmnt_value>& constants)
 {
     // each element is [size_lo, size_hi, 'a', 'b', 'c', ..., '\0'] - so 2 + length + 1
     // each element must also be 4-byte aligned
+    const auto padded_name_len = [](const std::string& name) { return LMNT_ROUND_UP(0x02 + name.length() + 1, 4); };
     const size_t names_len = std::accumulate(defs.begin(), defs.end(), 0ULL,
-        [](size_t i, const element_lmnt_compiled_function& d) { return i + LMNT_ROUND_UP(0x02 + d.name.length() + 1, 4); });
+        [&](size_t i, const element_lmnt_compiled_function& d) { return i + padded_name_len(d.name); })
+        + std::accumulate(aliases.begin(), aliases.end(), 0ULL,
+        [&](size_t i, const lmnt_alias& a) { return i + padded_name_len(a.name); });
+
+    // defs which compiled to exactly the same code share a single copy of it
+    std::vector<size_t> code_source(defs.size());
+    std::unordered_map<std::string, size_t> unique_code;
+    for (size_t i = 0; i < defs.size(); ++i) {
+        const auto& instrs = defs[i].instructions;
+        std::string key(reinterpret_cast<const char*>(instrs.data()), instrs.size() * sizeof(lmnt_instruction));
+        code_source[i] = unique_code.try_emplace(std::move(key), i).first->second;
+    }
+    const size_t code_count = unique_code.size();
+
     // total length of all instructions in the code table (not including headers)
-    const size_t all_instr_count = std::accumulate(defs.begin(), defs.end(), 0ULL,
-        [](size_t i, const element_lmnt_compiled_function& d) { return i + d.instructions.size(); });
+    size_t all_instr_count = 0;
+    for (size_t i = 0; i < defs.size(); ++i) {
+        if (code_source[i] == i)
+            all_instr_count += defs[i].instructions.size();
+    }
     const size_t consts_count = constants.size();
     const size_t data_count = 0;
     assert(names_len <= 0xFC);
@@ -32,9 +66,9 @@ static std::vector<char> create_archive(
     const size_t header_len = 0x1C;
     const size_t strings_len = names_len;
     // defs are constant size
-    const size_t defs_len = 0x10 * defs.size();
+    const size_t defs_len = 0x10 * (defs.size() + aliases.size());
     // code table entries are 4 bytes of header and then instructions
-    const size_t code_len = 0x04 * defs.size() + all_instr_count * sizeof(lmnt_instruction);
+    const size_t code_len = 0x04 * code_count + all_instr_count * sizeof(lmnt_instruction);
     // we always write the number of data sections even if that number is zero
     const lmnt_loffset data_sec_count = 0;
     const size_t data_len = 0x04 + data_sec_count * (0x08 + 0x04 * data_count);
@@ -67,30 +101,43 @@ static std::vector<char> create_archive(
     memcpy(buf.data() + idx, &header, sizeof(header));
     idx += sizeof(header);
 
-    size_t strings_start = idx;
-    for (const auto& d : defs) {
-        const size_t name_len = d.name.length();
+    const auto write_name = [&](const std::string& name) {
+        const size_t name_len = name.length();
         // we need the padded length of the string *without* the length bytes, so -2 at the end
-        const size_t name_len_padded = LMNT_ROUND_UP(0x02 + d.name.length() + 1, 4) - 2;
+        const size_t name_len_padded = padded_name_len(name) - 2;
         buf[idx++] = char((name_len_padded >> 0) & 0xFF);
         buf[idx++] = char((name_len_padded >> 8) & 0xFF);
 
-        memcpy(buf.data() + idx, d.name.data(), name_len);
+        memcpy(buf.data() + idx, name.data(), name_len);
         idx += name_len;
         // always add a null...
         buf[idx++] = '\0';
-        // ... and then pad to 4-byte alignment
-        while (idx % 4)
+        // ... and then pad out to the length we reported (which keeps us 4-byte aligned)
+        for (size_t i = name_len + 1; i < name_len_padded; ++i)
             buf[idx++] = '\0';
-    }
+    };
+    for (const auto& d : defs)
+        write_name(d.name);
+    for (const auto& a : aliases)
+        write_name(a.name);
 
     size_t string_idx = 0;
     size_t code_idx = 0;
-    for (const auto& d : defs) {
+    std::vector<lmnt_loffset> code_offsets(defs.size());
+    for (size_t i = 0; i < defs.size(); ++i) {
+        const auto& d = defs[i];
+        // we'll write the code in the same order, skipping any we've already written
+        if (code_source[i] == i) {
+            code_offsets[i] = lmnt_loffset(code_idx);
+            code_idx += (0x04 + d.instructions.size() * sizeof(lmnt_instruction));
+        } else {
+            code_offsets[i] = code_offsets[code_source[i]];
+        }
+
         lmnt_def def;
         def.name = lmnt_offset(string_idx);
         def.flags = d.flags;
-        def.code = lmnt_loffset(code_idx);
+        def.code = code_offsets[i];
         def.stack_count = lmnt_offset(d.total_stack_count());
         def.args_count = lmnt_offset(d.inputs_count);
         def.rvals_count = lmnt_offset(d.outputs_count);
@@ -100,12 +147,32 @@ static std::vector<char> create_archive(
         idx += sizeof(def);
         // we wrote the strings in the same order we're writing the defs
         // so we can get away with just upping the index with each one
-        string_idx += LMNT_ROUND_UP(0x02 + d.name.length() + 1, 4);
-        // we'll also write the code in the same order
-        code_idx += (0x04 + d.instructions.size() * sizeof(lmnt_instruction));
+        string_idx += padded_name_len(d.name);
     }
 
-    for (const auto& d : defs) {
+    for (const auto& a : aliases) {
+        // a def's return values directly follow its args on the stack, so an alias treats the target's outputs
+        // before its own as additional args - the code never reads these before writing them, so they're harmless
+        const auto& target = defs[a.target];
+        assert(a.rvals_offset + a.rvals_count <= target.outputs_count);
+        lmnt_def def;
+        def.name = lmnt_offset(string_idx);
+        def.flags = target.flags;
+        def.code = code_offsets[a.target];
+        def.stack_count = lmnt_offset(target.total_stack_count());
+        def.args_count = lmnt_offset(target.inputs_count + a.rvals_offset);
+        def.rvals_count = lmnt_offset(a.rvals_count);
+        def.default_args_index = lmnt_offset(0);
+
+        memcpy(buf.data() + idx, &def, sizeof(def));
+        idx += sizeof(def);
+        string_idx += padded_name_len(a.name);
+    }
+
+    for (size_t i = 0; i < defs.size(); ++i) {
+        if (code_source[i] != i)
+            continue;
+        const auto& d = defs[i];
         uint32_t instr_count = uint32_t(d.instructions.size());
         memcpy(buf.data() + idx, &instr_count, sizeof(uint32_t));
         idx += sizeof(uint32_t);
@@ -134,43 +201,59 @@ struct instruction_deleter
     }
 };
 
-element_result element_interpreter_export_lmnt(
+static uint32_t constant_bits(element_value value)
+{
+    uint32_t bits;
+    static_assert(sizeof(bits) == sizeof(value));
+    std::memcpy(&bits, &value, sizeof(value));
+    return bits;
+}
+
+using instruction = std::unique_ptr<element_instruction, instruction_deleter>;
+
+static element_result compile_declarations(
     element_interpreter_ctx* context,
     const element_declaration** decls,
-    const char** funcnames,
     size_t decls_count,
-    char* buffer,
-    size_t* bufsize)
+    std::vector<instruction>& functions)
 {
-    if (!context)
-        return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL;
-    if (!decls || !funcnames)
-        return ELEMENT_ERROR_API_DECLARATION_IS_NULL;
-    if (decls_count == 0)
-        return ELEMENT_ERROR_API_INVALID_INPUT;
-    if (!bufsize)
-        return ELEMENT_ERROR_API_OUTPUT_IS_NULL;
-
-    using instruction = std::unique_ptr<element_instruction, instruction_deleter>;
-    std::vector<instruction> functions;
     functions.reserve(decls_count);
-
+    // the interpreter context isn't thread-safe, so compiling to instruction trees stays serial
+    // everything after this point only reads the (immutable) instruction trees and can be spread across workers
     for (size_t i = 0; i < decls_count; ++i) {
         element_instruction* instr;
         ELEMENT_OK_OR_RETURN(element_interpreter_compile_declaration(context, nullptr, decls[i], &instr));
         functions.emplace_back(instr);
     }
+    return ELEMENT_OK;
+}
 
+static element_result lower_functions(
+    element_interpreter_ctx* context,
+    const std::vector<element::instruction_const_shared_ptr>& functions,
+    const std::vector<std::string>& names,
+    const std::vector<size_t>& inputs_sizes,
+    size_t worker_count,
+    std::vector<element_lmnt_compiled_function>& lmnt_functions,
+    std::vector<element_value>& constants)
+{
+    element::scoped_phase_timer timer(context->stats, element::compilation_phase::lmnt_lowering);
     element_lmnt_compiler_ctx lmnt_ctx;
 
     // we need to get all the constants we want in the archive ahead of time, from all functions
+    // each function gathers its own candidates, which are then merged
+    std::vector<std::unordered_map<element_value, size_t>> function_candidates(functions.size());
+    ELEMENT_OK_OR_RETURN(element::run_parallel(functions.size(), worker_count, [&](size_t i) {
+        return element_lmnt_find_constants(lmnt_ctx, functions[i], function_candidates[i]);
+    }));
+
     std::unordered_map<element_value, size_t> candidate_constants;
-    for (size_t i = 0; i < functions.size(); ++i) {
-        ELEMENT_OK_OR_RETURN(element_lmnt_find_constants(lmnt_ctx, functions[i]->instruction, candidate_constants));
+    for (const auto& candidates : function_candidates) {
+        for (const auto& [value, count] : candidates)
+            candidate_constants[value] += count;
     }
 
-    std::vector<element_lmnt_compiled_function> lmnt_functions(functions.size());
-    std::vector<element_value> constants;
+    constants.clear();
     constants.reserve(candidate_constants.size());
     static const size_t constant_threshold = 1;
 
@@ -179,15 +262,48 @@ element_result element_interpreter_export_lmnt(
             constants.push_back(value);
     }
 
-    for (size_t i = 0; i < functions.size(); ++i) {
-        size_t inputs_size = 0;
-        ELEMENT_OK_OR_RETURN(element_instruction_get_function_inputs_size(functions[i].get(), &inputs_size));
-
-        ELEMENT_OK_OR_RETURN(element_lmnt_compile_function(lmnt_ctx, functions[i]->instruction, funcnames[i], constants, inputs_size, lmnt_functions[i]));
+    // hash map iteration order isn't stable, so order the table explicitly: most-used first, then by bit pattern
+    std::sort(constants.begin(), constants.end(), [&](element_value a, element_value b) {
+        const size_t a_count = candidate_constants.at(a);
+        const size_t b_count = candidate_constants.at(b);
+        if (a_count != b_count)
+            return a_count > b_count;
+        return constant_bits(a) < constant_bits(b);
+    });
+
+    // lowering a function can introduce constants of its own, and every function's stack layout depends on the
+    // size of the constants table - so each function compiles against a private copy of the table, any new
+    // constants are appended in function order, and we go again until nobody needs anything new
+    while (true) {
+        std::vector<std::vector<element_value>> function_constants(functions.size(), constants);
+        lmnt_functions.assign(functions.size(), element_lmnt_compiled_function{});
+
+        ELEMENT_OK_OR_RETURN(element::run_parallel(functions.size(), worker_count, [&](size_t i) {
+            return element_lmnt_compile_function(lmnt_ctx, functions[i], names[i], function_constants[i], inputs_sizes[i], lmnt_functions[i]);
+        }));
+
+        const size_t previous_count = constants.size();
+        for (const auto& added : function_constants) {
+            for (size_t i = previous_count; i < added.size(); ++i) {
+                if (std::find(constants.begin(), constants.end(), added[i]) == constants.end())
+                    constants.push_back(added[i]);
+            }
+        }
+
+        if (constants.size() == previous_count)
+            break;
     }
 
-    auto lmnt_archive_data = create_archive(lmnt_functions, constants);
+    // the table was built from candidates in the instruction trees, some of which never made it into the bytecode
+    // it's copied onto every context's stack when the archive's prepared, so only keep what's used
+    if (lmnt_ctx.optimise.compact_constants)
+        ELEMENT_OK_OR_RETURN(element_lmnt_compact_constants(lmnt_functions, constants));
+
+    return ELEMENT_OK;
+}
 
+static element_result write_archive(const std::vector<char>& lmnt_archive_data, char* buffer, size_t* bufsize)
+{
     size_t current_bufsize = *bufsize;
     // always write the size of the archive back out to the user
     *bufsize = lmnt_archive_data.size();
@@ -201,4 +317,212 @@ element_result element_interpreter_export_lmnt(
     }
 
     return ELEMENT_OK;
-}
\ No newline at end of file
+}
+
+// the number of boundary inputs taken up by each port of the declaration
+static element_result get_input_sizes(element_interpreter_ctx* context, const element::declaration& decl, std::vector<size_t>& sizes)
+{
+    const element::compilation_context compilation_context(context->global_scope.get(), context);
+
+    std::size_t index = 0;
+    for (const auto& input : decl.get_inputs()) {
+        const auto start = index;
+        const auto placeholder = input.generate_placeholder(compilation_context, index, 0);
+        if (!placeholder || placeholder->is_error())
+            return ELEMENT_ERROR_API_INVALID_INPUT;
+        sizes.push_back(index - start);
+    }
+
+    return ELEMENT_OK;
+}
+
+element_result element_interpreter_export_lmnt(
+    element_interpreter_ctx* context,
+    const element_declaration** decls,
+    const char** funcnames,
+    size_t decls_count,
+    char* buffer,
+    size_t* bufsize)
+{
+    return element_interpreter_export_lmnt_parallel(context, decls, funcnames, decls_count, 1, buffer, bufsize);
+}
+
+struct element_lmnt_archive
+{
+    std::vector<char> data;
+};
+
+static element_result export_archive(
+    element_interpreter_ctx* context,
+    const element_declaration** decls,
+    const char** funcnames,
+    size_t decls_count,
+    size_t worker_count,
+    std::vector<char>& archive)
+{
+    worker_count = element::resolve_worker_count(worker_count, decls_count);
+
+    std::vector<instruction> functions;
+    ELEMENT_OK_OR_RETURN(compile_declarations(context, decls, decls_count, functions));
+
+    std::vector<element::instruction_const_shared_ptr> roots;
+    std::vector<std::string> names;
+    std::vector<size_t> inputs_sizes(functions.size());
+    for (size_t i = 0; i < functions.size(); ++i) {
+        roots.push_back(functions[i]->instruction);
+        names.emplace_back(funcnames[i]);
+        ELEMENT_OK_OR_RETURN(element_instruction_get_function_inputs_size(functions[i].get(), &inputs_sizes[i]));
+    }
+
+    std::vector<element_lmnt_compiled_function> lmnt_functions;
+    std::vector<element_value> constants;
+    ELEMENT_OK_OR_RETURN(lower_functions(context, roots, names, inputs_sizes, worker_count, lmnt_functions, constants));
+
+    archive = create_archive(lmnt_functions, {}, constants);
+    return ELEMENT_OK;
+}
+
+element_result element_interpreter_export_lmnt_parallel(
+    element_interpreter_ctx* context,
+    const element_declaration** decls,
+    const char** funcnames,
+    size_t decls_count,
+    size_t worker_count,
+    char* buffer,
+    size_t* bufsize)
+{
+    if (!context)
+        return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL;
+    if (!decls || !funcnames)
+        return ELEMENT_ERROR_API_DECLARATION_IS_NULL;
+    if (decls_count == 0)
+        return ELEMENT_ERROR_API_INVALID_INPUT;
+    if (!bufsize)
+        return ELEMENT_ERROR_API_OUTPUT_IS_NULL;
+
+    std::vector<char> archive;
+    ELEMENT_OK_OR_RETURN(export_archive(context, decls, funcnames, decls_count, worker_count, archive));
+    return write_archive(archive, buffer, bufsize);
+}
+
+element_result element_interpreter_export_lmnt_archive(
+    element_interpreter_ctx* context,
+    const element_declaration** decls,
+    const char** funcnames,
+    size_t decls_count,
+    size_t worker_count,
+    element_lmnt_archive** archive)
+{
+    if (!context)
+        return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL;
+    if (!decls || !funcnames)
+        return ELEMENT_ERROR_API_DECLARATION_IS_NULL;
+    if (decls_count == 0)
+        return ELEMENT_ERROR_API_INVALID_INPUT;
+    if (!archive)
+        return ELEMENT_ERROR_API_OUTPUT_IS_NULL;
+
+    auto result = std::make_unique<element_lmnt_archive>();
+    ELEMENT_OK_OR_RETURN(export_archive(context, decls, funcnames, decls_count, worker_count, result->data));
+    *archive = result.release();
+    return ELEMENT_OK;
+}
+
+element_result element_lmnt_archive_get_data(const element_lmnt_archive* archive, const char** data, size_t* size)
+{
+    if (!archive)
+        return ELEMENT_ERROR_API_INVALID_INPUT;
+    if (!data || !size)
+        return ELEMENT_ERROR_API_OUTPUT_IS_NULL;
+
+    *data = archive->data.data();
+    *size = archive->data.size();
+    return ELEMENT_OK;
+}
+
+void element_lmnt_archive_delete(element_lmnt_archive** archive)
+{
+    if (!archive)
+        return;
+
+    delete *archive;
+    *archive = nullptr;
+}
+
+element_result element_interpreter_export_lmnt_fused(
+    element_interpreter_ctx* context,
+    const element_declaration** decls,
+    const char** funcnames,
+    size_t decls_count,
+    const char* fused_name,
+    char* buffer,
+    size_t* bufsize)
+{
+    if (!context)
+        return ELEMENT_ERROR_API_INTERPRETER_CTX_IS_NULL;
+    if (!decls || !funcnames)
+        return ELEMENT_ERROR_API_DECLARATION_IS_NULL;
+    if (!fused_name)
+        return ELEMENT_ERROR_API_STRING_IS_NULL;
+    if (decls_count == 0)
+        return ELEMENT_ERROR_API_INVALID_INPUT;
+    if (!bufsize)
+        return ELEMENT_ERROR_API_OUTPUT_IS_NULL;
+
+    for (size_t i = 0; i < decls_count; ++i) {
+        if (!decls[i] || !decls[i]->decl || !funcnames[i])
+            return ELEMENT_ERROR_API_DECLARATION_IS_NULL;
+        // every def in the archive needs a distinct name for lmnt_find_def to be any use
+        if (strcmp(funcnames[i], fused_name) == 0)
+            return ELEMENT_ERROR_API_INVALID_INPUT;
+        for (size_t j = 0; j < i; ++j) {
+            if (strcmp(funcnames[i], funcnames[j]) == 0)
+                return ELEMENT_ERROR_API_INVALID_INPUT;
+        }
+    }
+
+    // the functions all read their inputs from the same args, so they have to agree on what those are
+    std::vector<size_t> input_sizes;
+    ELEMENT_OK_OR_RETURN(get_input_sizes(context, *decls[0]->decl, input_sizes));
+    for (size_t i = 1; i < decls_count; ++i) {
+        std::vector<size_t> other_sizes;
+        ELEMENT_OK_OR_RETURN(get_input_sizes(context, *decls[i]->decl, other_sizes));
+        if (other_sizes != input_sizes)
+            return ELEMENT_ERROR_API_INVALID_INPUT;
+    }
+
+    std::vector<instruction> functions;
+    ELEMENT_OK_OR_RETURN(compile_declarations(context, decls, decls_count, functions));
+
+    // instructions are hash-consed, so subexpressions common to several functions are already the same instruction
+    // gathering every function's outputs into one structure lets the compiler share them between all of them
+    std::vector<element::instruction_const_shared_ptr> outputs;
+    std::vector<std::string> output_names;
+    std::vector<lmnt_alias> aliases;
+    size_t inputs_size = std::accumulate(input_sizes.begin(), input_sizes.end(), size_t(0));
+    size_t rvals_offset = 0;
+    for (size_t i = 0; i < functions.size(); ++i) {
+        // inputs the declarations have but don't use are still part of the fused def's args
+        size_t used_inputs_size;
+        ELEMENT_OK_OR_RETURN(element_instruction_get_function_inputs_size(functions[i].get(), &used_inputs_size));
+        inputs_size = (std::max)(inputs_size, used_inputs_size);
+
+        const size_t rvals_count = functions[i]->instruction->get_size();
+        aliases.push_back({ funcnames[i], 0, rvals_offset, rvals_count });
+        rvals_offset += rvals_count;
+
+        outputs.push_back(functions[i]->instruction);
+        output_names.emplace_back(funcnames[i]);
+    }
+
+    const element::instruction_const_shared_ptr fused = std::make_shared<const element::instruction_serialised_structure>(
+        std::move(outputs), std::move(output_names), std::string(fused_name));
+
+    std::vector<element_lmnt_compiled_function> lmnt_functions;
+    std::vector<element_value> constants;
+    ELEMENT_OK_OR_RETURN(lower_functions(context, { fused }, { fused_name }, { inputs_size }, 1, lmnt_functions, constants));
+    if (lmnt_functions[0].outputs_count != rvals_offset)
+        return ELEMENT_ERROR_UNKNOWN;
+
+    return write_archive(create_archive(lmnt_functions, aliases, constants), buffer, bufsize);
+}
@@ -77,7 +77,8 @@ template <log_error_message_code code, typename... Args>
 std::string build_log_error_string(Args&&... args)
 {
     constexpr auto log_error_code_info_exists = !std::is_same_v<typename log_error_message_info<code>::tuple, void>;
-    constexpr auto log_error_arguments_match = std::is_convertible_v<std::tuple<Args...>, typename log_error_message_info<code>::tuple>;
+    //constructible rather than convertible so that string_views can be passed where strings are expected
+    constexpr auto log_error_arguments_match = std::is_constructible_v<typename log_error_message_info<code>::tuple, Args...>;
     static_assert(log_error_code_info_exists && log_error_arguments_match, "An error with that code that uses these types does not exist");
 
     return fmt::format(log_error_message_info<code>::format, std::forward<Args>(args)...);
@@ -89,7 +90,8 @@ log_message build_log_error(const source_information& source_info, Args&&... arg
     auto our_string = build_log_error_string<code>(std::forward<Args>(args)...);
 
     element_log_message msg;
-    msg.line_in_source = source_info.line_in_source ? source_info.line_in_source->c_str() : nullptr;
+    const auto* line_in_source = source_info.get_line_in_source();
+    msg.line_in_source = line_in_source ? line_in_source->c_str() : nullptr;
     msg.character = source_info.character_start;
     msg.filename = source_info.filename;
     msg.message_code = log_error_message_info<code>::result_element;
@@ -125,14 +127,12 @@ inline source_information build_source_info(const source_context* context, const
 
     const auto& file_info = context->file_info.at(token->source_name);
     const std::string* filename = file_info.file_name.get();
-    const int actual_line = token->line - 1;
-    const std::string* line_in_source = actual_line >= 0 ? file_info.source_lines[actual_line].get() : nullptr;
 
     return {
         token->line,
         token->character,
         token->character + token->tok_len + extra_length,
-        line_in_source,
+        &file_info,
         filename->data()
     };
 }
@@ -89,3 +89,21 @@ capture_stack capture_stack::filter_captures_from_scope(const scope* local_scope
 
     return captures;
 }
+
+bool capture_stack::has_captures_for_scope(const scope* local_scope) const
+{
+    if (frames.empty())
+        return false;
+
+    for (const scope* current_scope = local_scope; current_scope; current_scope = current_scope->get_parent_scope()) {
+        const bool found = std::any_of(std::begin(frames), std::end(frames),
+            [current_scope](const auto& frame) {
+                return current_scope == frame.current_scope;
+            });
+
+        if (found)
+            return true;
+    }
+
+    return false;
+}
@@ -32,6 +32,9 @@ public:
         const compilation_context& context,
         const source_information& source_info) const;
 
+    //whether something declared within local_scope could find any of its captures in this stack
+    [[nodiscard]] bool has_captures_for_scope(const scope* local_scope) const;
+
     //todo: private
     std::vector<frame> frames;
 };
@@ -46,5 +46,5 @@ compilation_context::compilation_context(const scope* const scope, element_inter
 
 const element_log_ctx* compilation_context::get_logger() const
 {
-    return interpreter->logger.get();
+    return logging_suppressed ? nullptr : interpreter->logger.get();
 }
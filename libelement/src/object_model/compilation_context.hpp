@@ -7,9 +7,55 @@
 
 //STD
 #include <set>
+#include <unordered_map>
 
 namespace element
 {
+//Results of calls which can only depend on their arguments, so calling the same declaration again with the same (hash-consed) arguments can reuse them
+class call_memo
+{
+public:
+    [[nodiscard]] object_const_shared_ptr find(const declaration* declarer, std::size_t boundary_depth, const std::vector<object_const_shared_ptr>& arguments) const
+    {
+        const auto it = calls.find(key{ declarer, boundary_depth, arguments });
+        return it != calls.end() ? it->second : nullptr;
+    }
+
+    void insert(const declaration* declarer, std::size_t boundary_depth, std::vector<object_const_shared_ptr> arguments, object_const_shared_ptr result)
+    {
+        calls.insert_or_assign(key{ declarer, boundary_depth, std::move(arguments) }, std::move(result));
+    }
+
+private:
+    struct key
+    {
+        const declaration* declarer;
+        std::size_t boundary_depth;
+        //kept alive so that their addresses can't be reused by different arguments
+        std::vector<object_const_shared_ptr> arguments;
+
+        bool operator==(const key& other) const
+        {
+            return declarer == other.declarer
+                && boundary_depth == other.boundary_depth
+                && arguments == other.arguments;
+        }
+    };
+
+    struct key_hash
+    {
+        std::size_t operator()(const key& k) const
+        {
+            auto hash = (std::hash<const void*>{}(k.declarer) * 31) ^ k.boundary_depth;
+            for (const auto& argument : k.arguments)
+                hash = (hash * 31) ^ std::hash<const void*>{}(argument.get());
+            return hash;
+        }
+    };
+
+    std::unordered_map<key, object_const_shared_ptr, key_hash> calls;
+};
+
 class compilation_context
 {
 public:
@@ -30,6 +76,9 @@ public:
     };
 
     mutable std::vector<boundary_info> boundaries;
+    mutable call_memo memoised_calls;
+    //while set, get_logger returns nullptr, for trying things which have a fallback if they fail
+    mutable bool logging_suppressed = false;
 
     size_t total_boundary_size_at_index(size_t index) const
     {
@@ -80,8 +80,9 @@ const constraint* function_declaration::get_constraint() const
     return constraint_.get();
 }
 
-bool function_declaration::valid_at_boundary(const compilation_context& context) const
+bool function_declaration::valid_at_boundary(const compilation_context& context, bool log_errors) const
 {
+    const auto* logger = log_errors ? context.get_logger() : nullptr;
     if (!ports_validated)
         validate_ports(context);
 
@@ -95,7 +96,7 @@ bool function_declaration::valid_at_boundary(const compilation_context& context)
             fmt::format("output '{}' of function '{}' is not deserializable, so it's not valid on the boundary", output.typeof_info(), name.value),
             ELEMENT_ERROR_UNKNOWN,
             source_info,
-            context.get_logger());
+            logger);
         return false;
     }
 
@@ -107,7 +108,7 @@ bool function_declaration::valid_at_boundary(const compilation_context& context)
                 fmt::format("input '{}' of function '{}' is not deserializable, so it's not valid on the boundary", input.typeof_info(), name.value),
                 ELEMENT_ERROR_UNKNOWN,
                 source_info,
-                context.get_logger());
+                logger);
             return false;
         }
     }
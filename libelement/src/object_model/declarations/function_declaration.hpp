@@ -38,7 +38,7 @@ public:
     [[nodiscard]] object_const_shared_ptr compile(const compilation_context& context,
         const source_information& source_info) const override;
 
-    [[nodiscard]] bool valid_at_boundary(const compilation_context& context) const;
+    [[nodiscard]] bool valid_at_boundary(const compilation_context& context, bool log_errors = true) const;
     [[nodiscard]] bool is_intrinsic() const override;
 
     [[nodiscard]] const body_type& get_body() const;
@@ -47,7 +47,8 @@ element_log_message error::get_log_message() const
     msg.message_code = code;
     msg.related_log_message = nullptr;
     msg.stage = ELEMENT_STAGE_COMPILER;
-    msg.line_in_source = source_info.line_in_source ? source_info.line_in_source->c_str() : nullptr;
+    const auto* line_in_source = source_info.get_line_in_source();
+    msg.line_in_source = line_in_source ? line_in_source->c_str() : nullptr;
     return msg;
 }
 
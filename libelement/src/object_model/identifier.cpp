@@ -1,7 +1,73 @@
 #include "identifier.hpp"
 
+//STD
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
 using namespace element;
 
+namespace
+{
+struct symbols
+{
+    symbols()
+    {
+        texts.emplace_back();
+        ids.emplace(texts.back(), 0);
+    }
+
+    std::shared_mutex mutex;
+    //a deque so that the views in ids stay valid as it grows
+    std::deque<std::string> texts;
+    std::unordered_map<std::string_view, symbol> ids;
+};
+
+//constructed on first use, as identifiers with static storage duration intern their text during static initialisation
+symbols& get_symbols()
+{
+    static symbols instance;
+    return instance;
+}
+} // namespace
+
+symbol symbol_table::intern(std::string_view text)
+{
+    auto& table = get_symbols();
+
+    {
+        std::shared_lock<std::shared_mutex> lock(table.mutex);
+        const auto it = table.ids.find(text);
+        if (it != table.ids.end())
+            return it->second;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(table.mutex);
+    const auto it = table.ids.find(text);
+    if (it != table.ids.end())
+        return it->second;
+
+    const auto id = static_cast<symbol>(table.texts.size());
+    table.texts.emplace_back(text);
+    table.ids.emplace(table.texts.back(), id);
+    return id;
+}
+
+const std::string& symbol_table::text(symbol id)
+{
+    auto& table = get_symbols();
+    std::shared_lock<std::shared_mutex> lock(table.mutex);
+    return table.texts.at(id);
+}
+
+std::size_t symbol_table::size()
+{
+    auto& table = get_symbols();
+    std::shared_lock<std::shared_mutex> lock(table.mutex);
+    return table.texts.size();
+}
+
 identifier identifier::return_identifier{ "return" };
 identifier identifier::list_count_identifier{ "count" };
-identifier identifier::list_at_identifier{ "at" };
\ No newline at end of file
+identifier identifier::list_at_identifier{ "at" };
@@ -1,10 +1,24 @@
 #pragma once
 
 //STD
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 namespace element
 {
+using symbol = std::uint32_t;
+
+//Every identifier's text is interned here, so that identifiers can be compared and looked up by a small integer rather than by their text
+//Symbols are never removed, and the empty string is always symbol 0
+class symbol_table
+{
+public:
+    static symbol intern(std::string_view text);
+    static const std::string& text(symbol id);
+    static std::size_t size();
+};
+
 //todo: do we actually want to keep and use this type? currently we're just accessing .value everywhere, if we want to keep this, let's properly wrap std::string
 class identifier
 {
@@ -13,6 +27,7 @@ public:
 
     identifier(std::string value)
         : value{ std::move(value) }
+        , id{ symbol_table::intern(this->value) }
     {
     }
 
@@ -20,11 +35,13 @@ public:
     static identifier list_count_identifier;
     static identifier list_at_identifier;
 
+    //don't modify this directly, construct a new identifier so that the symbol matches
     std::string value;
+    symbol id = 0;
 
     bool operator<(const identifier& rhs) const
     {
         return value < rhs.value;
     }
 };
-} // namespace element
\ No newline at end of file
+} // namespace element
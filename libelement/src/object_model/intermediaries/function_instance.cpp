@@ -85,6 +85,7 @@ object_const_shared_ptr function_instance::call(
     std::vector<object_const_shared_ptr> compiled_args,
     const source_information& source_info) const
 {
+    context.interpreter->stats.increment(compilation_counter::calls);
     compiled_args.insert(std::begin(compiled_args), std::begin(provided_arguments), std::end(provided_arguments));
 
     //todo: error checks
@@ -112,7 +113,7 @@ object_const_shared_ptr function_instance::call(
         }
 
         context.get_logger()->log_step("{}({})\n", declarer->name.value, std::move(input_string));
-        context.get_logger()->log_step("\\__\"{}\" @ {}:{}:{}\n", source_info.line_in_source->c_str(), source_info.filename, source_info.line, source_info.character_start);
+        context.get_logger()->log_step("\\__\"{}\" @ {}:{}:{}\n", source_info.get_line_in_source()->c_str(), source_info.filename, source_info.line, source_info.character_start);
         /*std::string indents(context.get_logger()->log_step_get_indent_level(), '\t');
         indents += std::string(source_info.character_start, ' ');
         std::string arrows(source_info.character_end - source_info.character_start, '^');
@@ -140,6 +141,23 @@ object_const_shared_ptr function_instance::call(
     if (context.calls.recursive_calls(this) > reasonable_function_call_limit)
         return context.calls.build_recursive_error(this, context, source_info);
 
+    //a call can only depend on its arguments if nothing it's nested within has been called, so it can't capture anything
+    //intrinsics are excluded as some look at the capture stack directly (e.g. the list indexer)
+    //the boundary depth is part of the key as placeholders made inside the body depend on it
+    const bool memoisable = !declarer->is_intrinsic()
+        && !captures.has_captures_for_scope(declarer->our_scope->get_parent_scope());
+    const auto boundary_depth = context.boundaries.size();
+    if (memoisable) {
+        if (auto memoised = context.memoised_calls.find(declarer, boundary_depth, compiled_args)) {
+            context.interpreter->stats.increment(compilation_counter::memoised_calls);
+            return memoised;
+        }
+    }
+
+    //compiling the body may add placeholders to the current boundary, which reusing the result would skip
+    const auto boundary_size = context.boundaries.back().size;
+    const auto boundary_inputs = context.boundaries.back().inputs.size();
+
     if constexpr (should_log_compilation_step())
         context.get_logger()->log_step_indent();
 
@@ -189,6 +207,12 @@ object_const_shared_ptr function_instance::call(
                 declarer->name.value, element->to_string(), constraint ? type->name.value : "Any"),
             ELEMENT_ERROR_CONSTRAINT_NOT_SATISFIED, source_info);
 
+    const bool boundary_unchanged = context.boundaries.size() == boundary_depth
+        && context.boundaries.back().size == boundary_size
+        && context.boundaries.back().inputs.size() == boundary_inputs;
+    if (memoisable && boundary_unchanged && !element->is_error())
+        context.memoised_calls.insert(declarer, boundary_depth, std::move(compiled_args), element);
+
     return element;
 }
 
@@ -217,7 +241,7 @@ bool function_instance::is_constant() const
     return true;
 }
 
-bool function_instance::valid_at_boundary(const compilation_context& context) const
+bool function_instance::valid_at_boundary(const compilation_context& context, bool log_errors) const
 {
-    return declarer->valid_at_boundary(context);
+    return declarer->valid_at_boundary(context, log_errors);
 }
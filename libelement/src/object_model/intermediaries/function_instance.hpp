@@ -30,7 +30,7 @@ public:
     [[nodiscard]] const std::vector<port>& get_inputs() const override;
 
     [[nodiscard]] bool is_constant() const override;
-    [[nodiscard]] bool valid_at_boundary(const compilation_context& context) const;
+    [[nodiscard]] bool valid_at_boundary(const compilation_context& context, bool log_errors = true) const;
     [[nodiscard]] const std::vector<object_const_shared_ptr>& get_provided_arguments() const { return provided_arguments; }
     const function_declaration* const declarer;
     [[nodiscard]] const capture_stack& get_captures() const { return captures; };
@@ -9,8 +9,103 @@
 #include "object_model/declarations/struct_declaration.hpp"
 #include "object_model/intrinsics/intrinsic_function.hpp"
 
+//SELF
+#include "instruction_tree/evaluator.hpp"
+#include "interpreter_internal.hpp"
+
 using namespace element;
 
+//compiles the predicate and body once with placeholder inputs, then runs the loop on the evaluator
+//returns nullptr if the loop can't be evaluated this way, e.g. it depends on boundary inputs
+static object_const_shared_ptr evaluate_compile_time_for(const object_const_shared_ptr& initial_object,
+    const std::shared_ptr<const function_instance>& predicate_function,
+    const std::shared_ptr<const function_instance>& body_function,
+    const source_information& source_info,
+    const compilation_context& context)
+{
+    if (!predicate_function->valid_at_boundary(context, false) || !body_function->valid_at_boundary(context, false))
+        return nullptr;
+
+    const auto initial_instruction = std::dynamic_pointer_cast<const instruction>(initial_object);
+    const auto initial_expression = initial_instruction ? initial_instruction : initial_object->to_instruction(*context.interpreter);
+    if (!initial_expression)
+        return nullptr;
+
+    if (context.boundaries.empty())
+        return nullptr;
+
+    //the placeholders are generated for the current boundary, which we don't want to disturb if we end up falling back
+    //any errors are left for the object model to report, so we don't log them here
+    const auto scope = context.boundaries.size() - 1;
+    const auto boundary = context.boundaries[scope];
+    const auto was_suppressed = context.logging_suppressed;
+    context.logging_suppressed = true;
+    const auto compile = [&context, &source_info, scope](const function_instance& function) {
+        auto [placeholders, size] = generate_placeholder_inputs(context, function.get_inputs(), 0, scope);
+        context.boundaries[scope].size = size;
+        context.boundaries.push_back({});
+        auto compiled = function.call(context, std::move(placeholders), source_info);
+        context.boundaries.pop_back();
+        return compiled;
+    };
+    const auto predicate_compiled = compile(*predicate_function);
+    const auto body_compiled = compile(*body_function);
+    context.boundaries[scope] = boundary;
+    context.logging_suppressed = was_suppressed;
+
+    if (!predicate_compiled || predicate_compiled->is_error() || !body_compiled || body_compiled->is_error())
+        return nullptr;
+
+    if (!body_compiled->matches_constraint(context, initial_object->get_constraint()))
+        return nullptr;
+
+    const auto predicate_expression = predicate_compiled->to_instruction(*context.interpreter);
+    const auto body_expression = body_compiled->to_instruction(*context.interpreter);
+    if (!predicate_expression || !body_expression
+        || predicate_expression->get_size() != 1
+        || body_expression->get_size() != initial_expression->get_size())
+        return nullptr;
+
+    element_evaluator_ctx evaluator;
+    std::vector<element_value> values(initial_expression->get_size());
+    size_t values_count = values.size();
+    if (element_evaluate(evaluator, initial_expression, nullptr, nullptr, 0, values.data(), values_count) != ELEMENT_OK
+        || values_count != values.size())
+        return nullptr;
+
+    //boundaries below the loop's own are left empty, so anything reading from them fails to evaluate
+    evaluator.boundaries.clear();
+    for (size_t i = 0; i < scope; ++i)
+        evaluator.boundaries.push_back({ nullptr, 0 });
+
+    const auto max_loop_iterations = context.interpreter->max_loop_iterations;
+    const auto result = element_iterate_for(evaluator, predicate_expression, body_expression, values, max_loop_iterations);
+    if (result == ELEMENT_ERROR_INFINITE_LOOP)
+        return std::make_shared<const error>(
+            fmt::format("Compile time loop didn't finish after max iteration count of {}", max_loop_iterations),
+            ELEMENT_ERROR_INFINITE_LOOP,
+            source_info,
+            context.get_logger());
+
+    if (result != ELEMENT_OK)
+        return nullptr;
+
+    if (initial_instruction)
+        return context.interpreter->cache_instruction_constant.get(values[0], initial_expression->actual_type);
+
+    const auto initial_struct = std::dynamic_pointer_cast<const struct_instance>(initial_object);
+    if (!initial_struct)
+        return nullptr;
+
+    auto constant_filler = [&values, &context](const std::string&,
+                               const std::shared_ptr<const instruction>& field,
+                               int index) -> std::shared_ptr<const instruction> {
+        return context.interpreter->cache_instruction_constant.get(values[index], field->actual_type);
+    };
+
+    return initial_struct->clone_and_fill_with_expressions(context, std::move(constant_filler));
+}
+
 object_const_shared_ptr compile_time_for(const object_const_shared_ptr& initial_object,
     const std::shared_ptr<const function_instance>& predicate_function,
     const std::shared_ptr<const function_instance>& body_function,
@@ -21,6 +116,9 @@ object_const_shared_ptr compile_time_for(const object_const_shared_ptr& initial_
     if (!is_constant)
         return nullptr;
 
+    if (auto evaluated = evaluate_compile_time_for(initial_object, predicate_function, body_function, source_info, context))
+        return evaluated;
+
     //note: the predicate and the body could still return something which is not constant, so we need to check constantly
     bool predicate_evaluated_to_constant = true;
 
@@ -74,11 +172,10 @@ object_const_shared_ptr compile_time_for(const object_const_shared_ptr& initial_
     //todo: in order to detect an infinite loop we need to know if the predicates result is dependent on its input, i.e. it is actually using it to alter the calculation in a meaningful way
     //  not sure how to do it, but the loop iteration limit will catch the infinite loop situation anyway
 
-    //todo: make this user configurable
-    constexpr auto max_loop_iterations = 10'000;
-    auto current_loop_iteration = 0;
+    const auto max_loop_iterations = context.interpreter->max_loop_iterations;
+    std::size_t current_loop_iteration = 0;
     while (continue_loop(arguments)) {
-        if (current_loop_iteration > max_loop_iterations)
+        if (current_loop_iteration == max_loop_iterations)
             return std::make_shared<const error>(
                 fmt::format("Compile time loop didn't finish after max iteration count of {}", max_loop_iterations),
                 ELEMENT_ERROR_INFINITE_LOOP,
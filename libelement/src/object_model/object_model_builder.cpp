@@ -63,9 +63,9 @@ std::unique_ptr<type_annotation> build_type_annotation(const element_interpreter
         std::vector<const element_ast*> flattened_ast;
         flatten_ast(ident, flattened_ast);
 
-        std::string type_annotation_string = ident->identifier;
+        std::string type_annotation_string(ident->identifier);
         for (const auto* child : flattened_ast)
-            type_annotation_string += "." + child->identifier;
+            type_annotation_string += "." + std::string(child->identifier);
 
         auto element = std::make_unique<type_annotation>(identifier(type_annotation_string));
         assign_source_information(context, element, ast);
@@ -89,7 +89,7 @@ void build_inputs(const element_interpreter_ctx* context, element_ast* inputs, d
             return;
         }
 
-        auto ident = identifier(input->identifier);
+        auto ident = identifier(std::string(input->identifier));
 
         auto* const type = input->children[ast_idx::port::type].get();
         auto* const default_value = input->children[ast_idx::port::default_value].get();
@@ -126,7 +126,7 @@ std::unique_ptr<declaration> build_struct_declaration(const element_interpreter_
     const auto intrinsic = decl->has_flag(ELEMENT_AST_FLAG_DECL_INTRINSIC);
 
     auto struct_kind = intrinsic ? struct_declaration::kind::intrinsic : struct_declaration::kind::custom;
-    auto struct_decl = std::make_unique<struct_declaration>(identifier(decl->identifier), parent_scope, struct_kind);
+    auto struct_decl = std::make_unique<struct_declaration>(identifier(std::string(decl->identifier)), parent_scope, struct_kind);
     build_inputs_output(context, decl, *struct_decl, output_result, ELEMENT_AST_NODE_STRUCT);
 
     if (intrinsic) {
@@ -161,7 +161,7 @@ std::unique_ptr<declaration> build_constraint_declaration(const element_interpre
     const auto intrinsic = decl->has_flag(ELEMENT_AST_FLAG_DECL_INTRINSIC);
 
     auto constraint_kind = intrinsic ? constraint_declaration::kind::intrinsic : constraint_declaration::kind::custom;
-    auto constraint_decl = std::make_unique<constraint_declaration>(identifier(decl->identifier), parent_scope, constraint_kind);
+    auto constraint_decl = std::make_unique<constraint_declaration>(identifier(std::string(decl->identifier)), parent_scope, constraint_kind);
 
     build_inputs_output(context, decl, *constraint_decl, output_result, ELEMENT_AST_NODE_CONSTRAINT);
 
@@ -226,7 +226,7 @@ std::unique_ptr<declaration> build_function_declaration(const element_interprete
 
     auto intrinsic = decl->has_flag(ELEMENT_AST_FLAG_DECL_INTRINSIC);
 
-    auto function_decl = std::make_unique<function_declaration>(identifier(decl->identifier), parent_scope, get_function_kind(body, intrinsic));
+    auto function_decl = std::make_unique<function_declaration>(identifier(std::string(decl->identifier)), parent_scope, get_function_kind(body, intrinsic));
     assign_source_information(context, function_decl, decl);
 
     build_inputs_output(context, decl, *function_decl, output_result, ELEMENT_AST_NODE_FUNCTION);
@@ -299,7 +299,7 @@ std::unique_ptr<declaration> build_function_declaration(const element_interprete
 
 std::unique_ptr<declaration> build_namespace_declaration(const element_interpreter_ctx* context, const element_ast* const ast, const scope* const parent_scope, element_result& output_result)
 {
-    auto namespace_decl = std::make_unique<namespace_declaration>(identifier(ast->identifier), parent_scope);
+    auto namespace_decl = std::make_unique<namespace_declaration>(identifier(std::string(ast->identifier)), parent_scope);
     assign_source_information(context, namespace_decl, ast);
 
     if (ast->children.size() > ast_idx::ns::body) {
@@ -348,7 +348,7 @@ std::unique_ptr<expression> build_literal_expression(const element_interpreter_c
 std::unique_ptr<expression> build_identifier_expression(const element_interpreter_ctx* context, const element_ast* const ast, expression_chain* chain, element_result& output_result)
 {
     //no need to test for !chain->expressions.empty() since build_indexing_expression code path will always be taken in this case
-    auto expression = std::make_unique<identifier_expression>(ast->identifier, chain);
+    auto expression = std::make_unique<identifier_expression>(identifier(std::string(ast->identifier)), chain);
     assign_source_information(context, expression, ast);
     return std::move(expression);
 }
@@ -356,7 +356,7 @@ std::unique_ptr<expression> build_identifier_expression(const element_interprete
 std::unique_ptr<expression> build_indexing_expression(const element_interpreter_ctx* context, const element_ast* const ast, expression_chain* chain, element_result& output_result)
 {
     //no need to test for chain->expressions.empty() since build_identifier_expression code path will always be taken in this case
-    auto expression = std::make_unique<indexing_expression>(ast->identifier, chain);
+    auto expression = std::make_unique<indexing_expression>(identifier(std::string(ast->identifier)), chain);
     assign_source_information(context, expression, ast);
     return std::move(expression);
 }
@@ -471,7 +471,7 @@ void build_scope(const element_interpreter_ctx* context, const element_ast* ast,
             result = ELEMENT_ERROR_UNKNOWN;
 
         if (result != ELEMENT_OK) {
-            std::string identifier = child->children.empty() ? "<unknown>" : child->children[0]->identifier;
+            std::string identifier = child->children.empty() ? "<unknown>" : std::string(child->children[0]->identifier);
             log_error<log_error_message_code::failed_to_build_declaration>(context, context->src_context.get(), child.get(), std::move(identifier));
 
             if (output_result == ELEMENT_OK)
@@ -5,6 +5,7 @@
 #include "object_model/expressions/expression_chain.hpp"
 #include "object_model/scope_caches.hpp"
 #include "object_model/error.hpp"
+#include "instrumentation.hpp"
 
 using namespace element;
 
@@ -28,6 +29,7 @@ element_result scope::merge(std::unique_ptr<scope>&& other)
             declarations[identifier]->our_scope->parent_scope = this;
     }
 
+    frozen = false;
     return ELEMENT_OK;
 }
 
@@ -38,8 +40,9 @@ bool scope::mark_declaration_compiler_generated(const identifier& name)
         return false;
 
     auto decl = std::move(found_it->second);
-    decl->name.value = "@" + name.value;
+    decl->name = identifier{ "@" + name.value };
     declarations.erase(found_it);
+    frozen = false;
     auto [it, success] = declarations.try_emplace(decl->name, std::move(decl));
     return success;
 }
@@ -72,21 +75,25 @@ bool scope::mark_declaration_compiler_generated(const identifier& name)
 
 bool scope::add_declaration(std::unique_ptr<declaration> declaration, scope_caches& caches)
 {
-    auto name = declaration->name.value;
+    auto name = declaration->name;
     const auto& [it, success] = declarations.try_emplace(std::move(name), std::move(declaration));
 
-    if (success)
+    if (success) {
+        frozen = false;
         caches.mark_to_clear();
+    }
 
     return success;
 }
 
 bool scope::remove_declaration(const identifier& name, scope_caches& caches)
 {
-    const bool removed = declarations.erase(name.value) != 0;
+    const bool removed = declarations.erase(name) != 0;
 
-    if (removed)
+    if (removed) {
+        frozen = false;
         caches.mark_to_clear();
+    }
 
     return removed;
 }
@@ -131,12 +138,46 @@ std::vector<std::string> split(const std::string& full_string, char delimiter =
     return split_strings;
 }
 
-const declaration* scope::find_identifier(const identifier& name, scope_caches& caches, bool recurse) const
+void scope::freeze() const
+{
+    std::size_t capacity = 1;
+    while (capacity < declarations.size() * 2)
+        capacity *= 2;
+
+    frozen_declarations.assign(capacity, { 0, nullptr });
+    const auto mask = capacity - 1;
+    for (const auto& [identifier, declaration] : declarations) {
+        auto slot = identifier.id & mask;
+        while (frozen_declarations[slot].second)
+            slot = (slot + 1) & mask;
+
+        frozen_declarations[slot] = { identifier.id, declaration.get() };
+    }
+
+    frozen = true;
+}
+
+const declaration* scope::find_local(symbol id) const
 {
-    const auto name_it = declarations.find(name);
+    if (!frozen)
+        freeze();
+
+    //symbols are handed out sequentially, so they're already well distributed and can be used as their own hash
+    const auto mask = frozen_declarations.size() - 1;
+    for (auto slot = id & mask;; slot = (slot + 1) & mask) {
+        const auto& [slot_id, declaration] = frozen_declarations[slot];
+        if (!declaration)
+            return nullptr;
+
+        if (slot_id == id)
+            return declaration;
+    }
+}
 
-    if (name_it != declarations.end())
-        return name_it->second.get();
+const declaration* scope::find_identifier(const identifier& name, scope_caches& caches, bool recurse) const
+{
+    if (const auto* found = find_local(name.id))
+        return found;
 
     if (recurse && parent_scope)
         return parent_scope->find(name, caches, recurse);
@@ -146,24 +187,35 @@ const declaration* scope::find_identifier(const identifier& name, scope_caches&
 
 const declaration* scope::find(const identifier& name, scope_caches& caches, const bool recurse = false) const
 {
+    if (caches.stats)
+        caches.stats->increment(compilation_counter::scope_lookups);
+
     auto& cache = caches.get(this);
-    const auto name_it = cache.find(name.value);
-    if (name_it != cache.end())
+    const auto name_it = cache.find(name.id);
+    if (name_it != cache.end()) {
+        if (caches.stats)
+            caches.stats->increment(compilation_counter::scope_lookup_cache_hits);
         return name_it->second;
+    }
 
-    auto split_path = split(name.value);
-
-    const auto* scope = this;
     const declaration* found_decl = nullptr;
-    for (const auto& ident : split_path) {
-        found_decl = scope->find_identifier(ident, caches, recurse);
-        if (!found_decl)
-            return nullptr;
-
-        scope = found_decl->our_scope.get();
+    if (name.value.find('.') == std::string::npos) {
+        found_decl = find_identifier(name, caches, recurse);
+    } else {
+        const auto* scope = this;
+        for (const auto& ident : split(name.value)) {
+            found_decl = scope->find_identifier(identifier{ ident }, caches, recurse);
+            if (!found_decl)
+                return nullptr;
+
+            scope = found_decl->our_scope.get();
+        }
     }
 
-    cache[name.value] = found_decl;
+    if (!found_decl)
+        return nullptr;
+
+    cache[name.id] = found_decl;
     return found_decl;
 }
 
@@ -4,6 +4,7 @@
 #include <map>
 #include <unordered_map>
 #include <memory>
+#include <vector>
 
 //SELF
 #include "object_internal.hpp"
@@ -41,9 +42,16 @@ public:
 
 private:
     const declaration* find_identifier(const identifier& name, scope_caches& caches, bool recurse) const;
+    const declaration* find_local(symbol id) const;
+    void freeze() const;
 
     const scope* parent_scope = nullptr;
     std::string name;
     std::map<identifier, std::unique_ptr<declaration>> declarations;
+
+    //open addressed table of the declarations by symbol, rebuilt on the first lookup after the declarations change
+    //its size is a power of two and it's never more than half full, empty slots have no declaration
+    mutable std::vector<std::pair<symbol, const declaration*>> frozen_declarations;
+    mutable bool frozen = false;
 };
 } // namespace element
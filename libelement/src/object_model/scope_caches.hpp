@@ -5,25 +5,37 @@
 #include <string>
 #include <functional>
 
+//SELF
+#include "identifier.hpp"
+
 namespace element
 {
 class scope;
 class declaration;
+class instrumentation;
 
 class scope_caches
 {
 public:
-    using find_map = std::unordered_map<std::string, const declaration*>;
+    using find_map = std::unordered_map<symbol, const declaration*>;
     using scope_map = std::unordered_map<const scope*, find_map>;
 
+    scope_caches() = default;
+    explicit scope_caches(instrumentation* stats)
+        : stats(stats)
+    {}
+
     void mark_to_clear();
     find_map& get(const scope* scope);
 
+    //where lookups are recorded, if anywhere
+    instrumentation* stats = nullptr;
+
 private:
     void clear();
 
     bool marked_for_clearing = false;
-    //todo: 3rd party hashmaps like robinhood or absl could be up to twice as fast if this is a big bottleneck
+    //keyed by symbol, so a lookup only hashes an integer rather than the identifier's text
     scope_map cache;
 };
 } // namespace element
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+//STD
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+//SELF
+#include "element/common.h"
+#include "common_internal.hpp"
+
+namespace element
+{
+// a worker_count of 0 means one worker per hardware thread, and there's never any point having more workers than work
+inline std::size_t resolve_worker_count(std::size_t worker_count, std::size_t count)
+{
+    if (worker_count == 0)
+        worker_count = (std::max)(1U, std::thread::hardware_concurrency());
+    return (std::max)(std::size_t{ 1 }, (std::min)(worker_count, count));
+}
+
+// run func(i) for every i in [0, count) across worker_count threads (including the calling thread)
+// results are stored per index, so the first failure reported is the lowest-indexed one regardless of scheduling
+template <typename Func>
+element_result run_parallel(std::size_t count, std::size_t worker_count, Func&& func)
+{
+    std::vector<element_result> results(count, ELEMENT_OK);
+    std::atomic<std::size_t> next_index = 0;
+
+    auto worker = [&]() {
+        for (std::size_t i = next_index++; i < count; i = next_index++)
+            results[i] = func(i);
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(worker_count > 1 ? worker_count - 1 : 0);
+    for (std::size_t i = 1; i < worker_count; ++i)
+        threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads)
+        thread.join();
+
+    for (const auto result : results)
+        ELEMENT_OK_OR_RETURN(result);
+    return ELEMENT_OK;
+}
+} // namespace element
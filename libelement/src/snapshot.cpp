@@ -0,0 +1,291 @@
+#include "snapshot.hpp"
+
+//STD
+#include <cstring>
+#include <unordered_map>
+
+//SELF
+#include "ast/ast_internal.hpp"
+#include "token_internal.hpp"
+
+using namespace element;
+
+namespace
+{
+constexpr char snapshot_magic[8] = { 'E', 'L', 'E', 'S', 'N', 'A', 'P', '\0' };
+//bump whenever the layout below, the AST or the tokens change
+constexpr std::uint32_t snapshot_version = 3;
+constexpr int max_ast_depth = 4096;
+
+void collect_tokens(const element_ast* ast, std::unordered_map<const element_token*, std::int32_t>& indices, std::vector<const element_token*>& tokens)
+{
+    if (ast->nearest_token && indices.emplace(ast->nearest_token, static_cast<std::int32_t>(tokens.size())).second)
+        tokens.push_back(ast->nearest_token);
+
+    for (const auto& child : ast->children)
+        collect_tokens(child.get(), indices, tokens);
+}
+
+std::uint32_t ast_value_bits(const element_ast* ast)
+{
+    std::uint32_t bits = 0;
+    if (ast->type == ELEMENT_AST_NODE_LITERAL)
+        std::memcpy(&bits, &ast->literal, sizeof(bits));
+    else
+        bits = ast->flags;
+    return bits;
+}
+} // namespace
+
+snapshot_file::~snapshot_file()
+{
+    element_ast_delete(&root);
+}
+
+std::uint64_t element::hash_source(std::string_view source)
+{
+    //FNV-1a
+    std::uint64_t hash = 0xcbf29ce484222325ULL;
+    for (const char c : source) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+snapshot_writer::snapshot_writer(bool prelude_loaded, const std::vector<snapshot_package>& packages, std::size_t file_count)
+{
+    buffer.append(snapshot_magic, sizeof(snapshot_magic));
+    write(snapshot_version);
+    write(static_cast<std::uint8_t>(prelude_loaded));
+    write(static_cast<std::uint32_t>(packages.size()));
+    for (const auto& package : packages) {
+        write_string(package.name);
+        write_string(package.root);
+    }
+    write(static_cast<std::uint32_t>(file_count));
+}
+
+template <typename T>
+void snapshot_writer::write(T value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void snapshot_writer::write_string(std::string_view str)
+{
+    write(static_cast<std::uint32_t>(str.size()));
+    buffer.append(str);
+}
+
+void snapshot_writer::write_file(const snapshot_file& file)
+{
+    write_string(file.path);
+    write(file.hash);
+
+    //the size of the contents is patched in afterwards so that readers can skip stale files without decoding them
+    const auto size_position = buffer.size();
+    write(std::uint64_t{ 0 });
+    const auto contents_start = buffer.size();
+
+    write(static_cast<std::uint32_t>(file.line_offsets.size()));
+    for (const auto offset : file.line_offsets)
+        write(static_cast<std::int32_t>(offset));
+
+    std::unordered_map<const element_token*, std::int32_t> indices;
+    std::vector<const element_token*> tokens;
+    collect_tokens(file.root, indices, tokens);
+
+    write(static_cast<std::uint32_t>(tokens.size()));
+    for (const auto* token : tokens) {
+        write(static_cast<std::int32_t>(token->type));
+        write(static_cast<std::int32_t>(token->pre_pos));
+        write(static_cast<std::int32_t>(token->pre_len));
+        write(static_cast<std::int32_t>(token->tok_pos));
+        write(static_cast<std::int32_t>(token->tok_len));
+        write(static_cast<std::int32_t>(token->post_pos));
+        write(static_cast<std::int32_t>(token->post_len));
+        write(static_cast<std::int32_t>(token->line));
+        write(static_cast<std::int32_t>(token->line_start_position));
+        write(static_cast<std::int32_t>(token->character));
+    }
+
+    //pre-order, each node followed by its children
+    std::vector<const element_ast*> stack{ file.root };
+    while (!stack.empty()) {
+        const auto* ast = stack.back();
+        stack.pop_back();
+
+        write(static_cast<std::uint32_t>(ast->type));
+        write(ast_value_bits(ast));
+        write_string(ast->identifier);
+        write(ast->nearest_token ? indices.at(ast->nearest_token) : std::int32_t{ -1 });
+        write(static_cast<std::uint32_t>(ast->children.size()));
+
+        for (auto it = ast->children.rbegin(); it != ast->children.rend(); ++it)
+            stack.push_back(it->get());
+    }
+
+    const std::uint64_t contents_size = buffer.size() - contents_start;
+    std::memcpy(buffer.data() + size_position, &contents_size, sizeof(contents_size));
+}
+
+snapshot_reader::snapshot_reader(std::string data)
+    : buffer{ std::move(data) }
+{
+}
+
+template <typename T>
+bool snapshot_reader::read(T& value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    if (buffer.size() - position < sizeof(T))
+        return false;
+
+    std::memcpy(&value, buffer.data() + position, sizeof(T));
+    position += sizeof(T);
+    return true;
+}
+
+bool snapshot_reader::read_string(std::string& str)
+{
+    std::uint32_t size = 0;
+    if (!read(size) || buffer.size() - position < size)
+        return false;
+
+    str.assign(buffer.data() + position, size);
+    position += size;
+    return true;
+}
+
+bool snapshot_reader::read_header(bool& prelude_loaded, std::vector<snapshot_package>& packages, std::size_t& file_count)
+{
+    if (buffer.size() < sizeof(snapshot_magic) || std::memcmp(buffer.data(), snapshot_magic, sizeof(snapshot_magic)) != 0)
+        return false;
+    position = sizeof(snapshot_magic);
+
+    std::uint32_t version = 0;
+    if (!read(version) || version != snapshot_version)
+        return false;
+
+    std::uint8_t prelude = 0;
+    std::uint32_t package_count = 0;
+    if (!read(prelude) || !read(package_count))
+        return false;
+
+    prelude_loaded = prelude != 0;
+    packages.resize(package_count);
+    for (auto& package : packages) {
+        if (!read_string(package.name) || !read_string(package.root))
+            return false;
+    }
+
+    std::uint32_t count = 0;
+    if (!read(count))
+        return false;
+
+    file_count = count;
+    return true;
+}
+
+bool snapshot_reader::read_file_header(snapshot_file& file)
+{
+    std::uint64_t size = 0;
+    if (!read_string(file.path) || !read(file.hash) || !read(size) || buffer.size() - position < size)
+        return false;
+
+    contents_size = static_cast<std::size_t>(size);
+    return true;
+}
+
+bool snapshot_reader::skip_file_contents()
+{
+    position += contents_size;
+    contents_size = 0;
+    return true;
+}
+
+bool snapshot_reader::read_file_contents(snapshot_file& file)
+{
+    const auto contents_end = position + contents_size;
+    contents_size = 0;
+
+    file.info.file_name = std::make_unique<std::string>(file.path);
+    const char* source_name = file.info.file_name->data();
+
+    std::uint32_t line_count = 0;
+    if (!read(line_count) || line_count > (buffer.size() - position) / sizeof(std::int32_t))
+        return false;
+
+    file.line_offsets.resize(line_count);
+    for (auto& offset : file.line_offsets) {
+        if (!read(offset) || offset < 0)
+            return false;
+    }
+
+    std::uint32_t token_count = 0;
+    if (!read(token_count))
+        return false;
+
+    file.tokens.resize(token_count);
+    for (auto& token : file.tokens) {
+        std::int32_t type = 0;
+        if (!read(type) || type < ELEMENT_TOK_NONE || type > ELEMENT_TOK_EOF)
+            return false;
+
+        token.type = static_cast<element_token_type>(type);
+        if (!read(token.pre_pos) || !read(token.pre_len) || !read(token.tok_pos) || !read(token.tok_len)
+            || !read(token.post_pos) || !read(token.post_len) || !read(token.line) || !read(token.line_start_position)
+            || !read(token.character))
+            return false;
+
+        //source information indexes the source lines by token line
+        if (token.line < 1 || static_cast<std::uint32_t>(token.line) > line_count)
+            return false;
+
+        token.source_name = source_name;
+    }
+
+    file.root = element_ast::new_tree();
+    if (!read_ast(file.root, file.tokens, 0))
+        return false;
+
+    return position == contents_end;
+}
+
+bool snapshot_reader::read_ast(element_ast* ast, const std::vector<element_token>& tokens, int depth)
+{
+    if (depth > max_ast_depth)
+        return false;
+
+    std::uint32_t type = 0;
+    std::uint32_t bits = 0;
+    std::int32_t token_index = 0;
+    std::uint32_t child_count = 0;
+    std::string identifier;
+    if (!read(type) || !read(bits) || !read_string(identifier) || !read(token_index) || !read(child_count))
+        return false;
+
+    //anything past the last node type can only come from a corrupt snapshot
+    if (type > ELEMENT_AST_NODE_ANONYMOUS_BLOCK)
+        return false;
+
+    if (token_index < -1 || token_index >= static_cast<std::int32_t>(tokens.size()))
+        return false;
+
+    ast->type = static_cast<element_ast_node_type>(type);
+    ast->set_identifier(identifier);
+    if (ast->type == ELEMENT_AST_NODE_LITERAL)
+        std::memcpy(&ast->literal, &bits, sizeof(bits));
+    else
+        ast->flags = bits;
+    ast->nearest_token = token_index >= 0 ? &tokens[static_cast<std::size_t>(token_index)] : nullptr;
+
+    for (std::uint32_t i = 0; i < child_count; ++i) {
+        if (!read_ast(ast->new_child(), tokens, depth + 1))
+            return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+//STD
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//SELF
+#include "element/token.h"
+#include "common_internal.hpp"
+
+namespace element
+{
+//a parsed source file as stored in a snapshot, with everything needed to build its object model without tokenising or parsing it again
+//the interpreter keeps one for each file it loads, so that saving a snapshot doesn't need to parse them again either
+struct snapshot_file
+{
+    std::string path;
+    std::uint64_t hash = 0;
+    //the source lines aren't stored, they're taken from the file itself once its hash has been checked
+    file_information info;
+    std::vector<int> line_offsets;
+    //the AST's nearest_token pointers point in to this, so it must not be resized once the AST has been read
+    std::vector<element_token> tokens;
+    element_ast* root = nullptr;
+
+    snapshot_file() = default;
+    snapshot_file(const snapshot_file&) = delete;
+    snapshot_file& operator=(const snapshot_file&) = delete;
+    ~snapshot_file();
+};
+
+//a package and the directory it was loaded from, so that files added to it can be found whatever the working directory
+struct snapshot_package
+{
+    std::string name;
+    std::string root;
+};
+
+std::uint64_t hash_source(std::string_view source);
+
+class snapshot_writer
+{
+public:
+    snapshot_writer(bool prelude_loaded, const std::vector<snapshot_package>& packages, std::size_t file_count);
+
+    void write_file(const snapshot_file& file);
+
+    [[nodiscard]] const std::string& data() const { return buffer; }
+
+private:
+    template <typename T>
+    void write(T value);
+    void write_string(std::string_view str);
+
+    std::string buffer;
+};
+
+class snapshot_reader
+{
+public:
+    explicit snapshot_reader(std::string data);
+
+    //returns false if the data isn't a snapshot from this version of libelement
+    bool read_header(bool& prelude_loaded, std::vector<snapshot_package>& packages, std::size_t& file_count);
+
+    //reads the path and hash of the next file, leaving its contents to be read or skipped
+    bool read_file_header(snapshot_file& file);
+    bool read_file_contents(snapshot_file& file);
+    bool skip_file_contents();
+
+private:
+    template <typename T>
+    bool read(T& value);
+    bool read_string(std::string& str);
+    bool read_ast(element_ast* ast, const std::vector<element_token>& tokens, int depth);
+
+    std::string buffer;
+    std::size_t position = 0;
+    std::size_t contents_size = 0;
+};
+} // namespace element
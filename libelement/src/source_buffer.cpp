@@ -0,0 +1,128 @@
+#include "source_buffer.hpp"
+
+//STD
+#include <algorithm>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #define ELEMENT_HAS_MMAP
+#endif
+
+using namespace element;
+
+source_buffer::source_buffer(std::string text)
+    : owned{ std::move(text) }
+    , view{ owned }
+{
+}
+
+source_buffer::~source_buffer()
+{
+#if defined(ELEMENT_HAS_MMAP)
+    if (mapping)
+        munmap(mapping, mapping_size);
+#endif
+}
+
+std::shared_ptr<const source_buffer> source_buffer::from_file(const std::string& path)
+{
+#if defined(ELEMENT_HAS_MMAP)
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+
+    //empty files can't be mapped, so are read instead
+    struct stat info{};
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        const auto size = static_cast<std::size_t>(info.st_size);
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+
+        if (mapping != MAP_FAILED) {
+            auto buffer = std::shared_ptr<source_buffer>(new source_buffer());
+            buffer->mapping = mapping;
+            buffer->mapping_size = size;
+            buffer->view = std::string_view(static_cast<const char*>(mapping), size);
+            buffer->path = path;
+            buffer->device = static_cast<std::uint64_t>(info.st_dev);
+            buffer->inode = static_cast<std::uint64_t>(info.st_ino);
+            return buffer;
+        }
+    } else {
+        close(fd);
+    }
+#endif
+
+    std::ifstream f(path, std::ios::binary);
+    if (!f)
+        return nullptr;
+
+    std::string text;
+    f.seekg(0, std::ios::end);
+    text.resize(static_cast<std::size_t>(f.tellg()));
+    f.seekg(0);
+    f.read(text.data(), static_cast<std::streamsize>(text.size()));
+    return std::make_shared<const source_buffer>(std::move(text));
+}
+
+const char* source_buffer::c_str() const
+{
+    if (!mapping)
+        return owned.c_str();
+
+    std::call_once(terminated_once, [this]() { terminated = std::string(view); });
+    return terminated.c_str();
+}
+
+bool source_buffer::is_readable() const
+{
+#if defined(ELEMENT_HAS_MMAP)
+    if (!mapping)
+        return true;
+
+    //a different file at the path (or none at all) means ours has been replaced or deleted, which leaves it intact
+    struct stat info{};
+    if (stat(path.c_str(), &info) != 0)
+        return true;
+    if (static_cast<std::uint64_t>(info.st_dev) != device || static_cast<std::uint64_t>(info.st_ino) != inode)
+        return true;
+    return static_cast<std::size_t>(info.st_size) >= mapping_size;
+#else
+    return true;
+#endif
+}
+
+void file_information::set_source(std::shared_ptr<const source_buffer> buffer, std::vector<int> line_start_positions)
+{
+    std::lock_guard<std::mutex> lock(*lines_mutex);
+    source = std::move(buffer);
+    line_offsets = std::move(line_start_positions);
+    source_lines.clear();
+    source_lines.resize(line_offsets.size());
+}
+
+const std::string* file_information::get_line(int line) const
+{
+    //lines start at 1, arrays at 0
+    if (line < 1 || line > line_count())
+        return nullptr;
+
+    const auto index = static_cast<std::size_t>(line) - 1;
+    std::lock_guard<std::mutex> lock(*lines_mutex);
+    if (!source_lines[index]) {
+        static const std::string unreadable_line;
+        if (!source->is_readable())
+            return &unreadable_line;
+
+        const auto text = source->text();
+        const auto start = std::min(static_cast<std::size_t>(line_offsets[index]), text.size());
+        const auto end = std::min(text.find('\n', start), text.size());
+        source_lines[index] = std::make_unique<std::string>(text.substr(start, end - start));
+    }
+
+    return source_lines[index].get();
+}
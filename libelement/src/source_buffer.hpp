@@ -0,0 +1,74 @@
+#pragma once
+
+//STD
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace element
+{
+//The text of a source file, either mapped (read-only) from disk or held in memory
+class source_buffer
+{
+public:
+    explicit source_buffer(std::string text);
+    source_buffer(const source_buffer&) = delete;
+    source_buffer& operator=(const source_buffer&) = delete;
+    ~source_buffer();
+
+    //maps the file where the platform supports it, otherwise reads it. returns nullptr if it can't be opened
+    [[nodiscard]] static std::shared_ptr<const source_buffer> from_file(const std::string& path);
+
+    [[nodiscard]] std::string_view text() const { return view; }
+    [[nodiscard]] bool is_mapped() const { return mapping != nullptr; }
+
+    //the text as a C string. mapped text isn't null terminated, so it's copied the first time this is asked for
+    [[nodiscard]] const char* c_str() const;
+
+    //whether the text can still be read. a mapped file which has been truncated in place since it was mapped would
+    //fault when the part past its new end is read, whereas one which has been replaced or deleted is still intact
+    [[nodiscard]] bool is_readable() const;
+
+private:
+    source_buffer() = default;
+
+    std::string owned;
+    void* mapping = nullptr;
+    std::size_t mapping_size = 0;
+    std::string_view view;
+
+    //identifies the mapped file, to tell whether it's the one at path that has been truncated
+    std::string path;
+    std::uint64_t device = 0;
+    std::uint64_t inode = 0;
+
+    mutable std::once_flag terminated_once;
+    mutable std::string terminated;
+};
+
+struct file_information
+{
+    std::unique_ptr<std::string> file_name;
+
+    //lines are only copied out of the source when something first asks for them, e.g. to report an error
+    void set_source(std::shared_ptr<const source_buffer> buffer, std::vector<int> line_start_positions);
+
+    //lines start at 1, returns nullptr for lines which don't exist
+    //lines which can no longer be read from a mapped file that's been truncated since it was loaded are empty
+    [[nodiscard]] const std::string* get_line(int line) const;
+    [[nodiscard]] int line_count() const { return static_cast<int>(line_offsets.size()); }
+    [[nodiscard]] const std::shared_ptr<const source_buffer>& get_source() const { return source; }
+
+private:
+    std::shared_ptr<const source_buffer> source;
+    std::vector<int> line_offsets;
+
+    //note: unique_ptr so it's on the heap and the memory address doesn't change
+    mutable std::vector<std::unique_ptr<std::string>> source_lines;
+    //errors may be reported from several threads at once, e.g. when exporting in parallel
+    mutable std::unique_ptr<std::mutex> lines_mutex = std::make_unique<std::mutex>();
+};
+} // namespace element
@@ -4,6 +4,9 @@
 #include <string>
 #include <cassert>
 
+//SELF
+#include "source_buffer.hpp"
+
 namespace element
 {
 class source_information
@@ -11,21 +14,29 @@ class source_information
 public:
     source_information() = default;
 
-    source_information(int line, int character_start, int character_end, const std::string* line_in_source, const char* filename)
+    source_information(int line, int character_start, int character_end, const file_information* file, const char* filename)
         : line(line)
         , character_start(character_start)
         , character_end(character_end)
-        , line_in_source(line_in_source)
+        , file(file)
         , filename(filename)
     {}
 
+    [[nodiscard]] const std::string* get_line_in_source() const
+    {
+        return file ? file->get_line(line) : nullptr;
+    }
+
     const std::string& get_text() const
     {
         if (text.empty()) {
             //todo: UTF8 concerns?
             assert(character_end - character_start >= 0);
             assert(character_start > 0);
-            text = line_in_source->substr(static_cast<std::size_t>(character_start) - 1, static_cast<std::size_t>(character_end) - character_start);
+            //the line can be shorter than expected if the file it's from can no longer be read
+            const auto* line_in_source = get_line_in_source();
+            if (line_in_source && static_cast<std::size_t>(character_start) - 1 <= line_in_source->size())
+                text = line_in_source->substr(static_cast<std::size_t>(character_start) - 1, static_cast<std::size_t>(character_end) - character_start);
         }
 
         return text;
@@ -35,7 +46,8 @@ public:
     int character_start = 0;
     int character_end = 0;
 
-    const std::string* line_in_source = nullptr;
+    //the line itself is only looked up when it's needed, as most never are
+    const file_information* file = nullptr;
     const char* filename = nullptr;
 
 private:
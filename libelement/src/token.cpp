@@ -52,7 +52,7 @@ element_result element_tokeniser_get_input(const element_tokeniser_ctx* tokenise
     if (!input)
         return ELEMENT_ERROR_API_OUTPUT_IS_NULL;
 
-    *input = tokeniser->input.c_str();
+    *input = tokeniser->source ? tokeniser->source->c_str() : "";
     return ELEMENT_OK;
 }
 
@@ -105,7 +105,7 @@ element_result element_tokeniser_get_token(const element_tokeniser_ctx* tokenise
         if (tokeniser->logger) {
             const auto& last_token = tokeniser->tokens[tokeniser->tokens.size() - 1];
             element_log_message log_msg;
-            const std::string line_in_source = tokeniser->text_on_line(last_token.line);
+            const std::string line_in_source(tokeniser->text_on_line(last_token.line));
             log_msg.line_in_source = line_in_source.c_str();
             log_msg.message = message.c_str();
             log_msg.message_length = static_cast<int>(message.length());
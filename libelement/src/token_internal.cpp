@@ -37,7 +37,7 @@ static bool element_iseol(uint32_t c) { return c == '\n'; }
 static bool isid_alpha(uint32_t c) { return element_isalpha(c) || c == '_' || (c >= 0x00F0 && c <= 0xFFFF); }
 static bool isid_alnum(uint32_t c) { return element_isalnum(c) || (c >= 0x00F0 && c <= 0xFFFF); }
 
-void advance_to_end_of_line(std::string::const_iterator& it, const std::string::const_iterator& end)
+void advance_to_end_of_line(std::string_view::const_iterator& it, const std::string_view::const_iterator& end)
 {
     try {
         do {
@@ -82,9 +82,20 @@ void element_tokeniser_ctx::reset_token()
 }
 
 element_result element_tokeniser_ctx::run(const char* cinput, const char* csource_name)
+{
+    return run(std::string(cinput), csource_name);
+}
+
+element_result element_tokeniser_ctx::run(std::string text, const char* csource_name)
+{
+    return run(std::make_shared<const element::source_buffer>(std::move(text)), csource_name);
+}
+
+element_result element_tokeniser_ctx::run(std::shared_ptr<const element::source_buffer> buffer, const char* csource_name)
 {
     raw_source_name = csource_name;
-    input = cinput;
+    source = std::move(buffer);
+    input = source->text();
     pos = 0;
     line = 1;
     character = 1;
@@ -176,7 +187,7 @@ element_result element_tokeniser_ctx::run(const char* cinput, const char* csourc
                     source_line.resize(1024);
                     assert(pos - line_start_position >= 0);
                     assert(pos >= 0);
-                    memcpy(source_line.data(), cinput + line_start_position, static_cast<std::size_t>(pos) - line_start_position);
+                    memcpy(source_line.data(), input.data() + line_start_position, static_cast<std::size_t>(pos) - line_start_position);
                     return log(ELEMENT_ERROR_PARSE,
                         fmt::format("Encountered invalid character '{}' in file {} on line {} character {}\n{}",
                             std::string(begin_it, it), raw_source_name, line, character, source_line));
@@ -196,12 +207,12 @@ element_result element_tokeniser_ctx::run(const char* cinput, const char* csourc
     }
 }
 
-std::string element_tokeniser_ctx::text(const element_token* t) const
+std::string_view element_tokeniser_ctx::text(const element_token* t) const
 {
     return input.substr(t->tok_pos, t->tok_len);
 }
 
-element_result element_tokeniser_ctx::tokenise_number(std::string::iterator& it, const std::string::iterator& end)
+element_result element_tokeniser_ctx::tokenise_number(std::string_view::const_iterator& it, const std::string_view::const_iterator& end)
 {
     //TODO: Go through this in detail, also, waaaaaaaaaaaaaaaaaaaaay too long for parsing a number
     assert(cur_token.type == ELEMENT_TOK_NONE);
@@ -291,7 +302,7 @@ element_result element_tokeniser_ctx::tokenise_number(std::string::iterator& it,
     return ELEMENT_OK;
 }
 
-element_result element_tokeniser_ctx::tokenise_comment(std::string::iterator& it, const std::string::iterator& end)
+element_result element_tokeniser_ctx::tokenise_comment(std::string_view::const_iterator& it, const std::string_view::const_iterator& end)
 {
     //TODO: Go through this in detail
     if (cur_token.post_pos < 0)
@@ -316,7 +327,7 @@ element_result element_tokeniser_ctx::tokenise_comment(std::string::iterator& it
     return ELEMENT_OK;
 }
 
-element_result element_tokeniser_ctx::tokenise_identifier(std::string::iterator& it, const std::string::iterator& end)
+element_result element_tokeniser_ctx::tokenise_identifier(std::string_view::const_iterator& it, const std::string_view::const_iterator& end)
 {
     //TODO: Go through this in detail
     assert(cur_token.type == ELEMENT_TOK_NONE);
@@ -360,27 +371,32 @@ void element_tokeniser_ctx::add_token(element_token_type t, int n)
     reset_token();
 }
 
-std::string element_tokeniser_ctx::text_on_line(int line) const
+std::string_view element_tokeniser_ctx::text_on_line(int line) const
 {
     //lines start at 1, arrays at 0
     line--;
 
-    if (line < 0 || line > line_number_to_line_pos.size())
+    if (line < 0 || static_cast<std::size_t>(line) >= line_number_to_line_pos.size())
         return "invalid line";
 
     const auto start_pos = line_number_to_line_pos[line];
+    //the last line is empty when the input ends with a newline
+    if (static_cast<std::size_t>(start_pos) >= input.size())
+        return "";
+
     const auto start_it = input.begin() + start_pos;
     auto end_it = start_it;
     advance_to_end_of_line(end_it, input.end());
 
-    return std::string(start_it, end_it);
+    return input.substr(start_pos, end_it - start_it);
 }
 
 void element_tokeniser_ctx::clear()
 {
     tokens.clear();
     raw_source_name = nullptr;
-    input.clear();
+    source.reset();
+    input = {};
     line = 1;
     line_start_position = 0;
     character = 1;
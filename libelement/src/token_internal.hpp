@@ -2,6 +2,7 @@
 
 //STD
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 #include <unordered_map>
@@ -16,18 +17,22 @@ public:
     element_tokeniser_ctx();
 
     element_result run(const char* cinput, const char* cfilename);
+    element_result run(std::string source, const char* cfilename);
+    //keeps the source alive, which the token text refers to until the tokeniser is cleared or run again
+    element_result run(std::shared_ptr<const element::source_buffer> source, const char* cfilename);
     void clear();
     void reset_token();
     void add_token(element_token_type t, int n);
 
     // literal ::= [-+]? [0-9]+ ('.' [0-9]*)? ([eE] [-+]? [0-9]+)?
-    element_result tokenise_number(std::string::iterator& it, const std::string::iterator& end);
-    element_result tokenise_comment(std::string::iterator& it, const std::string::iterator& end);
+    element_result tokenise_number(std::string_view::const_iterator& it, const std::string_view::const_iterator& end);
+    element_result tokenise_comment(std::string_view::const_iterator& it, const std::string_view::const_iterator& end);
     // identifier ::= '_'? [a-zA-Z\u00F0-\uFFFF] [_a-zA-Z0-9\u00F0-\uFFFF]*
-    element_result tokenise_identifier(std::string::iterator& it, const std::string::iterator& end);
+    element_result tokenise_identifier(std::string_view::const_iterator& it, const std::string_view::const_iterator& end);
 
-    [[nodiscard]] std::string text(const element_token* t) const;
-    [[nodiscard]] std::string text_on_line(int line) const;
+    //these refer to the input, so are only valid until the tokeniser is cleared or run again
+    [[nodiscard]] std::string_view text(const element_token* t) const;
+    [[nodiscard]] std::string_view text_on_line(int line) const;
 
     element_result log(element_result message_code, const std::string& message) const;
     element_result log(element_result message_code, const std::string& message, int length, element_log_message* related_message) const;
@@ -38,7 +43,8 @@ public:
 
     std::shared_ptr<element_log_ctx> logger = nullptr;
     const char* raw_source_name = nullptr;
-    std::string input;
+    std::shared_ptr<const element::source_buffer> source;
+    std::string_view input;
     int pos = 0; //position in the source file
     int line = 1;
     int line_start_position = 0;
@@ -347,5 +347,27 @@ TEST_CASE("Parser", "[AST]")
         element_ast_delete(&parser.root);
     }
 
+    SECTION("Identifiers are stored with the AST")
+    {
+        const std::string input = "Burger1(a) = a";
+        element_tokeniser_run(tokeniser, input.c_str(), "<input>");
+
+        parser.tokeniser = tokeniser;
+        parser.ast_build();
+        auto* root = parser.root;
+
+        //the tokeniser no longer has the source the AST was parsed from
+        element_tokeniser_run(tokeniser, "Chips = 3", "<input>");
+
+        const char* identifier = nullptr;
+        REQUIRE(element_ast_get_value_as_identifier(root->children[0]->children[0].get(), &identifier) == ELEMENT_OK);
+        REQUIRE(std::string(identifier) == "Burger1");
+        REQUIRE(root->children[0]->children[1]->identifier == "a");
+        REQUIRE(root->children[0]->children[1]->arena == root->arena);
+
+        element_ast_delete(&parser.root);
+        REQUIRE(parser.root == nullptr);
+    }
+
     element_tokeniser_delete(&tokeniser);
 }
\ No newline at end of file
@@ -0,0 +1,316 @@
+//STD
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+//LIBS
+#include <fmt/format.h>
+#include <catch2/catch.hpp>
+
+//SELF
+#include "element/interpreter.h"
+#include "element/common.h"
+
+#include "util.test.hpp"
+
+//reads the inputs from the command line in order and prints every output, both as hex floats so nothing is lost
+static const char* c_export_main = R"(
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char** argv)
+{
+    float values[evaluate_INPUTS_COUNT + 1] = { 0 };
+    float results[evaluate_OUTPUTS_COUNT];
+    evaluate_outputs outputs;
+    int i;
+
+    for (i = 1; i < argc && i <= evaluate_INPUTS_COUNT; ++i)
+        values[i - 1] = strtof(argv[i], NULL);
+
+#if evaluate_INPUTS_COUNT > 0
+    {
+        evaluate_inputs inputs;
+        memcpy(&inputs, values, sizeof(inputs));
+        evaluate(&inputs, &outputs);
+    }
+#else
+    (void)values;
+    evaluate(&outputs);
+#endif
+
+    memcpy(results, &outputs, sizeof(results));
+    for (i = 0; i < evaluate_OUTPUTS_COUNT; ++i)
+        printf("%a\n", results[i]);
+
+    return 0;
+}
+)";
+
+static element_result export_c(element_interpreter_ctx* context, const element_declaration* declaration, const char* name, std::string& source)
+{
+    size_t size = 0;
+    auto result = element_interpreter_export_c(context, &declaration, &name, 1, nullptr, &size);
+    if (result != ELEMENT_OK)
+        return result;
+
+    std::vector<char> buffer(size);
+    result = element_interpreter_export_c(context, &declaration, &name, 1, buffer.data(), &size);
+    if (result == ELEMENT_OK)
+        source = buffer.data();
+    return result;
+}
+
+#if defined(__unix__)
+static bool has_c_compiler()
+{
+    static const bool available = std::system("cc --version > /dev/null 2>&1") == 0;
+    return available;
+}
+
+//compiles the source with a main that calls "evaluate", then runs it with the inputs and reads back its outputs
+static bool run_c_export(const std::string& source, const element_inputs* inputs, std::vector<element_value>& outputs)
+{
+    static int program_index = 0;
+    const auto directory = std::filesystem::temp_directory_path();
+    const auto source_path = directory / fmt::format("element_c_export_{}.c", program_index);
+    const auto program_path = directory / fmt::format("element_c_export_{}", program_index);
+    ++program_index;
+
+    {
+        std::ofstream file(source_path);
+        file << source << c_export_main;
+    }
+
+    const auto compile = fmt::format("cc -std=c99 -ffp-contract=off -o \"{}\" \"{}\" -lm", program_path.string(), source_path.string());
+    const bool compiled = std::system(compile.c_str()) == 0;
+    std::filesystem::remove(source_path);
+    if (!compiled) {
+        UNSCOPED_INFO(source);
+        return false;
+    }
+
+    auto command = fmt::format("\"{}\"", program_path.string());
+    for (size_t i = 0; inputs && i < inputs->count; ++i) {
+        std::array<char, 64> value{};
+        snprintf(value.data(), value.size(), " %a", inputs->values[i]);
+        command += value.data();
+    }
+
+    FILE* program = popen(command.c_str(), "r");
+    if (!program)
+        return false;
+
+    std::array<char, 128> line{};
+    while (fgets(line.data(), static_cast<int>(line.size()), program))
+        outputs.push_back(std::strtof(line.data(), nullptr));
+
+    const bool succeeded = pclose(program) == 0;
+    std::filesystem::remove(program_path);
+    return succeeded;
+}
+#endif
+
+//exports the declaration to C, then (where there's a C compiler) builds and runs it, checking it matches the evaluator
+static void compare_c_export(element_interpreter_ctx* context, const element_declaration* declaration, const element_inputs* inputs, const element_outputs* outputs)
+{
+    std::string source;
+    const auto result = export_c(context, declaration, "evaluate", source);
+    CHECK(result == ELEMENT_OK);
+    if (result != ELEMENT_OK)
+        return;
+
+#if defined(__unix__)
+    if (!has_c_compiler())
+        return;
+
+    std::vector<element_value> c_outputs;
+    CHECK(run_c_export(source, inputs, c_outputs));
+
+    const auto count = (std::min)(c_outputs.size(), outputs->count);
+    for (size_t i = 0; i < count; ++i) {
+        const auto expected = outputs->values[i];
+        const auto actual = c_outputs[i];
+        INFO(fmt::format("output {}: evaluator gave {}, C gave {}", i, expected, actual));
+        if (std::isnan(expected) || std::isnan(actual)) {
+            CHECK((std::isnan(expected) && std::isnan(actual)));
+        } else if (std::isinf(expected) || std::isinf(actual)) {
+            CHECK(expected == actual);
+        } else {
+            const auto scale = (std::max)({ 1.0f, std::fabs(expected), std::fabs(actual) });
+            CHECK(std::fabs(expected - actual) <= 1e-5f * scale);
+        }
+    }
+#endif
+}
+
+static bool c_export_checks_enabled = false;
+
+c_export_checks::c_export_checks()
+{
+    c_export_checks_enabled = true;
+}
+
+c_export_checks::~c_export_checks()
+{
+    c_export_checks_enabled = false;
+}
+
+void check_c_export(element_interpreter_ctx* context, const element_declaration* declaration, const element_inputs* inputs, const element_outputs* outputs)
+{
+    if (c_export_checks_enabled)
+        compare_c_export(context, declaration, inputs, outputs);
+}
+
+TEST_CASE("C Export", "[C]")
+{
+    element_interpreter_ctx* context = nullptr;
+    element_interpreter_create(&context);
+    element_interpreter_set_log_callback(context, log_callback, nullptr);
+    REQUIRE(element_interpreter_load_prelude(context) == ELEMENT_OK);
+
+    //each check has its own context, so they can all declare evaluate
+    //the C is always compared with the evaluator, which is also checked against the expected values when there are any
+    const auto check = [](const char* source, std::vector<element_value> inputs, std::vector<element_value> expected, size_t outputs_count = 1) {
+        element_interpreter_ctx* check_context = nullptr;
+        element_interpreter_create(&check_context);
+        element_interpreter_set_log_callback(check_context, log_callback, nullptr);
+        REQUIRE(element_interpreter_load_prelude(check_context) == ELEMENT_OK);
+        REQUIRE(element_interpreter_load_string(check_context, source, "<source>") == ELEMENT_OK);
+
+        element_declaration* declaration = nullptr;
+        element_instruction* instruction = nullptr;
+        element_evaluator_ctx* evaluator = nullptr;
+        REQUIRE(element_interpreter_find(check_context, "evaluate", &declaration) == ELEMENT_OK);
+        REQUIRE(element_interpreter_compile_declaration(check_context, nullptr, declaration, &instruction) == ELEMENT_OK);
+        REQUIRE(element_evaluator_create(check_context, &evaluator) == ELEMENT_OK);
+
+        std::vector<element_value> evaluated(expected.empty() ? outputs_count : expected.size());
+        element_inputs input{ inputs.data(), inputs.size() };
+        element_outputs output{ evaluated.data(), evaluated.size() };
+        REQUIRE(element_interpreter_evaluate_instruction(check_context, evaluator, instruction, &input, &output) == ELEMENT_OK);
+
+        for (size_t i = 0; i < expected.size(); ++i) {
+            if (std::isnan(expected[i]))
+                CHECK(std::isnan(evaluated[i]));
+            else
+                CHECK(evaluated[i] == Approx(expected[i]));
+        }
+
+        compare_c_export(check_context, declaration, &input, &output);
+        element_evaluator_delete(&evaluator);
+        element_instruction_delete(&instruction);
+        element_declaration_delete(&declaration);
+        element_interpreter_delete(&check_context);
+    };
+
+    SECTION("Source")
+    {
+        REQUIRE(element_interpreter_load_string(context, "struct Pair(x:Num, y:Num) evaluate(a:Num, b:Pair):Pair = Pair(b.x.mul(a), b.y.mul(a))", "<source>") == ELEMENT_OK);
+
+        element_declaration* declaration = nullptr;
+        REQUIRE(element_interpreter_find(context, "evaluate", &declaration) == ELEMENT_OK);
+
+        std::string source;
+        REQUIRE(export_c(context, declaration, "evaluate", source) == ELEMENT_OK);
+        element_declaration_delete(&declaration);
+
+        CHECK(source.find("#define evaluate_INPUTS_COUNT 3") != std::string::npos);
+        CHECK(source.find("#define evaluate_OUTPUTS_COUNT 2") != std::string::npos);
+        CHECK(source.find("float b[2];") != std::string::npos);
+        CHECK(source.find("float x;") != std::string::npos);
+        CHECK(source.find("ELEMENT_FUNCTION void evaluate(const evaluate_inputs* inputs, evaluate_outputs* outputs)") != std::string::npos);
+    }
+
+    SECTION("Invalid function names")
+    {
+        REQUIRE(element_interpreter_load_string(context, "evaluate(a:Num):Num = a", "<source>") == ELEMENT_OK);
+
+        element_declaration* declaration = nullptr;
+        REQUIRE(element_interpreter_find(context, "evaluate", &declaration) == ELEMENT_OK);
+
+        std::string source;
+        CHECK(export_c(context, declaration, "not a name", source) == ELEMENT_ERROR_API_INVALID_INPUT);
+        CHECK(export_c(context, declaration, "2d", source) == ELEMENT_ERROR_API_INVALID_INPUT);
+        CHECK(export_c(context, declaration, "while", source) == ELEMENT_ERROR_API_INVALID_INPUT);
+        element_declaration_delete(&declaration);
+    }
+
+    SECTION("Arithmetic")
+    {
+        check("evaluate(a:Num, b:Num):Num = a.mul(b).add(3.5).rem(4).pow(2)", { 3, -2 }, { 2.25f });
+    }
+
+    SECTION("Constants")
+    {
+        check("evaluate:Num = Num.NaN.add(1)", {}, { std::nanf("") });
+        check("evaluate:Num = Num.NegativeInfinity", {}, { -std::numeric_limits<float>::infinity() });
+    }
+
+    SECTION("If")
+    {
+        check("evaluate(a:Num, b:Num):Num = a.lt(b).if(a.add(7), b.mul(2))", { 1, 2 }, { 8 });
+        check("evaluate(a:Num, b:Num):Num = a.lt(b).if(a.add(7), b.mul(2))", { 3, 2 }, { 4 });
+    }
+
+    SECTION("List")
+    {
+        check("evaluate(a:Num):Num = list(1, 2, a).at(a)", { 2 }, { 2 });
+        check("evaluate(a:Num):Num = list(1, 2, a).at(a)", { -5 }, { 1 });
+        check("evaluate(a:Num):Num = list(1, 2, a).at(a)", { 7.5f }, { 7.5f });
+    }
+
+    SECTION("For")
+    {
+        check("evaluate(a:Num):Num = for(1, _(n:Num):Bool = n.lt(a), _(n:Num):Num = n.mul(2))", { 100 }, { 128 });
+    }
+
+    SECTION("Structs")
+    {
+        check("struct Pair(x:Num, y:Num) evaluate(a:Pair, b:Num):Pair = Pair(a.x.mul(b), a.y.add(b))", { 1, 2, 3 }, { 3, 5 });
+    }
+
+    SECTION("Intrinsics")
+    {
+        check("evaluate:Num = Num.acos(0).degrees", {}, { 90 });
+        check("evaluate(a:Num):Num = Num.cos(a.div(4))", { 3.14159265f }, { 0.70710678f });
+        check("evaluate(a:Num):Num = Num(Bool(a)).mul(2)", { 3 }, { 2 });
+        check("evaluate(a:Num):Num = Num(Bool(a)).mul(2)", { -3 }, { 0 });
+    }
+
+    SECTION("List operations")
+    {
+        check("evaluate(a:Num):Num = list(1, 2, 3).cycle.at(a)", { 4 }, { 2 });
+        check("evaluate(a:Num):Num = list(1, 2, 3, 4).slice(2, 3).at(a)", { 0 }, { 3 });
+        check("evaluate(a:Num, b:Num, c:Num, idx:Num):Num = List.zip(list(a, b, c), list(3, 2, 1), Num.add).at(idx)", { 1, 2, 3, 1 }, { 4 });
+        check("evaluate(a:Num, b:Num, c:Num, start:Num):Num = list(a, b, c).fold(start, Num.add)", { 1, 2, 3, 4 }, { 10 });
+        check("evaluate(a:Num, b:Num, idx:Num):Num = list(1, 2, a).map(_(n:Num) = n.mul(b)).at(idx)", { 5, 3, 2 }, { 15 });
+        check("evaluate(count:Num, idx:Num):Num = List.repeat(3, count).at(idx)", { 4, 2 }, { 3 });
+    }
+
+    SECTION("Field names")
+    {
+        //keywords are escaped with a trailing underscore, which mustn't clash with a port that's already named that way
+        check("evaluate(int:Num, int_:Num):Num = int.sub(int_)", { 5, 2 }, { 3 });
+
+        REQUIRE(element_interpreter_load_string(context, "evaluate(int:Num, int_:Num):Num = int.sub(int_)", "<source>") == ELEMENT_OK);
+        element_declaration* declaration = nullptr;
+        REQUIRE(element_interpreter_find(context, "evaluate", &declaration) == ELEMENT_OK);
+
+        std::string source;
+        REQUIRE(export_c(context, declaration, "evaluate", source) == ELEMENT_OK);
+        element_declaration_delete(&declaration);
+
+        CHECK(source.find("float int_;") != std::string::npos);
+        CHECK(source.find("float int__1;") != std::string::npos);
+    }
+
+    element_interpreter_delete(&context);
+}
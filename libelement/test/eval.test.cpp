@@ -22,10 +22,12 @@ element_result eval(const char* evaluate)
     element_interpreter_ctx* context = NULL;
     element_declaration* declaration = NULL;
     element_instruction* instruction = NULL;
+    element_evaluator_ctx* evaluator = NULL;
 
     element_interpreter_create(&context);
     element_interpreter_set_log_callback(context, log_callback, nullptr);
     element_interpreter_load_prelude(context);
+    element_evaluator_create(context, &evaluator);
 
     float inputs[] = { 1, 2 };
     float outputs[1];
@@ -56,10 +58,12 @@ element_result eval(const char* evaluate)
     output.values = outputs;
     output.count = 1;
 
-    result = element_interpreter_evaluate_instruction(context, NULL, instruction, &input, &output);
+    result = element_interpreter_evaluate_instruction(context, evaluator, instruction, &input, &output);
     if (result != ELEMENT_OK)
         goto cleanup;
 
+    check_c_export(context, declaration, &input, &output);
+
     sprintf(output_buffer + strlen(output_buffer), "%s -> {", evaluate);
     for (int i = 0; i < output.count; ++i) {
         sprintf(output_buffer + strlen(output_buffer), "%f", output.values[i]);
@@ -75,6 +79,7 @@ element_result eval(const char* evaluate)
 cleanup:
     element_declaration_delete(&declaration);
     element_instruction_delete(&instruction);
+    element_evaluator_delete(&evaluator);
     element_interpreter_delete(&context);
     return result;
 }
@@ -84,10 +89,12 @@ element_result eval_with_source(const char* source, const char* evaluate)
     element_interpreter_ctx* context = NULL;
     element_declaration* declaration = NULL;
     element_instruction* instruction = NULL;
+    element_evaluator_ctx* evaluator = NULL;
 
     element_interpreter_create(&context);
     element_interpreter_set_log_callback(context, log_callback, nullptr);
     element_interpreter_load_prelude(context);
+    element_evaluator_create(context, &evaluator);
 
     float inputs[] = { 1, 2 };
     float outputs[1];
@@ -122,10 +129,12 @@ element_result eval_with_source(const char* source, const char* evaluate)
     output.values = outputs;
     output.count = 1;
 
-    result = element_interpreter_evaluate_instruction(context, NULL, instruction, &input, &output);
+    result = element_interpreter_evaluate_instruction(context, evaluator, instruction, &input, &output);
     if (result != ELEMENT_OK)
         goto cleanup;
 
+    check_c_export(context, declaration, &input, &output);
+
     sprintf(output_buffer + strlen(output_buffer), "%s -> {", evaluate);
     for (int i = 0; i < output.count; ++i) {
         sprintf(output_buffer + strlen(output_buffer), "%f", output.values[i]);
@@ -141,6 +150,7 @@ element_result eval_with_source(const char* source, const char* evaluate)
 cleanup:
     element_declaration_delete(&declaration);
     element_instruction_delete(&instruction);
+    element_evaluator_delete(&evaluator);
     element_interpreter_delete(&context);
     return result;
 }
@@ -150,10 +160,12 @@ element_result eval_with_inputs(const char* evaluate, element_inputs* inputs, el
     element_interpreter_ctx* context = NULL;
     element_declaration* declaration = NULL;
     element_instruction* instruction = NULL;
+    element_evaluator_ctx* evaluator = NULL;
 
     element_interpreter_create(&context);
     element_interpreter_set_log_callback(context, log_callback, nullptr);
     element_interpreter_load_prelude(context);
+    element_evaluator_create(context, &evaluator);
 
     if (!package.empty()) {
         auto result = element_interpreter_load_package(context, package.c_str());
@@ -178,10 +190,12 @@ element_result eval_with_inputs(const char* evaluate, element_inputs* inputs, el
     if (result != ELEMENT_OK)
         goto cleanup;
 
-    result = element_interpreter_evaluate_instruction(context, NULL, instruction, inputs, outputs);
+    result = element_interpreter_evaluate_instruction(context, evaluator, instruction, inputs, outputs);
     if (result != ELEMENT_OK)
         goto cleanup;
 
+    check_c_export(context, declaration, inputs, outputs);
+
     sprintf(output_buffer + strlen(output_buffer), "%s -> {", evaluate);
     for (int i = 0; i < outputs->count; ++i) {
         sprintf(output_buffer + strlen(output_buffer), "%f", outputs->values[i]);
@@ -197,11 +211,13 @@ element_result eval_with_inputs(const char* evaluate, element_inputs* inputs, el
 cleanup:
     element_declaration_delete(&declaration);
     element_instruction_delete(&instruction);
+    element_evaluator_delete(&evaluator);
     element_interpreter_delete(&context);
     return result;
 }
 
-TEST_CASE("Interpreter", "[Evaluate]")
+//the cases are shared by both test cases below, which differ only in whether each one is also checked as C
+static void interpreter_cases()
 {
     SECTION("Runtime evaluation")
     {
@@ -3256,6 +3272,94 @@ TEST_CASE("Interpreter", "[Evaluate]")
                     REQUIRE(outputs[0] == 4);
                 }
 
+                SECTION("Compile-time for, iteration limit")
+                {
+                    const char* source =
+                        "struct test(value:Num)\n"
+                        "short(a:Num):Num = for(test(0), _(b:test):Bool = b.value.lt(5000), _(c:test):test = test(c.value.add(1))).value\n"
+                        "long(a:Num):Num = for(0, _(b:Num):Bool = b.lt(20000), _(c:Num):Num = c.add(1))\n";
+
+                    element_interpreter_ctx* context = nullptr;
+                    element_evaluator_ctx* evaluator = nullptr;
+                    element_interpreter_create(&context);
+                    element_interpreter_set_log_callback(context, log_callback, nullptr);
+                    REQUIRE(element_interpreter_load_prelude(context) == ELEMENT_OK);
+                    REQUIRE(element_interpreter_load_string(context, source, "<input>") == ELEMENT_OK);
+                    REQUIRE(element_evaluator_create(context, &evaluator) == ELEMENT_OK);
+
+                    const auto compile_and_evaluate = [context, evaluator](const char* name, float& output) {
+                        element_declaration* declaration = nullptr;
+                        element_instruction* instruction = nullptr;
+                        float inputs[] = { 0 };
+                        element_inputs input{ inputs, 1 };
+                        element_outputs outputs{ &output, 1 };
+
+                        element_result result = element_interpreter_find(context, name, &declaration);
+                        if (result == ELEMENT_OK)
+                            result = element_interpreter_compile_declaration(context, nullptr, declaration, &instruction);
+                        if (result == ELEMENT_OK && !instruction)
+                            result = ELEMENT_ERROR_UNKNOWN;
+                        if (result == ELEMENT_OK)
+                            result = element_interpreter_evaluate_instruction(context, evaluator, instruction, &input, &outputs);
+
+                        element_declaration_delete(&declaration);
+                        element_instruction_delete(&instruction);
+                        return result;
+                    };
+
+                    float output = 0;
+                    REQUIRE(compile_and_evaluate("short", output) == ELEMENT_OK);
+                    REQUIRE(output == 5000);
+
+                    //exceeds the default limit
+                    REQUIRE(compile_and_evaluate("long", output) != ELEMENT_OK);
+
+                    REQUIRE(element_interpreter_set_max_loop_iterations(context, 20000) == ELEMENT_OK);
+                    REQUIRE(compile_and_evaluate("long", output) == ELEMENT_OK);
+                    REQUIRE(output == 20000);
+
+                    element_evaluator_delete(&evaluator);
+                    element_interpreter_delete(&context);
+                }
+
+                SECTION("Compile-time for, falling back to the object model")
+                {
+                    //the body can't be compiled with placeholder inputs, since the inner loop then isn't compile-time
+                    const char* source =
+                        "inner(a:Num):Num = for(list(a), _(l:List):Bool = l.at(0).lt(10), _(l:List):List = list(l.at(0).add(1))).at(0)\n"
+                        "outer(a:Num):Num = for(0, _(b:Num):Bool = b.lt(3), _(c:Num):Num = inner(c))\n";
+
+                    size_t messages_logged = 0;
+                    element_interpreter_ctx* context = nullptr;
+                    element_evaluator_ctx* evaluator = nullptr;
+                    element_interpreter_create(&context);
+                    element_interpreter_set_log_callback(context, [](const element_log_message* msg, void* user_data) {
+                        log_callback(msg, nullptr);
+                        ++*static_cast<size_t*>(user_data);
+                    }, &messages_logged);
+                    REQUIRE(element_interpreter_load_prelude(context) == ELEMENT_OK);
+                    REQUIRE(element_interpreter_load_string(context, source, "<input>") == ELEMENT_OK);
+                    REQUIRE(element_evaluator_create(context, &evaluator) == ELEMENT_OK);
+
+                    element_declaration* declaration = nullptr;
+                    element_instruction* instruction = nullptr;
+                    float inputs[] = { 0 };
+                    float outputs[] = { 0 };
+                    element_inputs input{ inputs, 1 };
+                    element_outputs output{ outputs, 1 };
+                    REQUIRE(element_interpreter_find(context, "outer", &declaration) == ELEMENT_OK);
+                    REQUIRE(element_interpreter_compile_declaration(context, nullptr, declaration, &instruction) == ELEMENT_OK);
+                    REQUIRE(element_interpreter_evaluate_instruction(context, evaluator, instruction, &input, &output) == ELEMENT_OK);
+                    REQUIRE(outputs[0] == 10);
+                    //the failed attempt to compile the loop for the evaluator isn't reported
+                    REQUIRE(messages_logged == 0);
+
+                    element_declaration_delete(&declaration);
+                    element_instruction_delete(&instruction);
+                    element_evaluator_delete(&evaluator);
+                    element_interpreter_delete(&context);
+                }
+
                 SECTION("Dynamic-time for, initial")
                 {
                     float inputs[] = { 0 };
@@ -3862,6 +3966,140 @@ TEST_CASE("Interpreter", "[Evaluate]")
         element_interpreter_delete(&context);
     }
 
+    SECTION("element_interpreter_evaluate_expression cached")
+    {
+        element_interpreter_ctx* context;
+        element_evaluator_ctx* evaluator;
+        element_interpreter_create(&context);
+        element_interpreter_set_log_callback(context, log_callback, nullptr);
+        REQUIRE(element_interpreter_load_prelude(context) == ELEMENT_OK);
+        REQUIRE(element_evaluator_create(context, &evaluator) == ELEMENT_OK);
+
+        element_outputs output;
+        float outputs_buffer[] = { 0 };
+        output.values = outputs_buffer;
+        output.count = 1;
+
+        element_expression_cache_stats stats;
+        for (int i = 0; i < 3; ++i) {
+            REQUIRE(element_interpreter_evaluate_expression(context, evaluator, "Num.add(1, 2)", &output) == ELEMENT_OK);
+            REQUIRE(outputs_buffer[0] == 3);
+        }
+
+        REQUIRE(element_interpreter_get_expression_cache_stats(context, &stats) == ELEMENT_OK);
+        REQUIRE(stats.misses == 1);
+        REQUIRE(stats.hits == 2);
+        REQUIRE(stats.size == 1);
+
+        //loading more source could change what the expression means
+        REQUIRE(element_interpreter_load_string(context, "three = 3", "<input>") == ELEMENT_OK);
+        REQUIRE(element_interpreter_evaluate_expression(context, evaluator, "Num.add(1, 2)", &output) == ELEMENT_OK);
+        REQUIRE(element_interpreter_get_expression_cache_stats(context, &stats) == ELEMENT_OK);
+        REQUIRE(stats.misses == 2);
+
+        //least recently used expressions are discarded
+        REQUIRE(element_interpreter_set_expression_cache_capacity(context, 1) == ELEMENT_OK);
+        REQUIRE(element_interpreter_evaluate_expression(context, evaluator, "three.mul(2)", &output) == ELEMENT_OK);
+        REQUIRE(outputs_buffer[0] == 6);
+        REQUIRE(element_interpreter_evaluate_expression(context, evaluator, "Num.add(1, 2)", &output) == ELEMENT_OK);
+        REQUIRE(element_interpreter_get_expression_cache_stats(context, &stats) == ELEMENT_OK);
+        REQUIRE(stats.misses == 4);
+        REQUIRE(stats.size == 1);
+        REQUIRE(stats.capacity == 1);
+
+        //as could changing whether source is only parsed
+        REQUIRE(element_interpreter_set_parse_only(context, true) == ELEMENT_OK);
+        REQUIRE(element_interpreter_set_parse_only(context, false) == ELEMENT_OK);
+        REQUIRE(element_interpreter_evaluate_expression(context, evaluator, "Num.add(1, 2)", &output) == ELEMENT_OK);
+        REQUIRE(element_interpreter_get_expression_cache_stats(context, &stats) == ELEMENT_OK);
+        REQUIRE(stats.misses == 5);
+
+        element_evaluator_delete(&evaluator);
+        element_interpreter_delete(&context);
+    }
+
+    SECTION("element_interpreter_evaluate_expression layered calls")
+    {
+        element_interpreter_ctx* context;
+        element_evaluator_ctx* evaluator;
+        element_interpreter_create(&context);
+        element_interpreter_set_log_callback(context, log_callback, nullptr);
+        REQUIRE(element_interpreter_load_prelude(context) == ELEMENT_OK);
+        REQUIRE(element_evaluator_create(context, &evaluator) == ELEMENT_OK);
+
+        //each layer calls the one below twice with the same arguments, so compiling it shouldn't take 2^layers calls
+        std::string src = "layer0(a:Num):Num = a\n";
+        for (int i = 1; i <= 24; ++i)
+            src += fmt::format("layer{}(a:Num):Num = layer{}(a).add(layer{}(a))\n", i, i - 1, i - 1);
+        REQUIRE(element_interpreter_load_string(context, src.c_str(), "<input>") == ELEMENT_OK);
+
+        element_outputs output;
+        float outputs_buffer[] = { 0 };
+        output.values = outputs_buffer;
+        output.count = 1;
+
+        REQUIRE(element_interpreter_evaluate_expression(context, evaluator, "layer24(1)", &output) == ELEMENT_OK);
+        REQUIRE(outputs_buffer[0] == 16777216);
+
+        element_evaluator_delete(&evaluator);
+        element_interpreter_delete(&context);
+    }
+
+    SECTION("element_interpreter_get_compilation_stats")
+    {
+        element_interpreter_ctx* context;
+        element_evaluator_ctx* evaluator;
+        element_interpreter_create(&context);
+        element_interpreter_set_log_callback(context, log_callback, nullptr);
+        REQUIRE(element_interpreter_set_compilation_stats_enabled(context, true) == ELEMENT_OK);
+        REQUIRE(element_interpreter_load_prelude(context) == ELEMENT_OK);
+        REQUIRE(element_evaluator_create(context, &evaluator) == ELEMENT_OK);
+
+        element_compilation_stats stats;
+        REQUIRE(element_interpreter_get_compilation_stats(context, &stats) == ELEMENT_OK);
+        REQUIRE(stats.tokenise_ns > 0);
+        REQUIRE(stats.parse_ns > 0);
+        REQUIRE(stats.build_object_model_ns > 0);
+        REQUIRE(stats.calls == 0);
+
+        element_outputs output;
+        float outputs_buffer[] = { 0 };
+        output.values = outputs_buffer;
+        output.count = 1;
+
+        REQUIRE(element_interpreter_load_string(context, "twice(a:Num):Num = a.add(a)\nquad(a:Num):Num = twice(a).add(twice(a))", "<input>") == ELEMENT_OK);
+        REQUIRE(element_interpreter_evaluate_expression(context, evaluator, "quad(2)", &output) == ELEMENT_OK);
+        REQUIRE(outputs_buffer[0] == 8);
+
+        REQUIRE(element_interpreter_get_compilation_stats(context, &stats) == ELEMENT_OK);
+        REQUIRE(stats.compile_ns > 0);
+        REQUIRE(stats.calls > 0);
+        REQUIRE(stats.memoised_calls > 0);
+        REQUIRE(stats.instructions_created > 0);
+        REQUIRE(stats.scope_lookups > 0);
+        REQUIRE(stats.scope_lookup_cache_hits <= stats.scope_lookups);
+        REQUIRE(stats.compile_ns >= stats.instruction_cache_ns);
+
+        size_t size = 0;
+        REQUIRE(element_interpreter_get_compilation_stats_json(context, nullptr, &size) == ELEMENT_OK);
+        std::vector<char> json(size);
+        size_t too_small = size - 1;
+        REQUIRE(element_interpreter_get_compilation_stats_json(context, json.data(), &too_small) == ELEMENT_ERROR_API_INSUFFICIENT_BUFFER);
+        REQUIRE(element_interpreter_get_compilation_stats_json(context, json.data(), &size) == ELEMENT_OK);
+        REQUIRE(std::string(json.data()).find(fmt::format("\"calls\":{}", stats.calls)) != std::string::npos);
+
+        //nothing is recorded while disabled
+        REQUIRE(element_interpreter_reset_compilation_stats(context) == ELEMENT_OK);
+        REQUIRE(element_interpreter_set_compilation_stats_enabled(context, false) == ELEMENT_OK);
+        REQUIRE(element_interpreter_evaluate_expression(context, evaluator, "quad(3)", &output) == ELEMENT_OK);
+        REQUIRE(element_interpreter_get_compilation_stats(context, &stats) == ELEMENT_OK);
+        REQUIRE(stats.compile_ns == 0);
+        REQUIRE(stats.calls == 0);
+
+        element_evaluator_delete(&evaluator);
+        element_interpreter_delete(&context);
+    }
+
     SECTION("element_interpreter_typeof_expression once")
     {
         element_interpreter_ctx* context;
@@ -3946,4 +4184,17 @@ TEST_CASE("Interpreter", "[Evaluate]")
         REQUIRE(outputs[0] == 1.0f);
         REQUIRE(outputs[1] == 1.0f);
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Interpreter", "[Evaluate]")
+{
+    interpreter_cases();
+}
+
+//every case is exported to C, then built and run with the system C compiler, which is too slow to do by default
+//run with: element_tests "[C]"
+TEST_CASE("Interpreter compared with C export", "[C][.]")
+{
+    const c_export_checks checks;
+    interpreter_cases();
+}
@@ -0,0 +1,338 @@
+//STD
+#include <algorithm>
+#include <array>
+#include <vector>
+
+//LIBS
+#include <catch2/catch.hpp>
+
+//SELF
+#include "element/interpreter.h"
+#include "element/common.h"
+#include "lmnt/archive.h"
+#include "lmnt/interpreter.h"
+#include "lmnt/opcodes.h"
+
+#include "lmnt/compiler.hpp"
+#include "util.test.hpp"
+
+static const char* export_source = R"(
+    first(a:Num, b:Num):Num = a.mul(b).add(3.5)
+    second(a:Num, b:Num):Num = a.sub(b).mul(3.5).add(0.25)
+    third(a:Num, b:Num):Num = a.lt(b).if(a.add(7), b.mul(2))
+    fourth(a:Num, b:Num):Num = a.add(b).add(0.25).mul(9)
+    shared(a:Num, b:Num):Num = a.mul(b).add(a).div(b.add(1))
+    left(a:Num, b:Num):Num = shared(a, b).add(1)
+    right(a:Num, b:Num):Num = shared(a, b).mul(2)
+    unary(a:Num):Num = a.add(1)
+    twin(a:Num, b:Num):Num = a.mul(b).add(3.5)
+    struct Pair(x:Num, y:Num)
+    pair(a:Num, b:Num):Pair = Pair(a.add(b), a.mul(b))
+    swapped(a:Num, b:Num):Pair = Pair(b, a.sub(1))
+)";
+
+static const std::vector<const char*> export_names = { "first", "second", "third", "fourth" };
+
+// finds the named declarations and exports them with export_fn, called first to size the archive and then to write it
+template <typename ExportFn>
+static element_result export_declarations(element_interpreter_ctx* context, const std::vector<const char*>& names, std::vector<char>& archive, ExportFn export_fn)
+{
+    std::vector<const element_declaration*> decls;
+    std::vector<element_declaration*> found(names.size(), nullptr);
+    element_result result = ELEMENT_OK;
+    for (size_t i = 0; i < names.size() && result == ELEMENT_OK; ++i) {
+        result = element_interpreter_find(context, names[i], &found[i]);
+        decls.push_back(found[i]);
+    }
+
+    size_t size = 0;
+    if (result == ELEMENT_OK)
+        result = export_fn(decls.data(), static_cast<char*>(nullptr), &size);
+    if (result == ELEMENT_OK) {
+        archive.resize(size);
+        result = export_fn(decls.data(), archive.data(), &size);
+    }
+
+    for (auto* decl : found)
+        element_declaration_delete(&decl);
+    return result;
+}
+
+static element_result export_archive(element_interpreter_ctx* context, std::vector<const char*> names, size_t worker_count, std::vector<char>& archive)
+{
+    return export_declarations(context, names, archive, [&](const element_declaration** decls, char* buffer, size_t* size) {
+        return element_interpreter_export_lmnt_parallel(context, decls, names.data(), names.size(), worker_count, buffer, size);
+    });
+}
+
+static element_result export_fused_archive(element_interpreter_ctx* context, std::vector<const char*> names, const char* fused_name, std::vector<char>& archive)
+{
+    return export_declarations(context, names, archive, [&](const element_declaration** decls, char* buffer, size_t* size) {
+        return element_interpreter_export_lmnt_fused(context, decls, names.data(), names.size(), fused_name, buffer, size);
+    });
+}
+
+// loads and prepares the archive with ctx using memory, which both have to outlive
+static void load_archive(std::vector<char>& archive, lmnt_ictx& ctx, std::vector<char>& memory)
+{
+    memory.resize(16384);
+    REQUIRE(lmnt_init(&ctx, memory.data(), memory.size()) == LMNT_OK);
+    REQUIRE(lmnt_load_archive(&ctx, archive.data(), archive.size()) == LMNT_OK);
+    REQUIRE(lmnt_prepare_archive(&ctx, nullptr) == LMNT_OK);
+}
+
+static const lmnt_def* find_def(lmnt_ictx& ctx, const char* name)
+{
+    const lmnt_def* def = nullptr;
+    REQUIRE(lmnt_find_def(&ctx, name, &def) == LMNT_OK);
+    return def;
+}
+
+static std::vector<lmnt_value> get_constants(std::vector<char>& archive)
+{
+    std::vector<char> memory;
+    lmnt_ictx ctx;
+    load_archive(archive, ctx, memory);
+
+    lmnt_offset count = 0;
+    REQUIRE(lmnt_archive_get_constants_count(&ctx.archive, &count) == LMNT_OK);
+    const lmnt_value* table = nullptr;
+    REQUIRE(lmnt_archive_get_constants(&ctx.archive, 0, &table) == LMNT_OK);
+    return std::vector<lmnt_value>(table, table + count);
+}
+
+static lmnt_loffset get_code_offset(std::vector<char>& archive, const char* name)
+{
+    std::vector<char> memory;
+    lmnt_ictx ctx;
+    load_archive(archive, ctx, memory);
+    return find_def(ctx, name)->code;
+}
+
+static lmnt_loffset get_instructions_count(std::vector<char>& archive, const char* name)
+{
+    std::vector<char> memory;
+    lmnt_ictx ctx;
+    load_archive(archive, ctx, memory);
+
+    const lmnt_code* code = nullptr;
+    REQUIRE(lmnt_archive_get_code(&ctx.archive, find_def(ctx, name)->code, &code) == LMNT_OK);
+    return code->instructions_count;
+}
+
+static lmnt_value execute_archive(std::vector<char>& archive, const char* name, lmnt_value a, lmnt_value b)
+{
+    std::vector<char> memory;
+    lmnt_ictx ctx;
+    load_archive(archive, ctx, memory);
+    const lmnt_def* def = find_def(ctx, name);
+
+    const lmnt_value args[] = { a, b };
+    REQUIRE(lmnt_update_args(&ctx, def, 0, args, 2) == LMNT_OK);
+
+    lmnt_value rval = 0.0f;
+    REQUIRE(lmnt_execute(&ctx, def, &rval, 1) == 1);
+    return rval;
+}
+
+TEST_CASE("LMNT Export", "[LMNT]")
+{
+    element_interpreter_ctx* context = nullptr;
+    element_interpreter_create(&context);
+    element_interpreter_set_log_callback(context, log_callback, nullptr);
+    REQUIRE(element_interpreter_load_prelude(context) == ELEMENT_OK);
+    REQUIRE(element_interpreter_load_string(context, export_source, "<source>") == ELEMENT_OK);
+
+    SECTION("Parallel export is deterministic")
+    {
+        std::vector<char> serial;
+        REQUIRE(export_archive(context, export_names, 1, serial) == ELEMENT_OK);
+
+        for (size_t workers : { 2, 4, 0 }) {
+            std::vector<char> parallel;
+            REQUIRE(export_archive(context, export_names, workers, parallel) == ELEMENT_OK);
+            REQUIRE(parallel == serial);
+        }
+    }
+
+    SECTION("Parallel export executes correctly")
+    {
+        std::vector<char> archive;
+        REQUIRE(export_archive(context, export_names, 4, archive) == ELEMENT_OK);
+
+        REQUIRE(execute_archive(archive, "first", 2.0f, 3.0f) == Approx(9.5f));
+        REQUIRE(execute_archive(archive, "second", 5.0f, 3.0f) == Approx(7.25f));
+        REQUIRE(execute_archive(archive, "third", 1.0f, 3.0f) == Approx(8.0f));
+        REQUIRE(execute_archive(archive, "third", 5.0f, 3.0f) == Approx(6.0f));
+        REQUIRE(execute_archive(archive, "fourth", 1.0f, 2.0f) == Approx(29.25f));
+    }
+
+    SECTION("Archives allocated by libelement match those written to a buffer")
+    {
+        std::vector<char> expected;
+        REQUIRE(export_archive(context, export_names, 2, expected) == ELEMENT_OK);
+
+        std::vector<element_declaration*> found(export_names.size(), nullptr);
+        for (size_t i = 0; i < export_names.size(); ++i)
+            REQUIRE(element_interpreter_find(context, export_names[i], &found[i]) == ELEMENT_OK);
+        std::vector<const element_declaration*> decls(found.begin(), found.end());
+        std::vector<const char*> names = export_names;
+
+        element_lmnt_archive* archive = nullptr;
+        REQUIRE(element_interpreter_export_lmnt_archive(context, decls.data(), names.data(), names.size(), 2, &archive) == ELEMENT_OK);
+
+        const char* data = nullptr;
+        size_t size = 0;
+        REQUIRE(element_lmnt_archive_get_data(archive, &data, &size) == ELEMENT_OK);
+        REQUIRE(std::vector<char>(data, data + size) == expected);
+
+        element_lmnt_archive_delete(&archive);
+        REQUIRE(archive == nullptr);
+        for (auto* decl : found)
+            element_declaration_delete(&decl);
+    }
+
+    SECTION("Fused export returns every function's outputs from one def")
+    {
+        std::vector<char> archive;
+        REQUIRE(export_fused_archive(context, { "first", "second", "third", "fourth" }, "all", archive) == ELEMENT_OK);
+
+        std::vector<char> memory;
+        lmnt_ictx ctx;
+        load_archive(archive, ctx, memory);
+
+        const lmnt_def* def = find_def(ctx, "all");
+        REQUIRE(def->args_count == 2);
+        REQUIRE(def->rvals_count == 4);
+
+        const lmnt_value args[] = { 1.0f, 3.0f };
+        REQUIRE(lmnt_update_args(&ctx, def, 0, args, 2) == LMNT_OK);
+        std::array<lmnt_value, 4> rvals{};
+        REQUIRE(lmnt_execute(&ctx, def, rvals.data(), lmnt_offset(rvals.size())) == 4);
+        REQUIRE(rvals[0] == Approx(6.5f));
+        REQUIRE(rvals[1] == Approx(-6.75f));
+        REQUIRE(rvals[2] == Approx(8.0f));
+        REQUIRE(rvals[3] == Approx(38.25f));
+
+        // the aliases behave like the separately-exported functions
+        REQUIRE(execute_archive(archive, "first", 2.0f, 3.0f) == Approx(9.5f));
+        REQUIRE(execute_archive(archive, "second", 5.0f, 3.0f) == Approx(7.25f));
+        REQUIRE(execute_archive(archive, "third", 1.0f, 3.0f) == Approx(8.0f));
+        REQUIRE(execute_archive(archive, "third", 5.0f, 3.0f) == Approx(6.0f));
+        REQUIRE(execute_archive(archive, "fourth", 1.0f, 2.0f) == Approx(29.25f));
+    }
+
+    SECTION("Fused aliases only need their own inputs")
+    {
+        std::vector<char> archive;
+        REQUIRE(export_fused_archive(context, { "first", "pair", "third", "swapped" }, "all", archive) == ELEMENT_OK);
+
+        std::vector<char> memory;
+        lmnt_ictx ctx;
+        load_archive(archive, ctx, memory);
+
+        // each alias is run on its own, with only the two real inputs set and garbage left in the rest of the args
+        const auto execute_alias = [&ctx](const char* name, lmnt_offset rvals_count, lmnt_value a, lmnt_value b) {
+            const lmnt_def* def = find_def(ctx, name);
+            REQUIRE(def->args_count >= 2);
+            REQUIRE(def->rvals_count == rvals_count);
+
+            lmnt_value* args = nullptr;
+            REQUIRE(lmnt_get_args_ptr(&ctx, def, &args) == LMNT_OK);
+            std::fill(args, args + def->args_count, 1234.5f);
+
+            const lmnt_value inputs[] = { a, b };
+            REQUIRE(lmnt_update_args(&ctx, def, 0, inputs, 2) == LMNT_OK);
+            std::vector<lmnt_value> rvals(rvals_count);
+            REQUIRE(lmnt_execute(&ctx, def, rvals.data(), rvals_count) == rvals_count);
+            return rvals;
+        };
+
+        REQUIRE(execute_alias("first", 1, 2.0f, 3.0f) == std::vector<lmnt_value>{ 9.5f });
+        REQUIRE(execute_alias("pair", 2, 2.0f, 3.0f) == std::vector<lmnt_value>{ 5.0f, 6.0f });
+        REQUIRE(execute_alias("third", 1, 5.0f, 3.0f) == std::vector<lmnt_value>{ 6.0f });
+        REQUIRE(execute_alias("swapped", 2, 2.0f, 3.0f) == std::vector<lmnt_value>{ 3.0f, 1.0f });
+        REQUIRE(execute_alias("pair", 2, -1.0f, 4.0f) == std::vector<lmnt_value>{ 3.0f, -4.0f });
+    }
+
+    SECTION("Fused export shares common subexpressions")
+    {
+        std::vector<char> fused;
+        REQUIRE(export_fused_archive(context, { "left", "right" }, "both", fused) == ELEMENT_OK);
+        REQUIRE(execute_archive(fused, "left", 2.0f, 3.0f) == Approx(3.0f));
+        REQUIRE(execute_archive(fused, "right", 2.0f, 3.0f) == Approx(4.0f));
+
+        std::vector<char> separate;
+        REQUIRE(export_archive(context, { "left", "right" }, 1, separate) == ELEMENT_OK);
+
+        const auto separate_count = get_instructions_count(separate, "left") + get_instructions_count(separate, "right");
+        REQUIRE(get_instructions_count(fused, "both") < separate_count);
+    }
+
+    SECTION("Fused export requires matching inputs and distinct names")
+    {
+        std::vector<char> archive;
+        REQUIRE(export_fused_archive(context, { "first", "unary" }, "all", archive) == ELEMENT_ERROR_API_INVALID_INPUT);
+        REQUIRE(export_fused_archive(context, { "first", "second" }, "first", archive) == ELEMENT_ERROR_API_INVALID_INPUT);
+        REQUIRE(export_fused_archive(context, { "first", "first" }, "all", archive) == ELEMENT_ERROR_API_INVALID_INPUT);
+    }
+
+    SECTION("Export only keeps constants which are used, in order of first use")
+    {
+        std::vector<char> archive;
+        REQUIRE(export_archive(context, { "fourth", "first", "second" }, 1, archive) == ELEMENT_OK);
+        // fourth uses 0.25 and 9, then first introduces 3.5 and second reuses 3.5 and 0.25
+        REQUIRE(get_constants(archive) == std::vector<lmnt_value>{ 0.25f, 9.0f, 3.5f });
+        REQUIRE(execute_archive(archive, "fourth", 1.0f, 2.0f) == Approx(29.25f));
+        REQUIRE(execute_archive(archive, "first", 2.0f, 3.0f) == Approx(9.5f));
+        REQUIRE(execute_archive(archive, "second", 5.0f, 3.0f) == Approx(7.25f));
+    }
+
+    SECTION("Functions which compile to the same code share it")
+    {
+        std::vector<char> archive;
+        REQUIRE(export_archive(context, { "first", "second", "twin" }, 1, archive) == ELEMENT_OK);
+        REQUIRE(get_code_offset(archive, "first") == get_code_offset(archive, "twin"));
+        REQUIRE(get_code_offset(archive, "first") != get_code_offset(archive, "second"));
+        REQUIRE(execute_archive(archive, "twin", 2.0f, 3.0f) == Approx(9.5f));
+        REQUIRE(execute_archive(archive, "second", 5.0f, 3.0f) == Approx(7.25f));
+    }
+
+    element_interpreter_delete(&context);
+}
+
+TEST_CASE("LMNT Constant Compaction", "[LMNT]")
+{
+    // three constants, of which only the last is used, followed by the function's arg, rval and a local
+    const auto compact = [](lmnt_instruction instruction, std::vector<element_value>& constants) {
+        std::vector<element_lmnt_compiled_function> functions(1);
+        functions[0].inputs_count = 1;
+        functions[0].outputs_count = 1;
+        functions[0].local_stack_count = 1;
+        functions[0].instructions = { { LMNT_OP_ADDSS, 2, 3, 5 }, instruction };
+        constants = { 1.0f, 2.0f, 3.0f };
+        REQUIRE(element_lmnt_compact_constants(functions, constants) == ELEMENT_OK);
+        return functions[0].instructions;
+    };
+
+    SECTION("Unused constants are removed")
+    {
+        std::vector<element_value> constants;
+        const auto instructions = compact({ LMNT_OP_ASSIGNSS, 5, 0, 4 }, constants);
+        REQUIRE(constants == std::vector<element_value>{ 3.0f });
+        REQUIRE(instructions[0].arg1 == 0);
+        REQUIRE(instructions[0].arg2 == 1);
+        REQUIRE(instructions[0].arg3 == 3);
+        REQUIRE(instructions[1].arg1 == 3);
+        REQUIRE(instructions[1].arg3 == 2);
+    }
+
+    SECTION("Indexing into a stack index held in a value leaves everything alone")
+    {
+        std::vector<element_value> constants;
+        const auto instructions = compact({ LMNT_OP_INDEXRIR, 3, 3, 5 }, constants);
+        REQUIRE(constants == std::vector<element_value>{ 1.0f, 2.0f, 3.0f });
+        REQUIRE(instructions[0].arg1 == 2);
+        REQUIRE(instructions[1].arg3 == 5);
+    }
+}
@@ -0,0 +1,284 @@
+//STD
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+//LIBS
+#include <catch2/catch.hpp>
+
+//SELF
+#include "element/interpreter.h"
+#include "element/common.h"
+#include "element/ast.h"
+
+#include "util.test.hpp"
+
+static void write_file(const std::string& path, const std::string& contents)
+{
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    f << contents;
+}
+
+static std::string read_file(const std::string& path)
+{
+    std::ifstream f(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+}
+
+static element_result evaluate(element_interpreter_ctx* context, const char* name, float a, float b, float& output)
+{
+    element_evaluator_ctx* evaluator = nullptr;
+    element_declaration* declaration = nullptr;
+    element_instruction* instruction = nullptr;
+    float inputs[] = { a, b };
+    element_inputs input{ inputs, 2 };
+    element_outputs outputs{ &output, 1 };
+
+    element_result result = element_evaluator_create(context, &evaluator);
+    if (result == ELEMENT_OK)
+        result = element_interpreter_find(context, name, &declaration);
+    if (result == ELEMENT_OK)
+        result = element_interpreter_compile_declaration(context, nullptr, declaration, &instruction);
+    if (result == ELEMENT_OK && !instruction)
+        result = ELEMENT_ERROR_UNKNOWN;
+    if (result == ELEMENT_OK)
+        result = element_interpreter_evaluate_instruction(context, evaluator, instruction, &input, &outputs);
+
+    element_declaration_delete(&declaration);
+    element_instruction_delete(&instruction);
+    element_evaluator_delete(&evaluator);
+    return result;
+}
+
+TEST_CASE("Snapshot", "[API]")
+{
+    const std::string snapshot_path = "snapshot.test.elesnap";
+    const std::string source_path = "snapshot_test.ele";
+    write_file(source_path, "first(a:Num, b:Num):Num = a.mul(b).add(1)\n");
+
+    element_interpreter_ctx* context = nullptr;
+    element_interpreter_create(&context);
+    element_interpreter_set_log_callback(context, log_callback, nullptr);
+    REQUIRE(element_interpreter_load_prelude(context) == ELEMENT_OK);
+    REQUIRE(element_interpreter_load_file(context, source_path.c_str()) == ELEMENT_OK);
+    REQUIRE(element_interpreter_save_snapshot(context, snapshot_path.c_str()) == ELEMENT_OK);
+    element_interpreter_delete(&context);
+
+    element_interpreter_create(&context);
+    element_interpreter_set_log_callback(context, log_callback, nullptr);
+
+    SECTION("Loads the prelude and files")
+    {
+        REQUIRE(element_interpreter_load_snapshot(context, snapshot_path.c_str()) == ELEMENT_OK);
+        REQUIRE(element_interpreter_load_prelude(context) == ELEMENT_ERROR_PRELUDE_ALREADY_LOADED);
+
+        float output = 0;
+        REQUIRE(evaluate(context, "first", 2, 3, output) == ELEMENT_OK);
+        REQUIRE(output == 7);
+
+        REQUIRE(element_interpreter_load_string(context, "second(a:Num, b:Num):Num = Num.max(a, b).sqr", "<input>") == ELEMENT_OK);
+        REQUIRE(evaluate(context, "second", 2, 3, output) == ELEMENT_OK);
+        REQUIRE(output == 9);
+    }
+
+    SECTION("Changed files are loaded from source")
+    {
+        write_file(source_path, "first(a:Num, b:Num):Num = a.sub(b)\n");
+        REQUIRE(element_interpreter_load_snapshot(context, snapshot_path.c_str()) == ELEMENT_OK);
+
+        float output = 0;
+        REQUIRE(evaluate(context, "first", 2, 3, output) == ELEMENT_OK);
+        REQUIRE(output == -1);
+    }
+
+    SECTION("Corrupt snapshots are rejected")
+    {
+        write_file(snapshot_path, "ELESNAP");
+        REQUIRE(element_interpreter_load_snapshot(context, snapshot_path.c_str()) == ELEMENT_ERROR_INVALID_SNAPSHOT);
+        REQUIRE(element_interpreter_load_snapshot(context, "does_not_exist.elesnap") == ELEMENT_ERROR_FILE_NOT_FOUND);
+    }
+
+    SECTION("Unknown AST node types are rejected")
+    {
+        //walk past the file's header, line offsets and tokens to its root node's type
+        auto snapshot = read_file(snapshot_path);
+        auto position = snapshot.rfind(source_path);
+        REQUIRE(position != std::string::npos);
+        position += source_path.size() + sizeof(std::uint64_t) * 2;
+
+        std::uint32_t line_count = 0;
+        std::memcpy(&line_count, &snapshot[position], sizeof(line_count));
+        position += sizeof(line_count) + line_count * sizeof(std::int32_t);
+
+        std::uint32_t token_count = 0;
+        std::memcpy(&token_count, &snapshot[position], sizeof(token_count));
+        position += sizeof(token_count) + token_count * sizeof(std::int32_t) * 10;
+
+        std::uint32_t type = 0;
+        std::memcpy(&type, &snapshot[position], sizeof(type));
+        REQUIRE(type == ELEMENT_AST_NODE_ROOT);
+
+        type = 0xFFFF;
+        std::memcpy(&snapshot[position], &type, sizeof(type));
+        write_file(snapshot_path, snapshot);
+        REQUIRE(element_interpreter_load_snapshot(context, snapshot_path.c_str()) == ELEMENT_ERROR_INVALID_SNAPSHOT);
+    }
+
+    element_interpreter_delete(&context);
+    std::remove(snapshot_path.c_str());
+    std::remove(source_path.c_str());
+}
+
+TEST_CASE("Snapshot Packages", "[API]")
+{
+    const std::string snapshot_path = std::filesystem::absolute("snapshot_packages.test.elesnap").string();
+    const std::filesystem::path package_path = "ElementPackages/SnapshotTest";
+    std::filesystem::create_directories(package_path);
+    write_file((package_path / "first.ele").string(), "first(a:Num, b:Num):Num = a.mul(b)\n");
+
+    element_interpreter_ctx* context = nullptr;
+    element_interpreter_create(&context);
+    element_interpreter_set_log_callback(context, log_callback, nullptr);
+    REQUIRE(element_interpreter_load_prelude(context) == ELEMENT_OK);
+    REQUIRE(element_interpreter_load_package(context, "SnapshotTest") == ELEMENT_OK);
+    REQUIRE(element_interpreter_save_snapshot(context, snapshot_path.c_str()) == ELEMENT_OK);
+    element_interpreter_delete(&context);
+
+    //loaded from somewhere else, the files already in the snapshot must match up with the ones found in the package
+    write_file((package_path / "second.ele").string(), "second(a:Num, b:Num):Num = a.sub(b)\n");
+    const auto working_directory = std::filesystem::current_path();
+    std::filesystem::create_directories("snapshot_packages_cwd");
+    std::filesystem::current_path("snapshot_packages_cwd");
+
+    element_interpreter_create(&context);
+    element_interpreter_set_log_callback(context, log_callback, nullptr);
+    const auto result = element_interpreter_load_snapshot(context, snapshot_path.c_str());
+    std::filesystem::current_path(working_directory);
+    REQUIRE(result == ELEMENT_OK);
+
+    float output = 0;
+    REQUIRE(evaluate(context, "first", 2, 3, output) == ELEMENT_OK);
+    REQUIRE(output == 6);
+    REQUIRE(evaluate(context, "second", 2, 3, output) == ELEMENT_OK);
+    REQUIRE(output == -1);
+
+    element_interpreter_delete(&context);
+    std::filesystem::remove(snapshot_path);
+    std::filesystem::remove_all(package_path);
+    std::filesystem::remove("snapshot_packages_cwd");
+}
+
+TEST_CASE("Parallel Loading", "[API]")
+{
+    const auto load_and_snapshot = [](size_t worker_count, const std::string& snapshot_path) {
+        element_interpreter_ctx* context = nullptr;
+        element_interpreter_create(&context);
+        element_interpreter_set_log_callback(context, log_callback, nullptr);
+        REQUIRE(element_interpreter_set_load_worker_count(context, worker_count) == ELEMENT_OK);
+        REQUIRE(element_interpreter_load_prelude(context) == ELEMENT_OK);
+        REQUIRE(element_interpreter_load_package(context, "StandardLibrary") == ELEMENT_OK);
+
+        float output = 0;
+        REQUIRE(element_interpreter_load_string(context, "first(a:Num, b:Num):Num = Num.max(a, b).sqr", "<input>") == ELEMENT_OK);
+        REQUIRE(evaluate(context, "first", 2, 3, output) == ELEMENT_OK);
+        REQUIRE(output == 9);
+
+        REQUIRE(element_interpreter_save_snapshot(context, snapshot_path.c_str()) == ELEMENT_OK);
+        element_interpreter_delete(&context);
+
+        const auto snapshot = read_file(snapshot_path);
+        std::remove(snapshot_path.c_str());
+        return snapshot;
+    };
+
+    //the snapshot contains every file's AST in load order, so is a good check that the result doesn't depend on the workers
+    const auto serial = load_and_snapshot(1, "serial.test.elesnap");
+    REQUIRE(!serial.empty());
+
+    for (size_t workers : { 4, 0 }) {
+        const bool matches_serial = load_and_snapshot(workers, "parallel.test.elesnap") == serial;
+        REQUIRE(matches_serial);
+    }
+}
+
+TEST_CASE("Source Files", "[API]")
+{
+    struct logged_lines
+    {
+        std::vector<std::string> lines;
+    } logged;
+
+    element_interpreter_ctx* context = nullptr;
+    element_interpreter_create(&context);
+    element_interpreter_set_log_callback(context, [](const element_log_message* msg, void* user_data) {
+            if (msg->line_in_source)
+                static_cast<logged_lines*>(user_data)->lines.emplace_back(msg->line_in_source); }, &logged);
+    REQUIRE(element_interpreter_load_prelude(context) == ELEMENT_OK);
+
+    SECTION("Errors report the line they're on")
+    {
+        const std::string source_path = "source_file_test.ele";
+        write_file(source_path, "first(a:Num):Num = a\n\nsecond(a:Num):Num = a.nonsense\nthird(a:Num):Num = a\n");
+        REQUIRE(element_interpreter_load_file(context, source_path.c_str()) == ELEMENT_OK);
+
+        float output = 0;
+        REQUIRE(evaluate(context, "second", 1, 2, output) != ELEMENT_OK);
+        REQUIRE(!logged.lines.empty());
+        REQUIRE(logged.lines.back() == "second(a:Num):Num = a.nonsense");
+        std::remove(source_path.c_str());
+    }
+
+    SECTION("Files replaced after they're loaded")
+    {
+        const std::string source_path = "source_file_changed_test.ele";
+        const std::string replacement_path = "source_file_changed_test.ele.new";
+        write_file(source_path, "first(a:Num):Num = a\n\nsecond(a:Num):Num = a.nonsense\nthird(a:Num):Num = a\n");
+        REQUIRE(element_interpreter_load_file(context, source_path.c_str()) == ELEMENT_OK);
+
+        //saved the way most editors do, by writing a new file over the top of the old one
+        write_file(replacement_path, "");
+        REQUIRE(std::rename(replacement_path.c_str(), source_path.c_str()) == 0);
+
+        float output = 0;
+        REQUIRE(evaluate(context, "second", 1, 2, output) != ELEMENT_OK);
+        REQUIRE(!logged.lines.empty());
+        REQUIRE(logged.lines.back() == "second(a:Num):Num = a.nonsense");
+        std::remove(source_path.c_str());
+    }
+
+    SECTION("Files truncated after they're loaded")
+    {
+        const std::string source_path = "source_file_truncated_test.ele";
+        write_file(source_path, "first(a:Num):Num = a\n\nsecond(a:Num):Num = a.nonsense\nthird(a:Num):Num = a\n");
+        REQUIRE(element_interpreter_load_file(context, source_path.c_str()) == ELEMENT_OK);
+
+        //truncated in place, so the lines can't be read back from the file any more, but the error is still reported
+        write_file(source_path, "");
+
+        float output = 0;
+        REQUIRE(evaluate(context, "second", 1, 2, output) != ELEMENT_OK);
+        REQUIRE(!logged.lines.empty());
+        const bool original_or_empty = logged.lines.back().empty() || logged.lines.back() == "second(a:Num):Num = a.nonsense";
+        REQUIRE(original_or_empty);
+        std::remove(source_path.c_str());
+    }
+
+    SECTION("Files which fill whole pages")
+    {
+        const std::string source_path = "source_file_page_test.ele";
+        std::string source = "first(a:Num, b:Num):Num = a.add(b)\n#";
+        source.resize(4096 * 2, ' ');
+        write_file(source_path, source);
+        REQUIRE(element_interpreter_load_file(context, source_path.c_str()) == ELEMENT_OK);
+
+        float output = 0;
+        REQUIRE(evaluate(context, "first", 1, 2, output) == ELEMENT_OK);
+        REQUIRE(output == 3);
+        std::remove(source_path.c_str());
+    }
+
+    element_interpreter_delete(&context);
+}
@@ -2,6 +2,7 @@
 
 //STD
 #include <array>
+#include <cmath>
 
 //LIBS
 #include <fmt/format.h>
@@ -13,6 +14,7 @@
 #include "util.test.hpp"
 #include "object_model/intermediaries/function_instance.hpp"
 #include "object_model/intermediaries/struct_instance.hpp"
+#include "object_model/declarations/function_declaration.hpp"
 
 // Include specific tests for object model generation here
 TEST_CASE("ObjectModel", "[API]")
@@ -117,4 +119,72 @@ TEST_CASE("ObjectModel", "[API]")
         element_declaration_delete(&const_int_declaration);
         element_interpreter_delete(&interpreter);
     }
+
+    SECTION("Scopes")
+    {
+        element_interpreter_ctx* interpreter = nullptr;
+        element_interpreter_create(&interpreter);
+        element_interpreter_set_log_callback(interpreter, log_callback, nullptr);
+        REQUIRE(element_interpreter_load_string(interpreter, "namespace outer { namespace inner { value = 1 } }\nother = 2", "<input>") == ELEMENT_OK);
+
+        //identifiers with the same text share a symbol
+        REQUIRE(element::identifier{ "value" }.id == element::identifier{ std::string("val") + "ue" }.id);
+        REQUIRE(element::identifier{ "value" }.id != element::identifier{ "other" }.id);
+        REQUIRE(element::symbol_table::text(element::identifier{ "value" }.id) == "value");
+
+        const auto* global = interpreter->global_scope.get();
+        auto& caches = interpreter->cache_scope_find;
+        const auto* outer = global->find(element::identifier{ "outer" }, caches, false);
+        REQUIRE(outer);
+        const auto* value = global->find(element::identifier{ "outer.inner.value" }, caches, false);
+        REQUIRE(value);
+        REQUIRE(value->name.value == "value");
+        REQUIRE(outer->our_scope->find(element::identifier{ "inner.value" }, caches, false) == value);
+        REQUIRE(global->find(element::identifier{ "outer.inner.missing" }, caches, false) == nullptr);
+
+        //looking up from an inner scope finds declarations further out only when recursing
+        const auto* inner_scope = value->our_scope->get_parent_scope();
+        REQUIRE(inner_scope->find(element::identifier{ "other" }, caches, false) == nullptr);
+        REQUIRE(inner_scope->find(element::identifier{ "other" }, caches, true));
+
+        //declarations added later are found, as are ones that have been removed no longer
+        auto added = std::make_unique<element::function_declaration>(element::identifier{ "added" }, global, element::function_declaration::kind::expression_bodied);
+        REQUIRE(interpreter->global_scope->add_declaration(std::move(added), caches));
+        REQUIRE(global->find(element::identifier{ "added" }, caches, false));
+        REQUIRE(interpreter->global_scope->remove_declaration(element::identifier{ "added" }, caches));
+        REQUIRE(global->find(element::identifier{ "added" }, caches, false) == nullptr);
+
+        element_interpreter_delete(&interpreter);
+    }
+
+    SECTION("Instruction Caches")
+    {
+        element_interpreter_ctx* interpreter = nullptr;
+        element_interpreter_create(&interpreter);
+
+        auto& constants = interpreter->cache_instruction_constant;
+        auto& binaries = interpreter->cache_instruction_binary;
+
+        //identical instructions are the same instruction
+        auto one = constants.get(1.0f);
+        auto two = constants.get(2.0f, element::type::num.get());
+        REQUIRE(constants.get(1.0f, element::type::num.get()) == one);
+        REQUIRE(constants.get(1.0f, element::type::boolean.get()) != one);
+        REQUIRE(constants.get(std::nanf("1")) == constants.get(std::nanf("2")));
+
+        auto sum = binaries.get(element_binary_op::add, one, two, element::type::num.get());
+        REQUIRE(binaries.get(element_binary_op::add, one, two, element::type::num.get()) == sum);
+        REQUIRE(binaries.get(element_binary_op::add, two, one, element::type::num.get()) != sum);
+
+        //instructions nothing else is using are released
+        std::weak_ptr<const element::instruction_binary> weak_sum = sum;
+        sum.reset();
+        REQUIRE(weak_sum.expired());
+
+        for (int i = 0; i < 4096; ++i)
+            constants.get(static_cast<element_value>(i) + 0.5f);
+        REQUIRE(constants.size() < 4096);
+
+        element_interpreter_delete(&interpreter);
+    }
 }
\ No newline at end of file
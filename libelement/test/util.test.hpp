@@ -2,7 +2,18 @@
     #define ELEMENT_UTIL_TEST_HPP
 
     #include "element/common.h"
+    #include "element/interpreter.h"
 
 void log_callback(const element_log_message* msg, void* user_data);
 
+//while one of these exists, check_c_export is enabled for everything the evaluator tests run
+struct c_export_checks
+{
+    c_export_checks();
+    ~c_export_checks();
+};
+
+//when enabled, exports the declaration to C, then (where there's a C compiler) builds and runs it, checking it matches the evaluator
+void check_c_export(element_interpreter_ctx* context, const element_declaration* declaration, const element_inputs* inputs, const element_outputs* outputs);
+
 #endif